@@ -45,13 +45,15 @@ CLS_NAME(rgw)
 #define BI_BUCKET_LOG_INDEX           1
 #define BI_BUCKET_OBJ_INSTANCE_INDEX  2
 #define BI_BUCKET_OLH_DATA_INDEX      3
+#define BI_BUCKET_RESHARD_LOG_INDEX   4
 
-#define BI_BUCKET_LAST_INDEX          4
+#define BI_BUCKET_LAST_INDEX          5
 
 static std::string bucket_index_prefixes[] = { "", /* special handling for the objs list index */
                                           "0_",     /* bucket log index */
                                           "1000_",  /* obj instance index */
                                           "1001_",  /* olh data index */
+                                          "1002_",  /* reshard log index */
 
                                           /* this must be the last index */
                                           "9999_",};
@@ -123,6 +125,33 @@ static void bi_log_index_key(cls_method_context_t hctx, string& key, string& id,
   key.append(id);
 }
 
+static void reshard_log_prefix(string& key)
+{
+  key = BI_PREFIX_CHAR;
+  key.append(bucket_index_prefixes[BI_BUCKET_RESHARD_LOG_INDEX]);
+}
+
+/*
+ * while a bucket is being resharded online, remember the names of the
+ * objects whose index entries changed after the copy started; the
+ * reshard process copies those names again before switching over
+ */
+static int reshard_log_index_operation(cls_method_context_t hctx,
+                                       const rgw_bucket_dir_header& header,
+                                       const string& name)
+{
+  if (!header.resharding_in_logrecord()) {
+    return 0;
+  }
+
+  string key;
+  reshard_log_prefix(key);
+  key.append(name);
+
+  bufferlist empty;
+  return cls_cxx_map_set_val(hctx, key, &empty);
+}
+
 static int log_index_operation(cls_method_context_t hctx, cls_rgw_obj_key& obj_key, RGWModifyOp op,
                                string& tag, real_time& timestamp,
                                rgw_bucket_entry_ver& ver, RGWPendingState state, uint64_t index_ver,
@@ -964,6 +993,12 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     return -EINVAL;
   }
 
+  rc = reshard_log_index_operation(hctx, header, op.key.name);
+  if (rc < 0) {
+    CLS_LOG(1, "ERROR: rgw_bucket_complete_op(): failed to log reshard entry rc=%d\n", rc);
+    return rc;
+  }
+
   rgw_bucket_dir_entry entry;
   bool ondisk = true;
 
@@ -1088,6 +1123,11 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
 	    int(remove_entry.meta.category));
     unaccount_entry(header, remove_entry);
 
+    ret = reshard_log_index_operation(hctx, header, remove_key.name);
+    if (ret < 0) {
+      return ret;
+    }
+
     if (op.log_op && !header.syncstopped) {
       ++header.ver; // increment index version, or we'll overwrite keys previously written
       rc = log_index_operation(hctx, remove_key, CLS_RGW_OP_DEL, op.tag, remove_entry.meta.mtime,
@@ -1106,6 +1146,80 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
   return write_bucket_header(hctx, &header);
 }
 
+/*
+ * remove a batch of plain index entries in one call, as lifecycle
+ * expiration does once it has removed the head objects. an entry is only
+ * removed if it is still at the version it was listed at and has no
+ * operation pending, so objects rewritten in the meantime are kept.
+ */
+int rgw_bucket_remove_entries(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  rgw_cls_bucket_remove_entries_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: rgw_bucket_remove_entries(): failed to decode request\n");
+    return -EINVAL;
+  }
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG(1, "ERROR: rgw_bucket_remove_entries(): failed to read header\n");
+    return rc;
+  }
+
+  int removed = 0;
+  for (auto& [key, ver] : op.entries) {
+    string idx;
+    encode_obj_index_key(key, &idx);
+    rgw_bucket_dir_entry entry;
+    rc = read_index_entry(hctx, idx, &entry);
+    if (rc == -ENOENT) {
+      continue;
+    }
+    if (rc < 0) {
+      return rc;
+    }
+    if (!entry.pending_map.empty() ||
+        entry.ver.pool != ver.pool || entry.ver.epoch != ver.epoch) {
+      CLS_LOG(20, "rgw_bucket_remove_entries(): skipping modified entry name=%s instance=%s\n",
+              key.name.c_str(), key.instance.c_str());
+      continue;
+    }
+
+    rc = reshard_log_index_operation(hctx, header, key.name);
+    if (rc < 0) {
+      return rc;
+    }
+    if (entry.exists) {
+      unaccount_entry(header, entry);
+    }
+    rc = cls_cxx_map_remove_key(hctx, idx);
+    if (rc < 0) {
+      return rc;
+    }
+    if (op.log_op && entry.exists && !header.syncstopped) {
+      ++header.ver; // each bilog entry needs its own index version
+      rc = log_index_operation(hctx, entry.key, CLS_RGW_OP_DEL, entry.tag, entry.meta.mtime,
+                               entry.ver, CLS_RGW_STATE_COMPLETE, header.ver, header.max_marker,
+                               op.bilog_flags, NULL, NULL, &op.zones_trace);
+      if (rc < 0) {
+        return rc;
+      }
+    }
+    ++removed;
+  }
+
+  CLS_LOG(10, "rgw_bucket_remove_entries(): removed %d of %d entries\n",
+          removed, (int)op.entries.size());
+  if (!removed) {
+    return 0;
+  }
+  return write_bucket_header(hctx, &header);
+}
+
 template <class T>
 static int write_entry(cls_method_context_t hctx, T& entry, const string& key)
 {
@@ -1676,16 +1790,22 @@ static int rgw_bucket_link_olh(cls_method_context_t hctx, bufferlist *in, buffer
     return ret;
   }
 
-  if (!op.log_op) {
-   return 0;
-  }
-
   rgw_bucket_dir_header header;
   ret = read_bucket_header(hctx, &header);
   if (ret < 0) {
     CLS_LOG(1, "ERROR: rgw_bucket_link_olh(): failed to read header\n");
     return ret;
   }
+
+  ret = reshard_log_index_operation(hctx, header, op.key.name);
+  if (ret < 0) {
+    return ret;
+  }
+
+  if (!op.log_op) {
+   return 0;
+  }
+
   if (header.syncstopped) {
     return 0;
   }
@@ -1841,16 +1961,22 @@ static int rgw_bucket_unlink_instance(cls_method_context_t hctx, bufferlist *in,
     return ret;
   }
 
-  if (!op.log_op) {
-    return 0;
-  }
-
   rgw_bucket_dir_header header;
   ret = read_bucket_header(hctx, &header);
   if (ret < 0) {
     CLS_LOG(1, "ERROR: rgw_bucket_unlink_instance(): failed to read header\n");
     return ret;
   }
+
+  ret = reshard_log_index_operation(hctx, header, op.key.name);
+  if (ret < 0) {
+    return ret;
+  }
+
+  if (!op.log_op) {
+    return 0;
+  }
+
   if (header.syncstopped) {
     return 0;
   }
@@ -1971,7 +2097,14 @@ static int rgw_bucket_trim_olh_log(cls_method_context_t hctx, bufferlist *in, bu
     return ret;
   }
 
-  return 0;
+  rgw_bucket_dir_header header;
+  ret = read_bucket_header(hctx, &header);
+  if (ret < 0) {
+    CLS_LOG(1, "ERROR: %s(): failed to read header\n", __func__);
+    return ret;
+  }
+
+  return reshard_log_index_operation(hctx, header, op.olh.name);
 }
 
 static int rgw_bucket_clear_olh(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
@@ -2012,6 +2145,17 @@ static int rgw_bucket_clear_olh(cls_method_context_t hctx, bufferlist *in, buffe
     return ret;
   }
 
+  rgw_bucket_dir_header header;
+  ret = read_bucket_header(hctx, &header);
+  if (ret < 0) {
+    CLS_LOG(1, "ERROR: %s(): failed to read header\n", __func__);
+    return ret;
+  }
+  ret = reshard_log_index_operation(hctx, header, op.key.name);
+  if (ret < 0) {
+    return ret;
+  }
+
   rgw_bucket_dir_entry plain_entry;
 
   /* read plain entry, make sure it's a versioned place holder */
@@ -2119,6 +2263,10 @@ int rgw_dir_suggest_changes(cls_method_context_t hctx,
       rgw_bucket_category_stats& stats = header.stats[cur_change.meta.category];
       bool log_op = (op & CEPH_RGW_DIR_SUGGEST_LOG_OP) != 0;
       op &= CEPH_RGW_DIR_SUGGEST_OP_MASK;
+      ret = reshard_log_index_operation(hctx, header, cur_change.key.name);
+      if (ret < 0) {
+        return ret;
+      }
       switch(op) {
       case CEPH_RGW_REMOVE:
         CLS_LOG(10, "CEPH_RGW_REMOVE name=%s instance=%s\n", cur_change.key.name.c_str(), cur_change.key.instance.c_str());
@@ -4028,7 +4176,9 @@ static int rgw_guard_bucket_resharding(cls_method_context_t hctx, bufferlist *in
     return rc;
   }
 
-  if (header.resharding()) {
+  // writes go on while the index is copied with the log recording,
+  // and are only held back for the final catch-up
+  if (header.resharding() && !header.resharding_in_logrecord()) {
     return op.ret_err;
   }
 
@@ -4063,6 +4213,91 @@ static int rgw_get_bucket_resharding(cls_method_context_t hctx,
   return 0;
 }
 
+static int rgw_reshard_log_list(cls_method_context_t hctx,
+				bufferlist *in, bufferlist *out)
+{
+  cls_rgw_reshard_log_list_op op;
+
+  auto in_iter = in->cbegin();
+  try {
+    decode(op, in_iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: %s(): failed to decode entry\n", __func__);
+    return -EINVAL;
+  }
+
+  string prefix;
+  reshard_log_prefix(prefix);
+  string start_after_key = prefix;
+  start_after_key.append(op.marker);
+
+#define MAX_RESHARD_LOG_LIST_ENTRIES 1000
+  uint32_t max = (op.max && op.max < MAX_RESHARD_LOG_LIST_ENTRIES ?
+		  op.max : MAX_RESHARD_LOG_LIST_ENTRIES);
+
+  std::set<string> keys;
+  cls_rgw_reshard_log_list_ret op_ret;
+  int rc = cls_cxx_map_get_keys(hctx, start_after_key, max, &keys,
+				&op_ret.is_truncated);
+  if (rc < 0) {
+    return rc;
+  }
+
+  for (auto& key : keys) {
+    if (key.compare(0, prefix.size(), prefix) != 0) {
+      op_ret.is_truncated = false;
+      break;
+    }
+    op_ret.entries.push_back(key.substr(prefix.size()));
+  }
+
+  encode(op_ret, *out);
+
+  return 0;
+}
+
+static int rgw_reshard_log_trim(cls_method_context_t hctx,
+				bufferlist *in, bufferlist *out)
+{
+  // an empty input is what older clients send, and drops the whole log
+  cls_rgw_reshard_log_trim_op op;
+  if (in->length()) {
+    auto in_iter = in->cbegin();
+    try {
+      decode(op, in_iter);
+    } catch (ceph::buffer::error& err) {
+      CLS_LOG(1, "ERROR: %s(): failed to decode entry\n", __func__);
+      return -EINVAL;
+    }
+  }
+
+  if (!op.names.empty()) {
+    string prefix;
+    reshard_log_prefix(prefix);
+    for (auto& name : op.names) {
+      int rc = cls_cxx_map_remove_key(hctx, prefix + name);
+      if (rc < 0) {
+        CLS_LOG(1, "ERROR: cls_cxx_map_remove_key failed rc=%d", rc);
+        return rc;
+      }
+    }
+    return 0;
+  }
+
+  string key_begin;
+  reshard_log_prefix(key_begin);
+  string key_end;
+  key_end = BI_PREFIX_CHAR;
+  key_end.append(bucket_index_prefixes[BI_BUCKET_RESHARD_LOG_INDEX + 1]);
+
+  int rc = cls_cxx_map_remove_range(hctx, key_begin, key_end);
+  if (rc < 0) {
+    CLS_LOG(1, "ERROR: cls_cxx_map_remove_range failed rc=%d", rc);
+    return rc;
+  }
+  return 0;
+}
+
 CLS_INIT(rgw)
 {
   CLS_LOG(1, "Loaded rgw class!");
@@ -4081,6 +4316,7 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_bucket_read_olh_log;
   cls_method_handle_t h_rgw_bucket_trim_olh_log;
   cls_method_handle_t h_rgw_bucket_clear_olh;
+  cls_method_handle_t h_rgw_bucket_remove_entries;
   cls_method_handle_t h_rgw_obj_remove;
   cls_method_handle_t h_rgw_obj_store_pg_ver;
   cls_method_handle_t h_rgw_obj_check_attrs_prefix;
@@ -4114,6 +4350,8 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_clear_bucket_resharding;
   cls_method_handle_t h_rgw_guard_bucket_resharding;
   cls_method_handle_t h_rgw_get_bucket_resharding;
+  cls_method_handle_t h_rgw_reshard_log_list;
+  cls_method_handle_t h_rgw_reshard_log_trim;
 
   cls_register(RGW_CLASS, &h_class);
 
@@ -4131,6 +4369,7 @@ CLS_INIT(rgw)
   cls_register_cxx_method(h_class, RGW_BUCKET_READ_OLH_LOG, CLS_METHOD_RD, rgw_bucket_read_olh_log, &h_rgw_bucket_read_olh_log);
   cls_register_cxx_method(h_class, RGW_BUCKET_TRIM_OLH_LOG, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_trim_olh_log, &h_rgw_bucket_trim_olh_log);
   cls_register_cxx_method(h_class, RGW_BUCKET_CLEAR_OLH, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_clear_olh, &h_rgw_bucket_clear_olh);
+  cls_register_cxx_method(h_class, RGW_BUCKET_REMOVE_ENTRIES, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_remove_entries, &h_rgw_bucket_remove_entries);
 
   cls_register_cxx_method(h_class, RGW_OBJ_REMOVE, CLS_METHOD_RD | CLS_METHOD_WR, rgw_obj_remove, &h_rgw_obj_remove);
   cls_register_cxx_method(h_class, RGW_OBJ_STORE_PG_VER, CLS_METHOD_WR, rgw_obj_store_pg_ver, &h_rgw_obj_store_pg_ver);
@@ -4184,6 +4423,10 @@ CLS_INIT(rgw)
 			  rgw_guard_bucket_resharding, &h_rgw_guard_bucket_resharding);
   cls_register_cxx_method(h_class, RGW_GET_BUCKET_RESHARDING, CLS_METHOD_RD ,
 			  rgw_get_bucket_resharding, &h_rgw_get_bucket_resharding);
+  cls_register_cxx_method(h_class, RGW_RESHARD_LOG_LIST, CLS_METHOD_RD,
+			  rgw_reshard_log_list, &h_rgw_reshard_log_list);
+  cls_register_cxx_method(h_class, RGW_RESHARD_LOG_TRIM, CLS_METHOD_RD | CLS_METHOD_WR,
+			  rgw_reshard_log_trim, &h_rgw_reshard_log_trim);
 
   return;
 }
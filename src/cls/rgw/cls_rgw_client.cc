@@ -215,6 +215,23 @@ void cls_rgw_bucket_complete_op(ObjectWriteOperation& o, RGWModifyOp op, string&
   o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OP, in);
 }
 
+void cls_rgw_bucket_remove_entries(ObjectWriteOperation& o,
+                                   const map<cls_rgw_obj_key, rgw_bucket_entry_ver>& entries,
+                                   bool log_op, uint16_t bilog_flags,
+                                   rgw_zone_set *zones_trace)
+{
+  bufferlist in;
+  rgw_cls_bucket_remove_entries_op call;
+  call.entries = entries;
+  call.log_op = log_op;
+  call.bilog_flags = bilog_flags;
+  if (zones_trace) {
+    call.zones_trace = *zones_trace;
+  }
+  encode(call, in);
+  o.exec(RGW_CLASS, RGW_BUCKET_REMOVE_ENTRIES, in);
+}
+
 void cls_rgw_bucket_list_op(librados::ObjectReadOperation& op,
                             const cls_rgw_obj_key& start_obj,
                             const std::string& filter_prefix,
@@ -376,6 +393,20 @@ int cls_rgw_bi_list(librados::IoCtx& io_ctx, const string oid,
   return 0;
 }
 
+void cls_rgw_bi_list(librados::ObjectReadOperation& op,
+                     const string& name, const string& marker, uint32_t max,
+                     rgw_cls_bi_list_ret *result, int *ret_code)
+{
+  bufferlist in;
+  rgw_cls_bi_list_op call;
+  call.name = name;
+  call.marker = marker;
+  call.max = max;
+  encode(call, in);
+  op.exec(RGW_CLASS, RGW_BI_LIST, in,
+          new ClsBucketIndexOpCtx<rgw_cls_bi_list_ret>(result, ret_code));
+}
+
 int cls_rgw_bucket_link_olh(librados::IoCtx& io_ctx, const string& oid, 
                             const cls_rgw_obj_key& key, bufferlist& olh_tag,
                             bool delete_marker, const string& op_tag, rgw_bucket_dir_entry_meta *meta,
@@ -1069,6 +1100,49 @@ void cls_rgw_guard_bucket_resharding(librados::ObjectOperation& op, int ret_err)
   op.exec(RGW_CLASS, RGW_GUARD_BUCKET_RESHARDING, in);
 }
 
+void cls_rgw_reshard_log_list(librados::ObjectReadOperation& op,
+                              const string& marker, uint32_t max,
+                              cls_rgw_reshard_log_list_ret *result)
+{
+  bufferlist in;
+  cls_rgw_reshard_log_list_op call;
+  call.marker = marker;
+  call.max = max;
+  encode(call, in);
+  op.exec(RGW_CLASS, RGW_RESHARD_LOG_LIST, in,
+          new ClsBucketIndexOpCtx<cls_rgw_reshard_log_list_ret>(result, NULL));
+}
+
+int cls_rgw_reshard_log_list(librados::IoCtx& io_ctx, const string& oid,
+                             const string& marker, uint32_t max,
+                             list<string>& entries, bool *is_truncated)
+{
+  librados::ObjectReadOperation op;
+  cls_rgw_reshard_log_list_ret ret;
+  cls_rgw_reshard_log_list(op, marker, max, &ret);
+  int r = io_ctx.operate(oid, &op, nullptr);
+  if (r < 0)
+    return r;
+
+  entries = std::move(ret.entries);
+  if (is_truncated)
+    *is_truncated = ret.is_truncated;
+
+  return 0;
+}
+
+void cls_rgw_reshard_log_trim(librados::ObjectWriteOperation& op,
+                              const list<string>& names)
+{
+  bufferlist in;
+  if (!names.empty()) {
+    cls_rgw_reshard_log_trim_op call;
+    call.names = names;
+    encode(call, in);
+  }
+  op.exec(RGW_CLASS, RGW_RESHARD_LOG_TRIM, in);
+}
+
 static bool issue_set_bucket_resharding(librados::IoCtx& io_ctx, const string& oid,
                                         const cls_rgw_bucket_instance_entry& entry,
                                         BucketIndexAioManager *manager) {
@@ -369,6 +369,12 @@ void cls_rgw_bucket_complete_op(librados::ObjectWriteOperation& o, RGWModifyOp o
 				std::list<cls_rgw_obj_key> *remove_objs, bool log_op,
                                 uint16_t bilog_op, rgw_zone_set *zones_trace);
 
+/* remove the given index entries, unless they changed since they were listed */
+void cls_rgw_bucket_remove_entries(librados::ObjectWriteOperation& o,
+                                   const std::map<cls_rgw_obj_key, rgw_bucket_entry_ver>& entries,
+                                   bool log_op, uint16_t bilog_flags,
+                                   rgw_zone_set *zones_trace);
+
 void cls_rgw_remove_obj(librados::ObjectWriteOperation& o, std::list<std::string>& keep_attr_prefixes);
 void cls_rgw_obj_store_pg_ver(librados::ObjectWriteOperation& o, const std::string& attr);
 void cls_rgw_obj_check_attrs_prefix(librados::ObjectOperation& o, const std::string& prefix, bool fail_if_exist);
@@ -382,6 +388,9 @@ void cls_rgw_bi_put(librados::ObjectWriteOperation& op, const std::string oid, r
 int cls_rgw_bi_list(librados::IoCtx& io_ctx, const std::string oid,
                    const std::string& name, const std::string& marker, uint32_t max,
                    std::list<rgw_cls_bi_entry> *entries, bool *is_truncated);
+void cls_rgw_bi_list(librados::ObjectReadOperation& op,
+                     const std::string& name, const std::string& marker, uint32_t max,
+                     rgw_cls_bi_list_ret *result, int *ret_code);
 
 
 void cls_rgw_bucket_link_olh(librados::ObjectWriteOperation& op,
@@ -641,4 +650,19 @@ int cls_rgw_get_bucket_resharding(librados::IoCtx& io_ctx, const std::string& oi
                                   cls_rgw_bucket_instance_entry *entry);
 #endif
 
+/* names of the objects whose index entries changed during an online reshard */
+void cls_rgw_reshard_log_list(librados::ObjectReadOperation& op,
+                              const std::string& marker, uint32_t max,
+                              cls_rgw_reshard_log_list_ret *result);
+/* drop the given names from the log, or all of it if none are given */
+void cls_rgw_reshard_log_trim(librados::ObjectWriteOperation& op,
+                              const std::list<std::string>& names = {});
+// these overloads which call io_ctx.operate() should not be called in the rgw.
+// rgw_rados_operate() should be called after the overloads w/o calls to io_ctx.operate()
+#ifndef CLS_CLIENT_HIDE_IOCTX
+int cls_rgw_reshard_log_list(librados::IoCtx& io_ctx, const std::string& oid,
+                             const std::string& marker, uint32_t max,
+                             std::list<std::string>& entries, bool *is_truncated);
+#endif
+
 #endif
@@ -22,6 +22,7 @@
 #define RGW_BUCKET_READ_OLH_LOG "bucket_read_olh_log"
 #define RGW_BUCKET_TRIM_OLH_LOG "bucket_trim_olh_log"
 #define RGW_BUCKET_CLEAR_OLH "bucket_clear_olh"
+#define RGW_BUCKET_REMOVE_ENTRIES "bucket_remove_entries"
 
 #define RGW_OBJ_REMOVE "obj_remove"
 #define RGW_OBJ_STORE_PG_VER "obj_store_pg_ver"
@@ -71,5 +72,7 @@
 #define RGW_CLEAR_BUCKET_RESHARDING "clear_bucket_resharding"
 #define RGW_GUARD_BUCKET_RESHARDING "guard_bucket_resharding"
 #define RGW_GET_BUCKET_RESHARDING "get_bucket_resharding"
+#define RGW_RESHARD_LOG_LIST "reshard_log_list"
+#define RGW_RESHARD_LOG_TRIM "reshard_log_trim"
 
 #endif
@@ -157,6 +157,35 @@ void rgw_cls_obj_complete_op::dump(Formatter *f) const
   encode_json("zones_trace", zones_trace, f);
 }
 
+void rgw_cls_bucket_remove_entries_op::generate_test_instances(list<rgw_cls_bucket_remove_entries_op*>& o)
+{
+  rgw_cls_bucket_remove_entries_op *op = new rgw_cls_bucket_remove_entries_op;
+  rgw_bucket_entry_ver ver;
+  ver.pool = 2;
+  ver.epoch = 100;
+  op->entries[cls_rgw_obj_key("name")] = ver;
+  op->entries[cls_rgw_obj_key("name2", "instance")] = ver;
+  op->log_op = true;
+  o.push_back(op);
+
+  o.push_back(new rgw_cls_bucket_remove_entries_op);
+}
+
+void rgw_cls_bucket_remove_entries_op::dump(Formatter *f) const
+{
+  f->open_array_section("entries");
+  for (auto& [key, ver] : entries) {
+    f->open_object_section("entry");
+    encode_json("key", key, f);
+    encode_json("ver", ver, f);
+    f->close_section();
+  }
+  f->close_section();
+  f->dump_bool("log_op", log_op);
+  f->dump_int("bilog_flags", bilog_flags);
+  encode_json("zones_trace", zones_trace, f);
+}
+
 void rgw_cls_link_olh_op::generate_test_instances(list<rgw_cls_link_olh_op*>& o)
 {
   rgw_cls_link_olh_op *op = new rgw_cls_link_olh_op;
@@ -545,3 +574,47 @@ void cls_rgw_get_bucket_resharding_op::generate_test_instances(
 void cls_rgw_get_bucket_resharding_op::dump(Formatter *f) const
 {
 }
+
+void cls_rgw_reshard_log_list_op::generate_test_instances(
+  list<cls_rgw_reshard_log_list_op*>& ls)
+{
+  ls.push_back(new cls_rgw_reshard_log_list_op);
+  ls.push_back(new cls_rgw_reshard_log_list_op);
+  ls.back()->marker = "foo";
+  ls.back()->max = 1000;
+}
+
+void cls_rgw_reshard_log_list_op::dump(Formatter *f) const
+{
+  encode_json("marker", marker, f);
+  encode_json("max", max, f);
+}
+
+void cls_rgw_reshard_log_list_ret::generate_test_instances(
+  list<cls_rgw_reshard_log_list_ret*>& ls)
+{
+  ls.push_back(new cls_rgw_reshard_log_list_ret);
+  ls.push_back(new cls_rgw_reshard_log_list_ret);
+  ls.back()->entries.push_back("foo");
+  ls.back()->is_truncated = true;
+}
+
+void cls_rgw_reshard_log_list_ret::dump(Formatter *f) const
+{
+  encode_json("entries", entries, f);
+  encode_json("is_truncated", is_truncated, f);
+}
+
+void cls_rgw_reshard_log_trim_op::generate_test_instances(
+  list<cls_rgw_reshard_log_trim_op*>& ls)
+{
+  ls.push_back(new cls_rgw_reshard_log_trim_op);
+  ls.push_back(new cls_rgw_reshard_log_trim_op);
+  ls.back()->names.push_back("foo");
+  ls.back()->names.push_back("bar");
+}
+
+void cls_rgw_reshard_log_trim_op::dump(Formatter *f) const
+{
+  encode_json("names", names, f);
+}
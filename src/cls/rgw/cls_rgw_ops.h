@@ -165,6 +165,36 @@ struct rgw_cls_obj_complete_op
 };
 WRITE_CLASS_ENCODER(rgw_cls_obj_complete_op)
 
+struct rgw_cls_bucket_remove_entries_op
+{
+  // the version of each entry when it was listed; entries that were
+  // modified since, or have an operation pending, are left alone
+  std::map<cls_rgw_obj_key, rgw_bucket_entry_ver> entries;
+  bool log_op{false};
+  uint16_t bilog_flags{0};
+  rgw_zone_set zones_trace;
+
+  void encode(ceph::buffer::list &bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(entries, bl);
+    encode(log_op, bl);
+    encode(bilog_flags, bl);
+    encode(zones_trace, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator &bl) {
+    DECODE_START(1, bl);
+    decode(entries, bl);
+    decode(log_op, bl);
+    decode(bilog_flags, bl);
+    decode(zones_trace, bl);
+    DECODE_FINISH(bl);
+  }
+  void dump(ceph::Formatter *f) const;
+  static void generate_test_instances(std::list<rgw_cls_bucket_remove_entries_op*>& o);
+};
+WRITE_CLASS_ENCODER(rgw_cls_bucket_remove_entries_op)
+
 struct rgw_cls_link_olh_op {
   cls_rgw_obj_key key;
   std::string olh_tag;
@@ -1485,4 +1515,70 @@ struct cls_rgw_get_bucket_resharding_ret  {
 };
 WRITE_CLASS_ENCODER(cls_rgw_get_bucket_resharding_ret)
 
+struct cls_rgw_reshard_log_list_op {
+  std::string marker;
+  uint32_t max{0};
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(marker, bl);
+    encode(max, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(marker, bl);
+    decode(max, bl);
+    DECODE_FINISH(bl);
+  }
+
+  static void generate_test_instances(std::list<cls_rgw_reshard_log_list_op*>& o);
+  void dump(ceph::Formatter *f) const;
+};
+WRITE_CLASS_ENCODER(cls_rgw_reshard_log_list_op)
+
+struct cls_rgw_reshard_log_list_ret {
+  std::list<std::string> entries; // object names
+  bool is_truncated{false};
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(entries, bl);
+    encode(is_truncated, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(entries, bl);
+    decode(is_truncated, bl);
+    DECODE_FINISH(bl);
+  }
+
+  static void generate_test_instances(std::list<cls_rgw_reshard_log_list_ret*>& o);
+  void dump(ceph::Formatter *f) const;
+};
+WRITE_CLASS_ENCODER(cls_rgw_reshard_log_list_ret)
+
+struct cls_rgw_reshard_log_trim_op {
+  std::list<std::string> names; // object names to drop; empty drops all
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(names, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(names, bl);
+    DECODE_FINISH(bl);
+  }
+
+  static void generate_test_instances(std::list<cls_rgw_reshard_log_trim_op*>& o);
+  void dump(ceph::Formatter *f) const;
+};
+WRITE_CLASS_ENCODER(cls_rgw_reshard_log_trim_op)
+
 #endif /* CEPH_CLS_RGW_OPS_H */
@@ -2270,6 +2270,14 @@ std::vector<Option> get_global_options() {
     .add_service("mon")
     .set_description(""),
 
+    Option("paxos_propose_coalesce", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(true)
+    .add_service("mon")
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("fold delayed proposals of other services into the next paxos round")
+    .set_long_description("when a service starts a paxos round, services whose pending changes are only waiting for their proposal timer are proposed in the same transaction, so a burst of updates across services commits in fewer rounds.")
+    .add_see_also("paxos_propose_interval"),
+
     Option("paxos_min_wait", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
     .set_default(0.05)
     .add_service("mon")
@@ -5587,6 +5595,29 @@ std::vector<Option> get_global_options() {
     .set_flag(Option::FLAG_STARTUP)
     .set_description("The number of threads for serving alienized ObjectStore"),
 
+    Option("seastore_cache_lru_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(64_M)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Size in bytes of the LRU of clean extents kept by the seastore cache")
+    .set_long_description("Clean extents which are no longer referenced stay cached until the LRU exceeds this size; dirty extents are not counted."),
+
+    Option("seastore_journal_iodepth_limit", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(2)
+    .set_min(1)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Number of journal writes in flight beyond which seastore batches records into the next write"),
+
+    Option("seastore_journal_batch_capacity", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(64)
+    .set_min(1)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Number of records at which a seastore journal batch is written regardless of in-flight writes"),
+
+    Option("seastore_journal_batch_flush_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(1_M)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Size in bytes at which a seastore journal batch is written regardless of in-flight writes"),
+
     // ----------------------------
     // blk specific options
     Option("bdev_type", Option::TYPE_STR, Option::LEVEL_ADVANCED)
@@ -5645,9 +5676,26 @@ std::vector<Option> get_rgw_options() {
     Option("rgw_put_obj_max_window_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
     .set_default(64_M)
     .set_description("The maximum RADOS write window size (in bytes).")
-    .set_long_description("The window size may be dynamically adjusted, but will not surpass this value.")
+    .set_long_description(
+        "A single object write starts with a window of rgw_put_obj_min_window_size "
+        "and grows it towards the bandwidth-delay product observed for its RADOS "
+        "writes, up to this size. As writes can't complete faster than the client "
+        "sends data, a slow client keeps a small window. Set it to "
+        "rgw_put_obj_min_window_size or less to use a fixed window.")
     .add_see_also({"rgw_put_obj_min_window_size", "rgw_max_chunk_size"}),
 
+    Option("rgw_put_obj_max_write_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_description("Max size of a single RADOS write to a tail object")
+    .set_long_description(
+        "Data after the head object is written in requests of rgw_max_chunk_size. "
+        "When this is larger, writes to the same tail stripe are coalesced up to "
+        "this size, rounded down to a multiple of the chunk size and capped at "
+        "rgw_put_obj_min_window_size. It has no effect "
+        "unless rgw_obj_stripe_size is larger than rgw_max_chunk_size. 0 disables "
+        "coalescing.")
+    .add_see_also({"rgw_max_chunk_size", "rgw_obj_stripe_size"}),
+
     Option("rgw_max_put_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
     .set_default(5_G)
     .set_description("Max size (in bytes) of regular (non multi-part) object upload.")
@@ -5745,6 +5793,48 @@ std::vector<Option> get_rgw_options() {
         "When full, the RGW metadata cache evicts least recently used entries.")
     .add_see_also("rgw_cache_enabled"),
 
+    Option("rgw_datacache_enabled", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Enable RGW local object data cache.")
+    .set_long_description(
+        "Cache object data read from RADOS in a local directory, ideally on a "
+        "fast SSD, and serve later GETs of the same objects from it. Cached "
+        "stripes are dropped when the object is overwritten or deleted.")
+    .add_see_also({"rgw_datacache_path", "rgw_datacache_size"}),
+
+    Option("rgw_datacache_path", Option::TYPE_STR, Option::LEVEL_ADVANCED)
+    .set_default("/var/lib/ceph/radosgw/$cluster-$id/datacache")
+    .set_description("Directory for the RGW local object data cache.")
+    .set_long_description(
+        "Each gateway needs a directory of its own. Files left over from a "
+        "previous run are removed on startup.")
+    .add_see_also("rgw_datacache_enabled"),
+
+    Option("rgw_datacache_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(10_G)
+    .set_description("Max bytes stored in the RGW local object data cache.")
+    .set_long_description(
+        "When full, the data cache evicts least recently used stripes.")
+    .add_see_also("rgw_datacache_enabled"),
+
+    Option("rgw_datacache_max_pending", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(256_M)
+    .set_description("Max bytes waiting to be written to the RGW data cache.")
+    .set_long_description(
+        "Cache fills are written in the background. While more than this is "
+        "waiting to be written, further fills are skipped rather than slowing "
+        "down reads.")
+    .add_see_also("rgw_datacache_enabled"),
+
+    Option("rgw_datacache_read_threads", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(4)
+    .set_min(1)
+    .set_description("Threads reading from the RGW data cache.")
+    .set_long_description(
+        "Cached stripes are read from the local disk by these threads, so "
+        "that requests don't wait on the disk in the frontend threads.")
+    .add_see_also("rgw_datacache_enabled"),
+
     Option("rgw_socket_path", Option::TYPE_STR, Option::LEVEL_ADVANCED)
     .set_default("")
     .set_description("RGW FastCGI socket path (for FastCGI over Unix domain sockets).")
@@ -5826,6 +5916,38 @@ std::vector<Option> get_rgw_options() {
       "Number of threads in per-LCWorker workpools--used to accelerate "
       "per-bucket processing"),
 
+    Option("rgw_lc_list_concurrency", Option::TYPE_INT, Option::LEVEL_ADVANCED)
+    .set_default(4)
+    .set_min(1)
+    .set_description("Number of bucket index shards each LCWorker lists in parallel")
+    .set_long_description(
+      "Lifecycle processing lists the index shards of a bucket independently. "
+      "This many shards are listed at the same time, each feeding the "
+      "LCWorker's workpool.")
+    .add_see_also("rgw_lc_max_wp_worker"),
+
+    Option("rgw_lc_delete_batch_size", Option::TYPE_INT, Option::LEVEL_ADVANCED)
+    .set_default(100)
+    .set_min(0)
+    .set_description("Number of expired objects removed together")
+    .set_long_description(
+      "Expired objects in unversioned buckets are collected by each workpool "
+      "thread and removed in batches: the head objects are removed "
+      "concurrently and their bucket index entries with one request per index "
+      "shard. 0 disables batching, and each expired object is removed on its "
+      "own as soon as it is found, as is the case with 1."),
+
+    Option("rgw_lc_delete_latency_target", Option::TYPE_INT, Option::LEVEL_ADVANCED)
+    .set_default(500)
+    .set_min(0)
+    .set_description("Latency of a delete batch, in milliseconds, above which lifecycle slows down")
+    .set_long_description(
+      "When a batch of lifecycle deletes takes longer than this, the LCWorker "
+      "doubles the pause it takes after each batch, up to one second; when "
+      "batches are faster it halves the pause again. This keeps lifecycle "
+      "from adding to the load of a busy cluster. 0 disables pacing.")
+    .add_see_also("rgw_lc_delete_batch_size"),
+
     Option("rgw_lc_max_objs", Option::TYPE_INT, Option::LEVEL_ADVANCED)
     .set_default(32)
     .set_description("Number of lifecycle data shards")
@@ -6482,6 +6604,26 @@ std::vector<Option> get_rgw_options() {
     .set_description("Max number of keys to remove from garbage collector log in a single operation")
     .add_see_also({"rgw_gc_max_objs", "rgw_gc_obj_min_wait", "rgw_gc_processor_max_time", "rgw_gc_max_concurrent_io"}),
 
+    Option("rgw_gc_max_concurrent_shards", Option::TYPE_INT, Option::LEVEL_ADVANCED)
+    .set_default(1)
+    .set_min(1)
+    .set_description("Number of garbage collector shards processed concurrently")
+    .set_long_description(
+        "The garbage collector processes this many of its shards at a time, each "
+        "with its own window of rgw_gc_max_concurrent_io operations in flight. "
+        "Raise it when garbage collection falls behind after large deletions.")
+    .add_see_also({"rgw_gc_max_objs", "rgw_gc_max_concurrent_io"}),
+
+    Option("rgw_gc_list_batch_size", Option::TYPE_INT, Option::LEVEL_ADVANCED)
+    .set_default(100)
+    .set_min(1)
+    .set_description("Number of garbage collector entries read from a shard at a time")
+    .set_long_description(
+        "Entries are read from a garbage collector shard in batches of this size. "
+        "Once a batch's tail objects are removed, its entries are removed from the "
+        "shard's queue in a single operation.")
+    .add_see_also({"rgw_gc_max_concurrent_io", "rgw_gc_max_concurrent_shards"}),
+
     Option("rgw_gc_max_deferred_entries_size", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
     .set_default(3072)
     .set_description("maximum allowed size of deferred entries in queue head for gc"),
@@ -6538,7 +6680,18 @@ std::vector<Option> get_rgw_options() {
     Option("rgw_get_obj_window_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
     .set_default(16_M)
     .set_description("RGW object read window size")
-    .set_long_description("The window size in bytes for a single object read request"),
+    .set_long_description("The window size in bytes for a single object read request")
+    .add_see_also("rgw_get_obj_max_window_size"),
+
+    Option("rgw_get_obj_max_window_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(64_M)
+    .set_description("RGW object read maximum adaptive window size")
+    .set_long_description(
+        "A single object read request starts with a window of "
+        "rgw_get_obj_window_size and grows it towards the bandwidth-delay "
+        "product observed for its RADOS reads, up to this size. Set it to "
+        "rgw_get_obj_window_size or less to use a fixed window.")
+    .add_see_also("rgw_get_obj_window_size"),
 
     Option("rgw_get_obj_max_req_size", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
     .set_default(4_M)
@@ -6546,6 +6699,19 @@ std::vector<Option> get_rgw_options() {
     .set_long_description(
         "The maximum request size of a single object read operation sent to RADOS"),
 
+    Option("rgw_s3select_pushdown", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Filter CSV rows in RGW before S3 Select evaluates them")
+    .set_long_description(
+        "When the WHERE clause of an S3 Select query over CSV is a conjunction "
+        "of simple comparisons between positional columns and literals, RGW "
+        "scans the object for rows that certainly fail it and passes only the "
+        "rest to the query engine. RGW compares numeric literals against "
+        "column text as doubles, which has not been verified against the "
+        "engine's own comparison and type conversion rules, so a query may "
+        "return different rows, or no error where the engine would raise one, "
+        "with this enabled."),
+
     Option("rgw_relaxed_s3_bucket_names", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
     .set_default(false)
     .set_description("RGW enable relaxed S3 bucket names")
@@ -6760,6 +6926,16 @@ std::vector<Option> get_rgw_options() {
     .set_default(10000)
     .set_description("Max number of parts in multipart upload"),
 
+    Option("rgw_multipart_complete_max_aio", Option::TYPE_INT, Option::LEVEL_ADVANCED)
+    .set_default(8)
+    .set_min(1)
+    .set_description("Max number of part listings read ahead when completing a multipart upload")
+    .set_long_description(
+        "When completing a multipart upload, the parts are read in batches of 1000. "
+        "This many batches are read concurrently while the manifest is built from "
+        "the ones already read.")
+    .add_see_also({"rgw_multipart_part_upload_limit"}),
+
     Option("rgw_max_slo_entries", Option::TYPE_INT, Option::LEVEL_ADVANCED)
     .set_default(1000)
     .set_description("Max number of entries in Swift Static Large Object manifest"),
@@ -6969,6 +7145,34 @@ std::vector<Option> get_rgw_options() {
     .add_tag("performance")
     .add_service("rgw"),
 
+    Option("rgw_reshard_online", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Copy the bucket index while writes to the bucket continue")
+    .set_long_description(
+        "When enabled, the bucket index shards record the names of objects "
+        "changed while their entries are copied to the new index, and writes "
+        "are only blocked while those objects are copied again before "
+        "switching to the new index. When disabled, writes are blocked for "
+        "the whole copy. All OSDs must be running a version that supports "
+        "this before it is enabled.")
+    .add_see_also({"rgw_reshard_batch_size",
+                   "rgw_reshard_online_catchup_passes"})
+    .add_tag("performance")
+    .add_service("rgw"),
+
+    Option("rgw_reshard_online_catchup_passes", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(3)
+    .set_description("Max passes over the reshard log before blocking writes")
+    .set_long_description(
+        "When resharding online, the objects changed while the index was "
+        "copied are copied again while writes continue, and again for what "
+        "changed during that pass, up to this many times. Passes stop early "
+        "once a pass had at most 1000 objects to copy. Writes are then blocked "
+        "only while the objects changed during the last pass are copied.")
+    .add_see_also("rgw_reshard_online")
+    .add_tag("performance")
+    .add_service("rgw"),
+
     Option("rgw_trust_forwarded_https", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
     .set_default(false)
     .set_description("Trust Forwarded and X-Forwarded-Proto headers")
@@ -8085,6 +8289,22 @@ std::vector<Option> get_mds_options() {
     .set_description("threshold for number of dentries that can be trimmed")
     .set_flag(Option::FLAG_RUNTIME),
 
+    Option("mds_cache_trim_slice", Option::TYPE_SIZE, Option::LEVEL_ADVANCED)
+    .set_default(16_K)
+    .set_description("maximum number of dentries trimmed per mds_lock hold by the cache upkeep thread")
+    .set_long_description("periodic cache trimming is split into slices of at most this many dentries and the mds_lock is released between slices so that client requests are not stalled behind trimming a very large cache. 0 trims everything in one go.")
+    .add_see_also("mds_cache_trim_threshold")
+    .add_see_also("mds_cache_trim_slice_interval")
+    .set_flag(Option::FLAG_RUNTIME),
+
+    Option("mds_cache_trim_slice_interval", Option::TYPE_MILLISECS, Option::LEVEL_ADVANCED)
+    .set_default(10)
+    .set_min(1)
+    .set_description("time the cache upkeep thread waits between trim slices")
+    .set_long_description("while the cache is over its limit, the upkeep thread trims one slice of mds_cache_trim_slice dentries, drops mds_lock and waits this long before trimming the next, so that requests queued for mds_lock run in between.")
+    .add_see_also("mds_cache_trim_slice")
+    .set_flag(Option::FLAG_RUNTIME),
+
     Option("mds_max_file_recover", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
     .set_default(32)
     .set_description("maximum number of files to recover file sizes in parallel"),
@@ -8266,6 +8486,19 @@ std::vector<Option> get_mds_options() {
     .set_default(128)
     .set_description("maximum number of segments which may be untrimmed"),
 
+    Option("mds_log_submit_encoders", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(2)
+    .set_description("number of threads encoding MDS journal events in parallel")
+    .set_long_description("events taken by the journal submit thread in one batch are encoded concurrently by this many helper threads before being appended to the journal in order. 0 encodes every event on the submit thread.")
+    .add_see_also("mds_log_submit_batch_events"),
+
+    Option("mds_log_submit_batch_events", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(128)
+    .set_min(1)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("maximum number of MDS journal events submitted in one batch")
+    .set_long_description("the journal submit thread takes up to this many pending events at a time, encodes them, appends them to the journal and issues a single flush for any flush requests queued among them."),
+
     Option("mds_log_warn_factor", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
     .set_default(2.0)
     .set_min(1.0)
@@ -8399,6 +8632,46 @@ std::vector<Option> get_mds_options() {
     .set_default(10.0)
     .set_description("rate of decay for export targets communicated to clients"),
 
+    Option("mds_bal_predictive", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("balance on predicted sustained load instead of instantaneous popularity")
+    .set_long_description("keep a short load history per rank and per subtree considered for export, and make rebalancing decisions on the smoothed, trend-projected load. Subtrees whose predicted load does not pay for the cost of migrating them, or which migrated recently, are not exported.")
+    .add_see_also("mds_bal_predictive_horizon")
+    .add_see_also("mds_bal_predictive_migration_cost")
+    .add_see_also("mds_bal_predictive_cooldown"),
+
+    Option("mds_bal_predictive_horizon", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(30.0)
+    .set_min(0.0)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("seconds ahead the predictive balancer projects load"),
+
+    Option("mds_bal_predictive_alpha", Option::TYPE_FLOAT, Option::LEVEL_DEV)
+    .set_default(.5)
+    .set_min_max(0.0, 1.0)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("level smoothing factor of the predictive balancer"),
+
+    Option("mds_bal_predictive_beta", Option::TYPE_FLOAT, Option::LEVEL_DEV)
+    .set_default(.3)
+    .set_min_max(0.0, 1.0)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("trend smoothing factor of the predictive balancer"),
+
+    Option("mds_bal_predictive_migration_cost", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(.01)
+    .set_min(0.0)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("estimated cost of migrating one metadata item, in load-seconds")
+    .set_long_description("a subtree is only exported if its predicted load over mds_bal_predictive_horizon exceeds this cost times the number of items in the dirfrag."),
+
+    Option("mds_bal_predictive_cooldown", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(60.0)
+    .set_min(0.0)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("seconds after a migration before the predictive balancer moves the same subtree again"),
+
     Option("mds_oft_prefetch_dirfrags", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
     .set_default(true)
     .set_description("prefetch dirfrags recorded in open file table on startup")
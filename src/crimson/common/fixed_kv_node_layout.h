@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
 
 #include "include/byteorder.h"
@@ -358,11 +359,9 @@ public:
   }
 
   const_iterator find(K l) const {
-    auto ret = begin();
-    for (; ret != end(); ++ret) {
-      if (ret->get_key() == l)
-	break;
-    }
+    auto ret = lower_bound(l);
+    if (ret != end() && ret->get_key() != l)
+      ret = end();
     return ret;
   }
   iterator find(K l) {
@@ -371,12 +370,7 @@ public:
   }
 
   const_iterator lower_bound(K l) const {
-    auto ret = begin();
-    for (; ret != end(); ++ret) {
-      if (ret->get_key() >= l)
-	break;
-    }
-    return ret;
+    return iter_idx(search(l, std::less<K>{}));
   }
   iterator lower_bound(K l) {
     const auto &tref = *this;
@@ -384,12 +378,7 @@ public:
   }
 
   const_iterator upper_bound(K l) const {
-    auto ret = begin();
-    for (; ret != end(); ++ret) {
-      if (ret->get_key() > l)
-	break;
-    }
-    return ret;
+    return iter_idx(search(l, std::less_equal<K>{}));
   }
   iterator upper_bound(K l) {
     const auto &tref = *this;
@@ -616,6 +605,34 @@ private:
     set_size(get_size() - 1);
   }
 
+  /// keys left when search() switches from bisecting to counting
+  static constexpr uint16_t SEARCH_LINEAR_KEYS = 16;
+
+  /**
+   * search
+   *
+   * Returns the offset of the first key for which cmp(key, l) is false,
+   * keys being sorted.  Bisects without branching on the comparison
+   * until SEARCH_LINEAR_KEYS keys are left, which are adjacent in the
+   * key array and are then counted in a loop the compiler can vectorize.
+   */
+  template <typename Cmp>
+  uint16_t search(K l, Cmp cmp) const {
+    const KINT *keys = get_key_ptr();
+    uint16_t base = 0;
+    uint16_t n = get_size();
+    while (n > SEARCH_LINEAR_KEYS) {
+      uint16_t half = n / 2;
+      base = cmp(K(keys[base + half]), l) ? base + half : base;
+      n -= half;
+    }
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < n; ++i) {
+      count += cmp(K(keys[base + i]), l);
+    }
+    return base + count;
+  }
+
   /**
    * get_key_ptr
    *
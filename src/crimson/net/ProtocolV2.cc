@@ -216,6 +216,20 @@ seastar::future<Socket::tmp_buf> ProtocolV2::read_exactly(size_t bytes)
   };
 }
 
+seastar::future<bufferptr>
+ProtocolV2::read_exactly_aligned(size_t bytes, size_t align)
+{
+  if (unlikely(record_io)) {
+    return socket->read_exactly_aligned(bytes, align)
+    .then([this] (auto bp) {
+      rxbuf.append(bp);
+      return bp;
+    });
+  } else {
+    return socket->read_exactly_aligned(bytes, align);
+  };
+}
+
 seastar::future<bufferlist> ProtocolV2::read(size_t bytes)
 {
   if (unlikely(record_io)) {
@@ -281,15 +295,22 @@ seastar::future<> ProtocolV2::read_frame_payload()
   return seastar::do_until(
     [this] { return rx_frame_asm.get_num_segments() == rx_segments_data.size(); },
     [this] {
-      // TODO: create aligned and contiguous buffer from socket
       const size_t seg_idx = rx_segments_data.size();
+      uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
       if (uint16_t alignment = rx_frame_asm.get_segment_align(seg_idx);
 	  alignment != segment_t::DEFAULT_ALIGNMENT) {
-        logger().trace("{} cannot allocate {} aligned buffer at segment desc index {}",
-                       conn, alignment, rx_segments_data.size());
+        // the message data segment: land it in a buffer with the alignment
+        // the sender asked for, so it can go all the way down to the store
+        // without being copied again to realign it
+        return read_exactly_aligned(onwire_len, alignment
+        ).then([this] (auto bp) {
+          logger().trace("{} RECV({}) frame segment[{}] aligned",
+                         conn, bp.length(), rx_segments_data.size());
+          bufferlist segment;
+          segment.append(std::move(bp));
+          rx_segments_data.emplace_back(std::move(segment));
+        });
       }
-      uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
-      // TODO: create aligned and contiguous buffer from socket
       return read_exactly(onwire_len).then([this] (auto tmp_bl) {
         logger().trace("{} RECV({}) frame segment[{}]",
                        conn, tmp_bl.size(), rx_segments_data.size());
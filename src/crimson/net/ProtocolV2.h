@@ -117,6 +117,7 @@ class ProtocolV2 final : public Protocol {
 
   void enable_recording();
   seastar::future<Socket::tmp_buf> read_exactly(size_t bytes);
+  seastar::future<bufferptr> read_exactly_aligned(size_t bytes, size_t align);
   seastar::future<bufferlist> read(size_t bytes);
   seastar::future<> write(bufferlist&& buf);
   seastar::future<> write_flush(bufferlist&& buf);
@@ -56,6 +56,33 @@ struct bufferlist_consumer {
   };
 };
 
+// an input_stream consumer that copies buffer segments into a preallocated
+// buffer until it is full
+struct bufferptr_consumer {
+  bufferptr& bp;
+  size_t& filled;
+
+  bufferptr_consumer(bufferptr& bp, size_t& filled)
+    : bp(bp), filled(filled) {}
+
+  using tmp_buf = seastar::temporary_buffer<char>;
+  using consumption_result_type = typename seastar::input_stream<char>::consumption_result_type;
+
+  seastar::future<consumption_result_type> operator()(tmp_buf&& data) {
+    size_t len = std::min(data.size(), bp.length() - filled);
+    bp.copy_in(filled, len, data.get());
+    filled += len;
+    data.trim_front(len);
+    if (filled < bp.length()) {
+      return seastar::make_ready_future<consumption_result_type>(
+          seastar::continue_consuming{});
+    }
+    // give the rest back to signal that we're done
+    return seastar::make_ready_future<consumption_result_type>(
+        consumption_result_type::stop_consuming_type{std::move(data)});
+  };
+};
+
 } // anonymous namespace
 
 seastar::future<bufferlist> Socket::read(size_t bytes)
@@ -108,6 +135,34 @@ Socket::read_exactly(size_t bytes) {
 #endif
 }
 
+seastar::future<bufferptr>
+Socket::read_exactly_aligned(size_t bytes, size_t align) {
+#ifdef UNIT_TESTS_BUILT
+  return try_trap_pre(next_trap_read).then([bytes, align, this] {
+#endif
+    if (bytes == 0) {
+      return seastar::make_ready_future<bufferptr>();
+    }
+    r_aligned.buffer = buffer::create_aligned(bytes, align);
+    r_aligned.filled = 0;
+    return in.consume(bufferptr_consumer{r_aligned.buffer, r_aligned.filled}
+    ).then([this] {
+      if (r_aligned.filled < r_aligned.buffer.length()) {
+        throw std::system_error(make_error_code(error::read_eof));
+      }
+      return seastar::make_ready_future<bufferptr>(
+        std::move(r_aligned.buffer));
+    });
+#ifdef UNIT_TESTS_BUILT
+  }).then([this] (auto bp) {
+    return try_trap_post(next_trap_read
+    ).then([bp = std::move(bp)] () mutable {
+      return std::move(bp);
+    });
+  });
+#endif
+}
+
 void Socket::shutdown() {
   socket.shutdown_input();
   socket.shutdown_output();
@@ -67,6 +67,9 @@ class Socket
   using tmp_buf = seastar::temporary_buffer<char>;
   using packet = seastar::net::packet;
   seastar::future<tmp_buf> read_exactly(size_t bytes);
+  /// read the requested number of bytes into a single buffer aligned to
+  /// the given boundary, copying straight out of the socket buffers
+  seastar::future<bufferptr> read_exactly_aligned(size_t bytes, size_t align);
 
   seastar::future<> write(packet&& buf) {
 #ifdef UNIT_TESTS_BUILT
@@ -145,6 +148,12 @@ class Socket
     size_t remaining;
   } r;
 
+  /// buffer state for read_exactly_aligned()
+  struct {
+    bufferptr buffer;
+    size_t filled;
+  } r_aligned;
+
 #ifdef UNIT_TESTS_BUILT
  public:
   void set_trap(bp_type_t type, bp_action_t action, socket_blocker* blocker_);
@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include <seastar/core/shared_future.hh>
+
 #include "os/ObjectStore.h"
 
 #include "crimson/os/futurized_collection.h"
@@ -21,6 +26,11 @@ public:
 
 private:
   ObjectStore::CollectionHandle collection;
+  /// transactions waiting for the submission in flight to be queued
+  std::vector<ceph::os::Transaction> pending_txns;
+  /// resolved once pending_txns have been queued to the store
+  std::unique_ptr<seastar::shared_promise<>> pending_queued;
+  bool submitting = false;
   friend AlienStore;
 };
 }
@@ -45,11 +45,16 @@ public:
       alien_done(done) {}
 
   void finish(int) final {
-    return seastar::alien::submit_to(cpuid, [this] {
-      if (oncommit) oncommit->complete(0);
-      alien_done.set_value();
-      return seastar::make_ready_future<>();
-    }).wait();
+    // don't hold up the finisher thread until the reactor gets to it, so
+    // that it can go on completing the other transactions of the batch.
+    // this context is gone by the time the reactor runs the callback.
+    std::ignore = seastar::alien::submit_to(
+      cpuid,
+      [oncommit=oncommit, &alien_done=alien_done] {
+	if (oncommit) oncommit->complete(0);
+	alien_done.set_value();
+	return seastar::make_ready_future<>();
+      });
   }
 };
 }
@@ -363,23 +368,68 @@ seastar::future<> AlienStore::do_transaction(CollectionRef ch,
     std::move(done),
     [this, ch, id] (auto &txn, auto &done) {
       return seastar::with_gate(transaction_gate, [this, ch, id, &txn, &done] {
-	return tp_mutex.lock().then ([this, ch, id, &txn, &done] {
-	  Context *crimson_wrapper =
-	    ceph::os::Transaction::collect_all_contexts(txn);
-	  return tp->submit([this, ch, id, crimson_wrapper, &txn, &done] {
-	    txn.register_on_commit(new OnCommit(id, done, crimson_wrapper, txn));
-	    auto c = static_cast<AlienCollection*>(ch.get());
-	    return store->queue_transaction(c->collection, std::move(txn));
-	  });
-	}).then([this, &done] (int r) {
-	  assert(r == 0);
-	  tp_mutex.unlock();
+	Context *crimson_wrapper =
+	  ceph::os::Transaction::collect_all_contexts(txn);
+	txn.register_on_commit(new OnCommit(id, done, crimson_wrapper, txn));
+	return queue_transaction(ch, std::move(txn)).then([&done] {
 	  return done.get_future();
 	});
       });
     });
 }
 
+seastar::future<> AlienStore::queue_transaction(CollectionRef ch,
+                                                ceph::os::Transaction&& txn)
+{
+  // Transactions on a collection have to reach the store in the order
+  // they were issued, so only one submission per collection is in the
+  // thread pool at a time. Whatever queues up behind it goes over to the
+  // thread pool together in the next submission, rather than paying a
+  // handoff apiece. Different collections are submitted concurrently.
+  auto c = static_cast<AlienCollection*>(ch.get());
+  c->pending_txns.push_back(std::move(txn));
+  if (!c->pending_queued) {
+    c->pending_queued = std::make_unique<seastar::shared_promise<>>();
+  }
+  auto queued = c->pending_queued->get_shared_future();
+  if (!c->submitting) {
+    submit_pending_transactions(ch);
+  }
+  return queued;
+}
+
+void AlienStore::submit_pending_transactions(CollectionRef ch)
+{
+  auto c = static_cast<AlienCollection*>(ch.get());
+  assert(!c->submitting);
+  assert(c->pending_queued);
+  c->submitting = true;
+  logger().debug("{}: {} transactions on {}",
+                 __func__, c->pending_txns.size(), ch->get_cid());
+  // the gate is held by the do_transaction() calls waiting on this batch
+  std::ignore = seastar::do_with(
+    std::move(c->pending_txns),
+    std::move(c->pending_queued),
+    [this, ch, c] (auto &txns, auto &queued) {
+      c->pending_txns.clear();
+      return tp->submit([this, c, &txns] {
+	return store->queue_transactions(c->collection, txns);
+      }).then_wrapped([this, ch, c, &queued] (auto f) {
+	if (f.failed()) {
+	  queued->set_exception(f.get_exception());
+	} else {
+	  [[maybe_unused]] int r = f.get0();
+	  assert(r == 0);
+	  queued->set_value();
+	}
+	c->submitting = false;
+	if (!c->pending_txns.empty()) {
+	  submit_pending_transactions(ch);
+	}
+      });
+    });
+}
+
 seastar::future<> AlienStore::write_meta(const std::string& key,
                                          const std::string& value)
 {
@@ -4,7 +4,6 @@
 #pragma once
 
 #include <seastar/core/future.hh>
-#include <seastar/core/shared_mutex.hh>
 
 #include "common/ceph_context.h"
 #include "os/ObjectStore.h"
@@ -112,6 +111,11 @@ public:
     const ghobject_t& oid) final;
 
 private:
+  /// queues txn on ch behind those already queued, in batches
+  seastar::future<> queue_transaction(CollectionRef ch,
+                                      ceph::os::Transaction&& txn);
+  void submit_pending_transactions(CollectionRef ch);
+
   constexpr static unsigned MAX_KEYS_PER_OMAP_GET_CALL = 32;
   mutable std::unique_ptr<crimson::os::ThreadPool> tp;
   const std::string path;
@@ -120,6 +124,5 @@ private:
   std::unique_ptr<CephContext> cct;
   seastar::gate transaction_gate;
   std::unordered_map<coll_t, CollectionRef> coll_map;
-  seastar::shared_mutex tp_mutex;
 };
 }
@@ -1,8 +1,17 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab
 
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
 #include "crimson/os/seastore/cache.h"
+#include "common/perf_counters.h"
 #include "crimson/common/log.h"
+#include "crimson/common/perf_counters_collection.h"
 
 // included for get_extent_by_type
 #include "crimson/os/seastore/extentmap_manager/btree/extentmap_btree_node_impl.h"
@@ -20,19 +29,242 @@ namespace {
 
 namespace crimson::os::seastore {
 
-Cache::Cache(SegmentManager &segment_manager) :
-  segment_manager(segment_manager) {}
+namespace {
+
+/// extent types are accounted in these groups
+enum class cache_group_t : int {
+  LBA,
+  ONODE,
+  OMAP,
+  EXTMAP,
+  DATA,
+  NUM_GROUPS
+};
+
+cache_group_t get_cache_group(extent_types_t type)
+{
+  switch (type) {
+  case extent_types_t::LADDR_INTERNAL:
+  case extent_types_t::LADDR_LEAF:
+    return cache_group_t::LBA;
+  case extent_types_t::ONODE_BLOCK:
+  case extent_types_t::ONODE_BLOCK_STAGED:
+    return cache_group_t::ONODE;
+  case extent_types_t::OMAP_INNER:
+  case extent_types_t::OMAP_LEAF:
+    return cache_group_t::OMAP;
+  case extent_types_t::EXTMAP_INNER:
+  case extent_types_t::EXTMAP_LEAF:
+    return cache_group_t::EXTMAP;
+  default:
+    return cache_group_t::DATA;
+  }
+}
+
+// hit, miss and lru bytes counters for each cache_group_t, in that order
+enum {
+  l_seastore_cache_first = 1000,
+  l_seastore_cache_lba_hit,
+  l_seastore_cache_lba_miss,
+  l_seastore_cache_lba_lru_bytes,
+  l_seastore_cache_onode_hit,
+  l_seastore_cache_onode_miss,
+  l_seastore_cache_onode_lru_bytes,
+  l_seastore_cache_omap_hit,
+  l_seastore_cache_omap_miss,
+  l_seastore_cache_omap_lru_bytes,
+  l_seastore_cache_extmap_hit,
+  l_seastore_cache_extmap_miss,
+  l_seastore_cache_extmap_lru_bytes,
+  l_seastore_cache_data_hit,
+  l_seastore_cache_data_miss,
+  l_seastore_cache_data_lru_bytes,
+  l_seastore_cache_lru_bytes,
+  l_seastore_cache_lru_extents,
+  l_seastore_cache_lru_evictions,
+  l_seastore_cache_last
+};
+
+constexpr int COUNTERS_PER_GROUP = 3;
+
+int get_group_counter(extent_types_t type, int which)
+{
+  return l_seastore_cache_first + 1 +
+    static_cast<int>(get_cache_group(type)) * COUNTERS_PER_GROUP + which;
+}
+
+int get_hit_counter(extent_types_t type, bool hit)
+{
+  return get_group_counter(type, hit ? 0 : 1);
+}
+
+int get_lru_bytes_counter(extent_types_t type)
+{
+  return get_group_counter(type, 2);
+}
+
+PerfCounters *build_cache_logger()
+{
+  PerfCountersBuilder plb(
+    nullptr, "seastore_cache",
+    l_seastore_cache_first, l_seastore_cache_last);
+  static constexpr const char *groups[] = {
+    "lba", "onode", "omap", "extmap", "data"
+  };
+  static_assert(std::size(groups) ==
+		static_cast<size_t>(cache_group_t::NUM_GROUPS));
+  // PerfCountersBuilder keeps the name pointers, so they must outlive it
+  static const auto names = [] {
+    std::vector<std::string> names;
+    for (auto group : groups) {
+      names.push_back(fmt::format("{}_hit", group));
+      names.push_back(fmt::format("{}_miss", group));
+      names.push_back(fmt::format("{}_lru_bytes", group));
+    }
+    return names;
+  }();
+  for (size_t i = 0; i < std::size(groups); ++i) {
+    const int base = l_seastore_cache_first + 1 + i * COUNTERS_PER_GROUP;
+    plb.add_u64_counter(
+      base, names[i * COUNTERS_PER_GROUP].c_str(),
+      "Lookups of cached extents of this type");
+    plb.add_u64_counter(
+      base + 1, names[i * COUNTERS_PER_GROUP + 1].c_str(),
+      "Lookups of extents of this type which had to be read");
+    plb.add_u64(
+      base + 2, names[i * COUNTERS_PER_GROUP + 2].c_str(),
+      "Bytes of clean extents of this type held by the lru");
+  }
+  plb.add_u64(l_seastore_cache_lru_bytes, "lru_bytes",
+	      "Bytes of clean extents held by the lru");
+  plb.add_u64(l_seastore_cache_lru_extents, "lru_extents",
+	      "Number of clean extents held by the lru");
+  plb.add_u64_counter(l_seastore_cache_lru_evictions, "lru_evictions",
+		      "Clean extents evicted from the lru");
+  return plb.create_perf_counters();
+}
+
+}
+
+Cache::Cache(
+  SegmentManager &segment_manager,
+  size_t lru_capacity,
+  RandomBlockManager *rbm) :
+  segment_manager(segment_manager),
+  rbm(rbm),
+  perf_logger(build_cache_logger()),
+  lru(lru_capacity, *perf_logger)
+{
+  using crimson::common::sharded_perf_coll;
+  using crimson::common::local_perf_coll;
+  if (sharded_perf_coll().local_is_initialized()) {
+    local_perf_coll().get_perf_collection()->add(perf_logger.get());
+  }
+}
 
 Cache::~Cache()
 {
+  using crimson::common::sharded_perf_coll;
+  using crimson::common::local_perf_coll;
+  lru.clear();
   for (auto &i: extents) {
     logger().error("~Cache: extent {} still alive", i);
   }
   ceph_assert(extents.empty());
+  if (sharded_perf_coll().local_is_initialized()) {
+    local_perf_coll().get_perf_collection()->remove(perf_logger.get());
+  }
+}
+
+void Cache::LRU::trim_to_capacity()
+{
+  while (contents > capacity) {
+    assert(lru.size() > 0);
+    perf_logger.inc(l_seastore_cache_lru_evictions);
+    remove_from_lru(lru.front());
+  }
+}
+
+void Cache::LRU::add_to_lru(CachedExtent &extent)
+{
+  assert(
+    extent.is_clean() &&
+    !extent.is_pending() &&
+    !extent.primary_ref_list_hook.is_linked());
+  contents += extent.get_length();
+  intrusive_ptr_add_ref(&extent);
+  lru.push_back(extent);
+  perf_logger.inc(
+    get_lru_bytes_counter(extent.get_type()), extent.get_length());
+  perf_logger.set(l_seastore_cache_lru_bytes, contents);
+  perf_logger.set(l_seastore_cache_lru_extents, lru.size());
+}
+
+void Cache::LRU::remove_from_lru(CachedExtent &extent)
+{
+  if (!extent.primary_ref_list_hook.is_linked()) {
+    return;
+  }
+  assert(contents >= extent.get_length());
+  contents -= extent.get_length();
+  lru.erase(lru.s_iterator_to(extent));
+  perf_logger.dec(
+    get_lru_bytes_counter(extent.get_type()), extent.get_length());
+  perf_logger.set(l_seastore_cache_lru_bytes, contents);
+  perf_logger.set(l_seastore_cache_lru_extents, lru.size());
+  // may destroy extent, removing it from Cache::extents
+  intrusive_ptr_release(&extent);
+}
+
+void Cache::LRU::move_to_top(CachedExtent &extent)
+{
+  if (extent.primary_ref_list_hook.is_linked()) {
+    lru.erase(lru.s_iterator_to(extent));
+    lru.push_back(extent);
+  } else {
+    add_to_lru(extent);
+    trim_to_capacity();
+  }
+}
+
+void Cache::LRU::clear()
+{
+  while (!lru.empty()) {
+    remove_from_lru(lru.front());
+  }
+}
+
+void Cache::account_lookup(extent_types_t type, bool hit)
+{
+  perf_logger->inc(get_hit_counter(type, hit));
+}
+
+bool Cache::is_rbm_type(extent_types_t type) const
+{
+  return rbm &&
+    is_logical_type(type) &&
+    get_cache_group(type) == cache_group_t::DATA;
+}
+
+Cache::get_extent_ertr::future<> Cache::read_extent(
+  paddr_t offset,
+  segment_off_t length,
+  ceph::bufferptr &out)
+{
+  if (offset.is_rbm()) {
+    assert(rbm);
+    assert(out.length() == (size_t)length);
+    return rbm->read(get_rbm_blk(offset), out).handle_error(
+      get_extent_ertr::pass_further{},
+      crimson::ct_error::discard_all{});
+  }
+  return segment_manager.read(offset, length, out).handle_error(
+    get_extent_ertr::pass_further{},
+    crimson::ct_error::discard_all{});
 }
 
 Cache::retire_extent_ret Cache::retire_extent_if_cached(
-  Transaction &t, paddr_t addr)
+  Transaction &t, paddr_t addr, extent_len_t length)
 {
   if (auto ext = t.write_set.find_offset(addr); ext != t.write_set.end()) {
     logger().debug("{}: found {} in t.write_set", __func__, addr);
@@ -46,6 +278,10 @@ Cache::retire_extent_ret Cache::retire_extent_if_cached(
       return retire_extent_ertr::now();
     });
   } else {
+    if (addr.is_rbm()) {
+      logger().debug("{}: releasing uncached {}~{}", __func__, addr, length);
+      t.add_rbm_release(get_rbm_blk(addr), length);
+    }
     return retire_extent_ertr::now();
   }
 }
@@ -58,7 +294,7 @@ void Cache::add_extent(CachedExtentRef ref)
   if (ref->is_dirty()) {
     add_to_dirty(ref);
   } else {
-    ceph_assert(!ref->primary_ref_list_hook.is_linked());
+    touch_extent(*ref);
   }
   logger().debug("add_extent: {}", *ref);
 }
@@ -70,6 +306,7 @@ void Cache::mark_dirty(CachedExtentRef ref)
     return;
   }
 
+  lru.remove_from_lru(*ref);
   add_to_dirty(ref);
   ref->state = CachedExtent::extent_state_t::DIRTY;
 
@@ -95,7 +332,7 @@ void Cache::remove_extent(CachedExtentRef ref)
     dirty.erase(dirty.s_iterator_to(*ref));
     intrusive_ptr_release(&*ref);
   } else {
-    ceph_assert(!ref->primary_ref_list_hook.is_linked());
+    lru.remove_from_lru(*ref);
   }
 }
 
@@ -120,6 +357,7 @@ void Cache::replace_extent(CachedExtentRef next, CachedExtentRef prev)
     intrusive_ptr_release(&*prev);
     intrusive_ptr_add_ref(&*next);
   } else {
+    lru.remove_from_lru(*prev);
     add_to_dirty(next);
   }
 
@@ -129,7 +367,8 @@ void Cache::replace_extent(CachedExtentRef next, CachedExtentRef prev)
 CachedExtentRef Cache::alloc_new_extent_by_type(
   Transaction &t,       ///< [in, out] current transaction
   extent_types_t type,  ///< [in] type tag
-  segment_off_t length  ///< [in] length
+  segment_off_t length, ///< [in] length
+  paddr_t rbm_addr      ///< [in] allocated blocks, if any
 )
 {
   switch (type) {
@@ -137,23 +376,27 @@ CachedExtentRef Cache::alloc_new_extent_by_type(
     assert(0 == "ROOT is never directly alloc'd");
     return CachedExtentRef();
   case extent_types_t::LADDR_INTERNAL:
-    return alloc_new_extent<lba_manager::btree::LBAInternalNode>(t, length);
+    return alloc_new_extent<lba_manager::btree::LBAInternalNode>(
+      t, length, rbm_addr);
   case extent_types_t::LADDR_LEAF:
-    return alloc_new_extent<lba_manager::btree::LBALeafNode>(t, length);
+    return alloc_new_extent<lba_manager::btree::LBALeafNode>(
+      t, length, rbm_addr);
   case extent_types_t::ONODE_BLOCK:
-    return alloc_new_extent<OnodeBlock>(t, length);
+    return alloc_new_extent<OnodeBlock>(t, length, rbm_addr);
   case extent_types_t::EXTMAP_INNER:
-    return alloc_new_extent<extentmap_manager::ExtMapInnerNode>(t, length);
+    return alloc_new_extent<extentmap_manager::ExtMapInnerNode>(
+      t, length, rbm_addr);
   case extent_types_t::EXTMAP_LEAF:
-    return alloc_new_extent<extentmap_manager::ExtMapLeafNode>(t, length);
+    return alloc_new_extent<extentmap_manager::ExtMapLeafNode>(
+      t, length, rbm_addr);
   case extent_types_t::OMAP_INNER:
-    return alloc_new_extent<omap_manager::OMapInnerNode>(t, length);
+    return alloc_new_extent<omap_manager::OMapInnerNode>(t, length, rbm_addr);
   case extent_types_t::OMAP_LEAF:
-    return alloc_new_extent<omap_manager::OMapLeafNode>(t, length);
+    return alloc_new_extent<omap_manager::OMapLeafNode>(t, length, rbm_addr);
   case extent_types_t::TEST_BLOCK:
-    return alloc_new_extent<TestBlock>(t, length);
+    return alloc_new_extent<TestBlock>(t, length, rbm_addr);
   case extent_types_t::TEST_BLOCK_PHYSICAL:
-    return alloc_new_extent<TestBlockPhysical>(t, length);
+    return alloc_new_extent<TestBlockPhysical>(t, length, rbm_addr);
   case extent_types_t::NONE: {
     ceph_assert(0 == "NONE is an invalid extent type");
     return CachedExtentRef();
@@ -262,6 +505,10 @@ std::optional<record_t> Cache::try_construct_record(Transaction &t)
 
   record.extents.reserve(t.fresh_block_list.size());
   for (auto &i: t.fresh_block_list) {
+    if (i->get_paddr().is_rbm()) {
+      logger().debug("try_construct_record: fresh rbm block {}", *i);
+      continue;
+    }
     logger().debug("try_construct_record: fresh block {}", *i);
     bufferlist bl;
     i->prepare_write();
@@ -283,31 +530,68 @@ std::optional<record_t> Cache::try_construct_record(Transaction &t)
   return std::make_optional<record_t>(std::move(record));
 }
 
+Cache::write_rbm_extents_ertr::future<> Cache::write_rbm_extents(
+  Transaction &t)
+{
+  if (!rbm) {
+    return write_rbm_extents_ertr::now();
+  }
+  return crimson::do_for_each(
+    t.fresh_block_list,
+    [this](auto &i) -> RandomBlockManager::write_ertr::future<> {
+      if (!i->get_paddr().is_rbm() || !i->is_valid()) {
+	return RandomBlockManager::write_ertr::now();
+      }
+      logger().debug("write_rbm_extents: writing {}", *i);
+      i->prepare_write();
+      return rbm->write(get_rbm_blk(i->get_paddr()), i->get_bptr());
+    }).safe_then([this] {
+      return rbm->sync_allocation();
+    }).handle_error(
+      write_rbm_extents_ertr::pass_further{},
+      crimson::ct_error::assert_all{
+	"Invalid error in Cache::write_rbm_extents"
+      });
+}
+
 void Cache::complete_commit(
   Transaction &t,
   paddr_t final_block_start,
   journal_seq_t seq,
   SegmentCleaner *cleaner)
 {
+  // blocks of retired rbm extents are reused by an extent rewritten in
+  // place, see TransactionManager::rewrite_extent
+  std::set<paddr_t> rbm_rewritten;
   for (auto &i: t.fresh_block_list) {
-    i->set_paddr(final_block_start.add_relative(i->get_paddr()));
+    const bool in_rbm = i->get_paddr().is_rbm();
+    if (!in_rbm) {
+      i->set_paddr(final_block_start.add_relative(i->get_paddr()));
+    }
     i->last_committed_crc = i->get_crc32c();
     i->on_initial_write();
 
     if (!i->is_valid()) {
       logger().debug("complete_commit: invalid {}", *i);
+      if (in_rbm) {
+	rbm->free_extent(get_rbm_blk(i->get_paddr()), i->get_length());
+      }
       continue;
     }
 
     i->state = CachedExtent::extent_state_t::CLEAN;
     logger().debug("complete_commit: fresh {}", *i);
     add_extent(i);
-    if (cleaner) {
+    if (in_rbm) {
+      rbm_rewritten.insert(i->get_paddr());
+    } else if (cleaner) {
       cleaner->mark_space_used(
 	i->get_paddr(),
 	i->get_length());
     }
   }
+  // the rest are referenced by the record now
+  t.rbm_allocated.clear();
 
   // Add new copy of mutated blocks, set_io_wait to block until written
   for (auto &i: t.mutated_block_list) {
@@ -325,13 +609,21 @@ void Cache::complete_commit(
     }
   }
 
-  if (cleaner) {
-    for (auto &i: t.retired_set) {
+  for (auto &i: t.retired_set) {
+    if (i->get_paddr().is_rbm()) {
+      // written out with the next write_rbm_extents
+      if (!rbm_rewritten.count(i->get_paddr())) {
+	rbm->free_extent(get_rbm_blk(i->get_paddr()), i->get_length());
+      }
+    } else if (cleaner) {
       cleaner->mark_space_free(
 	i->get_paddr(),
 	i->get_length());
     }
   }
+  for (auto &[blk, len] : t.rbm_released) {
+    rbm->free_extent(blk, len);
+  }
 
   for (auto &i: t.mutated_block_list) {
     i->complete_io();
@@ -370,7 +662,16 @@ Cache::close_ertr::future<> Cache::close()
     dirty.erase(i++);
     intrusive_ptr_release(ptr);
   }
-  return close_ertr::now();
+  lru.clear();
+  if (!rbm) {
+    return close_ertr::now();
+  }
+  // releases since the last write_rbm_extents
+  return rbm->sync_allocation().handle_error(
+    close_ertr::pass_further{},
+    crimson::ct_error::assert_all{
+      "Invalid error in Cache::close"
+    });
 }
 
 Cache::replay_delta_ret
@@ -386,6 +687,8 @@ Cache::replay_delta(
     root->dirty_from = journal_seq;
     add_extent(root);
     return replay_delta_ertr::now();
+  } else if (delta.paddr.is_rbm()) {
+    return replay_rbm_delta(record_base, delta);
   } else {
     auto get_extent_if_cached = [this](paddr_t addr)
       -> get_extent_ertr::future<CachedExtentRef> {
@@ -439,6 +742,83 @@ Cache::replay_delta(
   }
 }
 
+Cache::replay_delta_ret
+Cache::replay_rbm_delta(
+  paddr_t record_base,
+  const delta_info_t &delta)
+{
+  /* The extent is overwritten in place when written back, so the disk
+   * may already hold the result of this delta and of later ones.  Only
+   * apply it if the extent is still what the delta was made against,
+   * and write the result straight back so that the extent isn't left
+   * dirty.  The extent is dropped again either way, as its blocks may
+   * since have been released and reused by a later delta's extent.
+   * This relies on an in place write of an extent not being torn.
+   */
+  return get_extent_by_type(
+    delta.type,
+    delta.paddr,
+    delta.laddr,
+    delta.length
+  ).handle_error(
+    replay_delta_ertr::pass_further{},
+    crimson::ct_error::assert_all{
+      "Invalid error in Cache::replay_rbm_delta"
+    }
+  ).safe_then([this, record_base, &delta](auto extent)
+	      -> replay_delta_ertr::future<> {
+    if (extent->last_committed_crc != delta.prev_crc) {
+      logger().debug(
+	"replay_rbm_delta: {} already written past {}",
+	*extent,
+	delta);
+      remove_extent(extent);
+      return replay_delta_ertr::now();
+    }
+
+    logger().debug(
+      "replay_rbm_delta: replaying {} on {}",
+      *extent,
+      delta);
+    extent->apply_delta_and_adjust_crc(record_base, delta.bl);
+    assert(extent->last_committed_crc == delta.final_crc);
+    extent->prepare_write();
+    return rbm->write(
+      get_rbm_blk(extent->get_paddr()),
+      extent->get_bptr()
+    ).handle_error(
+      replay_delta_ertr::pass_further{},
+      crimson::ct_error::assert_all{
+	"Invalid error in Cache::replay_rbm_delta"
+      }
+    ).safe_then([this, extent] {
+      remove_extent(extent);
+    });
+  });
+}
+
+Cache::replay_delta_ret
+Cache::prefetch_delta_extent(const delta_info_t &delta)
+{
+  assert(delta.type != extent_types_t::ROOT);
+  assert(delta.pversion == 0);
+  if (delta.paddr.is_rbm()) {
+    // replay_rbm_delta reads it back itself
+    return replay_delta_ertr::now();
+  }
+  return get_extent_by_type(
+    delta.type,
+    delta.paddr,
+    delta.laddr,
+    delta.length
+  ).handle_error(
+    replay_delta_ertr::pass_further{},
+    crimson::ct_error::assert_all{
+      "Invalid error in Cache::prefetch_delta_extent"
+    }
+  ).safe_then([](auto) {});
+}
+
 Cache::get_next_dirty_extents_ret Cache::get_next_dirty_extents(
   journal_seq_t seq)
 {
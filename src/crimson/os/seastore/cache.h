@@ -8,6 +8,7 @@
 #include "seastar/core/shared_future.hh"
 
 #include "include/buffer.h"
+#include "include/common_fwd.h"
 #include "crimson/os/seastore/seastore_types.h"
 #include "crimson/os/seastore/transaction.h"
 #include "crimson/os/seastore/segment_manager.h"
@@ -15,6 +16,7 @@
 #include "crimson/os/seastore/cached_extent.h"
 #include "crimson/os/seastore/root_block.h"
 #include "crimson/os/seastore/segment_cleaner.h"
+#include "crimson/os/seastore/random_block_manager.h"
 
 namespace crimson::os::seastore {
 
@@ -80,6 +82,19 @@ namespace crimson::os::seastore {
  *   CachedExtent::delta_written(paddr_t) with the address of the start
  *   of the record
  * - Complete all promises with the final record start paddr_t
+ *
+ * Clean extents are kept alive by an LRU bounded by lru_capacity bytes,
+ * so that recently used extents are still cached once no transaction or
+ * parent node refers to them.  Dirty extents are held by the dirty list
+ * until they are written back and don't count towards lru_capacity.
+ *
+ * If given a RandomBlockManager, data extents allocated through
+ * alloc_new_data_extent are placed in it rather than in the record.
+ * Such an extent is written in place before its record is submitted, see
+ * write_rbm_extents, and keeps its paddr for its whole life: mutations
+ * are journaled as deltas as usual, and writing back a dirty one
+ * overwrites it in place (see TransactionManager::rewrite_extent), so the
+ * SegmentCleaner never has to move it.
  */
 class Cache {
 public:
@@ -87,7 +102,12 @@ public:
     crimson::ct_error::input_output_error,
     crimson::ct_error::eagain>;
 
-  Cache(SegmentManager &segment_manager);
+  static constexpr size_t DEFAULT_LRU_CAPACITY = 64 << 20;
+
+  Cache(
+    SegmentManager &segment_manager,
+    size_t lru_capacity = DEFAULT_LRU_CAPACITY,
+    RandomBlockManager *rbm = nullptr);
   ~Cache();
 
   /**
@@ -106,11 +126,17 @@ public:
     t.add_to_retired_set(ref);
   }
 
-  /// Declare paddr retired in t, noop if not cached
+  /**
+   * retire_extent_if_cached
+   *
+   * Declare paddr~length retired in t, noop if not cached unless it is
+   * in the RandomBlockManager, whose blocks are then released once t
+   * commits.
+   */
   using retire_extent_ertr = base_ertr;
   using retire_extent_ret = retire_extent_ertr::future<>;
   retire_extent_ret retire_extent_if_cached(
-    Transaction &t, paddr_t addr);
+    Transaction &t, paddr_t addr, extent_len_t length);
 
   /**
    * get_root
@@ -147,6 +173,8 @@ public:
     if (auto iter = extents.find_offset(offset);
 	       iter != extents.end()) {
       auto ret = TCachedExtentRef<T>(static_cast<T*>(&*iter));
+      account_lookup(ret->get_type(), true);
+      touch_extent(*ret);
       return ret->wait_io().then([ret=std::move(ret)]() mutable {
 	return get_extent_ertr::make_ready_future<TCachedExtentRef<T>>(
 	  std::move(ret));
@@ -157,9 +185,10 @@ public:
       ref->set_io_wait();
       ref->set_paddr(offset);
       ref->state = CachedExtent::extent_state_t::CLEAN;
+      account_lookup(ref->get_type(), false);
       add_extent(ref);
 
-      return segment_manager.read(
+      return read_extent(
 	offset,
 	length,
 	ref->get_bptr()).safe_then(
@@ -171,9 +200,7 @@ public:
 	    ref->complete_io();
 	    return get_extent_ertr::make_ready_future<TCachedExtentRef<T>>(
 	      std::move(ref));
-	  },
-	  get_extent_ertr::pass_further{},
-	  crimson::ct_error::discard_all{});
+	  });
     }
   }
 
@@ -299,31 +326,69 @@ public:
   /**
    * alloc_new_extent
    *
-   * Allocates a fresh extent.  addr will be relative until commit.
+   * Allocates a fresh extent.  addr will be relative until commit unless
+   * rbm_addr is passed, in which case the extent is written in place
+   * there.
    */
   template <typename T>
   TCachedExtentRef<T> alloc_new_extent(
     Transaction &t,      ///< [in, out] current transaction
-    segment_off_t length ///< [in] length
+    segment_off_t length, ///< [in] length
+    paddr_t rbm_addr = P_ADDR_NULL ///< [in] allocated blocks, if any
   ) {
     auto ret = CachedExtent::make_cached_extent_ref<T>(
       alloc_cache_buf(length));
-    t.add_fresh_extent(ret);
-    ret->state = CachedExtent::extent_state_t::INITIAL_WRITE_PENDING;
+    add_fresh_extent(t, ret, rbm_addr);
     return ret;
   }
 
   /**
    * alloc_new_extent
    *
-   * Allocates a fresh extent.  addr will be relative until commit.
+   * Allocates a fresh extent.  addr will be relative until commit unless
+   * rbm_addr is passed, in which case the extent is written in place
+   * there.
    */
   CachedExtentRef alloc_new_extent_by_type(
     Transaction &t,       ///< [in, out] current transaction
     extent_types_t type,  ///< [in] type tag
-    segment_off_t length  ///< [in] length
+    segment_off_t length, ///< [in] length
+    paddr_t rbm_addr = P_ADDR_NULL ///< [in] allocated blocks, if any
     );
 
+  /**
+   * alloc_new_data_extent
+   *
+   * As alloc_new_extent, but if there is a RandomBlockManager and T is a
+   * data extent, allocates its blocks from the RandomBlockManager.  The
+   * blocks are released again if t doesn't commit.
+   */
+  using alloc_new_data_extent_ertr = base_ertr;
+  template <typename T>
+  alloc_new_data_extent_ertr::future<TCachedExtentRef<T>>
+  alloc_new_data_extent(
+    Transaction &t,      ///< [in, out] current transaction
+    segment_off_t length ///< [in] length
+  ) {
+    auto ret = CachedExtent::make_cached_extent_ref<T>(
+      alloc_cache_buf(length));
+    if (!is_rbm_type(ret->get_type())) {
+      add_fresh_extent(t, ret, P_ADDR_NULL);
+      return alloc_new_data_extent_ertr::make_ready_future<
+	TCachedExtentRef<T>>(std::move(ret));
+    }
+    return rbm->alloc_extent(length).safe_then(
+      [this, &t, length, ret=std::move(ret)](auto blk) mutable {
+	t.add_rbm_allocation(*rbm, blk, length);
+	add_fresh_extent(t, ret, make_rbm_paddr(blk));
+	return std::move(ret);
+      }).handle_error(
+	alloc_new_data_extent_ertr::pass_further{},
+	crimson::ct_error::assert_all{
+	  "Invalid error in Cache::alloc_new_data_extent, out of space"
+	});
+  }
+
   /**
    * Allocates mutable buffer from extent_set on offset~len
    *
@@ -353,6 +418,17 @@ public:
     Transaction &t ///< [in, out] current transaction
   );
 
+  /**
+   * write_rbm_extents
+   *
+   * Writes out the fresh extents of t placed in the RandomBlockManager
+   * and then the allocation bitmap.  Must be called after
+   * try_construct_record, and complete before the record is submitted.
+   */
+  using write_rbm_extents_ertr = crimson::errorator<
+    crimson::ct_error::input_output_error>;
+  write_rbm_extents_ertr::future<> write_rbm_extents(Transaction &t);
+
   /**
    * complete_commit
    *
@@ -385,6 +461,7 @@ public:
   /**
    * close
    *
+   * Writes out the allocation bitmap of the RandomBlockManager, if any.
    * TODO: should flush dirty blocks
    */
   using close_ertr = crimson::errorator<
@@ -406,6 +483,15 @@ public:
     paddr_t record_block_base,
     const delta_info_t &delta);
 
+  /**
+   * prefetch_delta_extent
+   *
+   * Reads in the extent a version 0 delta applies to so that a later
+   * replay_delta for it finds the extent cached.  Unlike replay_delta,
+   * may be called concurrently.
+   */
+  replay_delta_ret prefetch_delta_extent(const delta_info_t &delta);
+
   /**
    * init_cached_extents
    *
@@ -482,11 +568,68 @@ public:
   get_next_dirty_extents_ret get_next_dirty_extents(
     journal_seq_t seq);
 
+  /// bytes of clean extents held by the lru
+  size_t get_lru_size() const {
+    return lru.get_current_contents_bytes();
+  }
+
+  /// number of clean extents held by the lru
+  size_t get_lru_num_extents() const {
+    return lru.get_current_contents_extents();
+  }
+
 private:
   SegmentManager &segment_manager; ///< ref to segment_manager
+  RandomBlockManager *rbm;         ///< places data extents if not null
   RootBlockRef root;               ///< ref to current root
   ExtentIndex extents;             ///< set of live extents
 
+  /// hit/miss and per extent type lru counters, see cache.cc
+  std::unique_ptr<PerfCounters> perf_logger;
+
+  /**
+   * LRU
+   *
+   * Holds a ref to each clean extent it contains, evicting the least
+   * recently used ones once their total length exceeds capacity.
+   * Eviction only drops the lru's ref, so an extent which is still
+   * referenced elsewhere stays in Cache::extents until released.
+   * Shares CachedExtent::primary_ref_list_hook with the dirty list,
+   * an extent is never in both.
+   */
+  class LRU {
+    const size_t capacity;
+    PerfCounters &perf_logger;
+    size_t contents = 0;
+    CachedExtent::list lru;
+
+    void trim_to_capacity();
+    void add_to_lru(CachedExtent &extent);
+
+  public:
+    LRU(size_t capacity, PerfCounters &perf_logger)
+      : capacity(capacity), perf_logger(perf_logger) {}
+
+    size_t get_current_contents_bytes() const {
+      return contents;
+    }
+
+    size_t get_current_contents_extents() const {
+      return lru.size();
+    }
+
+    void remove_from_lru(CachedExtent &extent);
+
+    /// (re)insert extent as most recently used, then trim
+    void move_to_top(CachedExtent &extent);
+
+    void clear();
+
+    ~LRU() {
+      clear();
+    }
+  } lru;
+
   /**
    * dirty
    *
@@ -494,6 +637,41 @@ private:
    */
   CachedExtent::list dirty;
 
+  /// Mark clean extent as most recently used
+  void touch_extent(CachedExtent &ext) {
+    if (ext.is_valid() && ext.is_clean() && !ext.is_pending()) {
+      lru.move_to_top(ext);
+    }
+  }
+
+  /// Count a lookup of an extent of type in the hit/miss counters
+  void account_lookup(extent_types_t type, bool hit);
+
+  /// true if fresh extents of type are placed in rbm
+  bool is_rbm_type(extent_types_t type) const;
+
+  /// Adds fresh extent ref to t, placed at rbm_addr if not null
+  void add_fresh_extent(
+    Transaction &t, CachedExtentRef ref, paddr_t rbm_addr) {
+    if (rbm_addr != P_ADDR_NULL) {
+      assert(rbm && rbm_addr.is_rbm());
+      ref->set_paddr(rbm_addr);
+    }
+    t.add_fresh_extent(ref);
+    ref->state = CachedExtent::extent_state_t::INITIAL_WRITE_PENDING;
+  }
+
+  /// Read offset~length from segment_manager or rbm into out
+  get_extent_ertr::future<> read_extent(
+    paddr_t offset,
+    segment_off_t length,
+    ceph::bufferptr &out);
+
+  /// replay_delta for an extent placed in rbm
+  replay_delta_ret replay_rbm_delta(
+    paddr_t record_base,
+    const delta_info_t &delta);
+
   /// alloc buffer for cached extent
   bufferptr alloc_cache_buf(size_t size) {
     // TODO: memory pooling etc
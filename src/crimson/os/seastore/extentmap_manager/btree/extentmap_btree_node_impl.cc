@@ -217,13 +217,11 @@ ExtMapInnerNode::merge_entry(ext_context_t ec, objaddr_t lo,
 ExtMapInnerNode::internal_iterator_t
 ExtMapInnerNode::get_containing_child(objaddr_t lo)
 {
-  // TODO: binary search
-  for (auto i = begin(); i != end(); ++i) {
-    if (i.contains(lo))
-      return i;
-  }
-  ceph_assert(0 == "invalid");
-  return end();
+  auto iter = upper_bound(lo);
+  ceph_assert(iter != begin());
+  iter = iter - 1;
+  assert(iter.contains(lo));
+  return iter;
 }
 
 std::ostream &ExtMapLeafNode::print_detail_l(std::ostream &out) const
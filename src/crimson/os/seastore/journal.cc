@@ -2,18 +2,83 @@
 // vim: ts=8 sw=2 smarttab
 
 #include <iostream>
+#include <set>
 
 #include <boost/iterator/counting_iterator.hpp>
+#include <seastar/core/future-util.hh>
 
 #include "crimson/os/seastore/journal.h"
 
 #include "include/intarith.h"
+#include "common/ceph_time.h"
+#include "common/perf_counters.h"
+#include "crimson/common/perf_counters_collection.h"
 #include "crimson/os/seastore/segment_manager.h"
 
 namespace {
   seastar::logger& logger() {
     return crimson::get_logger(ceph_subsys_filestore);
   }
+
+  enum {
+    l_journal_first = 1100,
+    l_journal_records,
+    l_journal_writes,
+    l_journal_io_depth,
+    l_journal_records_per_write,
+    l_journal_records_per_write_histogram,
+    l_journal_commit_lat,
+    l_journal_commit_lat_histogram,
+    l_journal_last
+  };
+
+  PerfCounters *build_journal_logger()
+  {
+    PerfCountersBuilder plb(
+      nullptr, "seastore_journal", l_journal_first, l_journal_last);
+    plb.add_u64_counter(l_journal_records, "records",
+			"Records committed");
+    plb.add_u64_counter(l_journal_writes, "writes",
+			"Device writes of record batches");
+    plb.add_u64(l_journal_io_depth, "io_depth",
+		"Batch writes in flight");
+    plb.add_u64_avg(l_journal_records_per_write, "records_per_write",
+		    "Records per device write");
+    PerfHistogramCommon::axis_config_d records_axis{
+      "Records per write",
+      PerfHistogramCommon::SCALE_LINEAR,
+      1,   ///< a write has at least one record
+      1,
+      64
+    };
+    PerfHistogramCommon::axis_config_d bytes_axis{
+      "Write size (bytes)",
+      PerfHistogramCommon::SCALE_LOG2,
+      0,
+      4096,
+      16
+    };
+    plb.add_u64_counter_histogram(
+      l_journal_records_per_write_histogram,
+      "records_per_write_histogram",
+      records_axis, bytes_axis,
+      "Histogram of records per device write and write size");
+    plb.add_time_avg(l_journal_commit_lat, "commit_lat",
+		     "Time from record submission to its write completing");
+    PerfHistogramCommon::axis_config_d lat_axis{
+      "Latency (usec)",
+      PerfHistogramCommon::SCALE_LOG2,
+      0,
+      10000,  ///< 10usec
+      24
+    };
+    plb.add_u64_counter_histogram(
+      l_journal_commit_lat_histogram,
+      "commit_lat_histogram",
+      lat_axis, records_axis,
+      "Histogram of record commit latency and records in the same write");
+    return plb.create_perf_counters();
+  }
 }
 
 namespace crimson::os::seastore {
@@ -38,13 +103,33 @@ segment_nonce_t generate_nonce(
     sizeof(meta.seastore_id.uuid));
 }
 
-Journal::Journal(SegmentManager &segment_manager)
+Journal::Journal(
+  SegmentManager &segment_manager,
+  batch_config_t batch_config)
   : block_size(segment_manager.get_block_size()),
     max_record_length(
       segment_manager.get_segment_size() -
       p2align(ceph::encoded_sizeof_bounded<segment_header_t>(),
 	      size_t(block_size))),
-    segment_manager(segment_manager) {}
+    segment_manager(segment_manager),
+    batch_config(batch_config),
+    perf_logger(build_journal_logger())
+{
+  using crimson::common::sharded_perf_coll;
+  using crimson::common::local_perf_coll;
+  if (sharded_perf_coll().local_is_initialized()) {
+    local_perf_coll().get_perf_collection()->add(perf_logger.get());
+  }
+}
+
+Journal::~Journal()
+{
+  using crimson::common::sharded_perf_coll;
+  using crimson::common::local_perf_coll;
+  if (sharded_perf_coll().local_is_initialized()) {
+    local_perf_coll().get_perf_collection()->remove(perf_logger.get());
+  }
+}
 
 
 Journal::initialize_segment_ertr::future<segment_seq_t>
@@ -193,21 +278,27 @@ Journal::write_record_ret Journal::write_record(
     target);
 
   auto segment_id = current_journal_segment->get_segment_id();
+  auto submitted = ceph::mono_clock::now();
 
-  // Start write under the current exclusive stage, but wait for it
-  // in the device_submission concurrent stage to permit multiple
-  // overlapping writes.
-  auto write_fut = current_journal_segment->write(target, to_write);
+  // Batch the record under the current exclusive stage, but wait for
+  // the batch to be written in the device_submission concurrent stage
+  // to permit multiple overlapping writes.
+  auto batch = add_to_batch(target, std::move(to_write));
   return handle.enter(write_pipeline->device_submission
-  ).then([write_fut = std::move(write_fut)]() mutable {
-    return std::move(write_fut
-    ).handle_error(
-      write_record_ertr::pass_further{},
-      crimson::ct_error::assert_all{
-	"Invalid error in Journal::write_record"
-      }
-    );
-  }).safe_then([this, &handle] {
+  ).then([batch] {
+    return batch->written.get_shared_future();
+  }).then([batch]() -> write_record_ertr::future<> {
+    if (batch->io_error) {
+      return crimson::ct_error::input_output_error::make();
+    }
+    return write_record_ertr::now();
+  }).safe_then([this, &handle, batch, submitted] {
+    auto lat = ceph::mono_clock::now() - submitted;
+    perf_logger->tinc(l_journal_commit_lat, lat);
+    perf_logger->hinc(
+      l_journal_commit_lat_histogram,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(lat).count(),
+      batch->num_records);
     return handle.enter(write_pipeline->finalize);
   }).safe_then([this, target, segment_id] {
     logger().debug(
@@ -225,6 +316,104 @@ Journal::write_record_ret Journal::write_record(
   });
 }
 
+Journal::record_batch_ref Journal::add_to_batch(
+  segment_off_t target,
+  ceph::bufferlist &&encoded)
+{
+  if (!pending_batch) {
+    pending_batch = seastar::make_lw_shared<record_batch_t>();
+    pending_batch->start = target;
+  }
+  assert(pending_batch->start +
+	 (segment_off_t)pending_batch->encoded.length() == target);
+  pending_batch->encoded.claim_append(encoded);
+  ++pending_batch->num_records;
+  perf_logger->inc(l_journal_records);
+
+  auto ret = pending_batch;
+  if (io_depth < std::max<size_t>(batch_config.io_depth_limit, 1) ||
+      ret->num_records >= batch_config.max_records ||
+      ret->encoded.length() >= batch_config.max_bytes) {
+    submit_pending_batch();
+  } else {
+    logger().debug(
+      "add_to_batch: {} writes in flight, batching record at {}, "
+      "{} records pending",
+      io_depth,
+      target,
+      ret->num_records);
+  }
+  return ret;
+}
+
+void Journal::submit_pending_batch()
+{
+  if (!pending_batch) {
+    return;
+  }
+  auto batch = std::move(pending_batch);
+  pending_batch = nullptr;
+  ++io_depth;
+  perf_logger->inc(l_journal_writes);
+  perf_logger->set(l_journal_io_depth, io_depth);
+  perf_logger->inc(l_journal_records_per_write, batch->num_records);
+  perf_logger->hinc(
+    l_journal_records_per_write_histogram,
+    batch->num_records,
+    batch->encoded.length());
+  logger().debug(
+    "submit_pending_batch: {} records, {} bytes at {}",
+    batch->num_records,
+    batch->encoded.length(),
+    batch->start);
+
+  // completion is reported through batch->written
+  (void)current_journal_segment->write(
+    batch->start, batch->encoded
+  ).handle_error(
+    crimson::ct_error::input_output_error::handle([batch](auto) {
+      batch->io_error = true;
+    }),
+    crimson::ct_error::assert_all{
+      "Invalid error in Journal::submit_pending_batch"
+    }
+  ).safe_then([this, batch] {
+    --io_depth;
+    perf_logger->set(l_journal_io_depth, io_depth);
+    batch->written.set_value();
+    if (io_depth < std::max<size_t>(batch_config.io_depth_limit, 1)) {
+      submit_pending_batch();
+    }
+    if (io_depth == 0 && io_drained) {
+      io_drained->set_value();
+      io_drained.reset();
+    }
+  });
+}
+
+Journal::close_ertr::future<> Journal::close()
+{
+  submit_pending_batch();
+  if (io_depth == 0) {
+    return close_ertr::now();
+  }
+  logger().debug("close: waiting for {} batch writes in flight", io_depth);
+  if (!io_drained) {
+    io_drained.emplace();
+  }
+  return io_drained->get_shared_future();
+}
+
+uint64_t Journal::get_num_records() const
+{
+  return perf_logger->get(l_journal_records);
+}
+
+uint64_t Journal::get_num_writes() const
+{
+  return perf_logger->get(l_journal_writes);
+}
+
 Journal::record_size_t Journal::get_encoded_record_length(
   const record_t &record) const {
   extent_len_t metadata =
@@ -252,6 +441,8 @@ bool Journal::needs_roll(segment_off_t length) const
 Journal::roll_journal_segment_ertr::future<segment_seq_t>
 Journal::roll_journal_segment()
 {
+  // records batched so far belong to the current segment
+  submit_pending_batch();
   auto old_segment_id = current_journal_segment ?
     current_journal_segment->get_segment_id() :
     NULL_SEG_ID;
@@ -551,58 +742,94 @@ std::optional<std::vector<extent_info_t>> Journal::try_decode_extent_infos(
   return extent_infos;
 }
 
+namespace {
+
+/**
+ * Calls f concurrently on each element of [begin, end).  The replay
+ * errors are collapsed into input_output_error, which is all replay can
+ * do with them anyway.
+ */
+template <typename Iterator, typename F>
+Journal::replay_ret replay_parallel_for_each(
+  Iterator begin,
+  Iterator end,
+  F &&f)
+{
+  return seastar::do_with(
+    false,
+    std::forward<F>(f),
+    [begin, end](auto &failed, auto &f) {
+      return Journal::replay_ertr::now().safe_then([=, &failed, &f] {
+	return seastar::parallel_for_each(
+	  begin,
+	  end,
+	  [&failed, &f](auto &i) -> seastar::future<> {
+	    return f(i).handle_error(
+	      crimson::ct_error::all_same_way([&failed] {
+		failed = true;
+	      }));
+	  });
+      }).safe_then([&failed]() -> Journal::replay_ret {
+	if (failed) {
+	  return crimson::ct_error::input_output_error::make();
+	}
+	return Journal::replay_ertr::now();
+      });
+    });
+}
+
+}
+
 Journal::replay_ertr::future<>
-Journal::replay_segment(
+Journal::scan_segment_deltas(
   journal_seq_t seq,
   segment_header_t header,
-  delta_handler_t &handler)
+  replay_deltas_t &out)
 {
-  logger().debug("replay_segment: starting at {}", seq);
+  logger().debug("scan_segment_deltas: starting at {}", seq);
   return seastar::do_with(
     scan_valid_records_cursor(seq.offset),
     found_record_handler_t(
-      [=, &handler](paddr_t base,
-		    const record_header_t &header,
-		    const bufferlist &mdbuf) {
+      [=, &out](paddr_t base,
+		const record_header_t &header,
+		const bufferlist &mdbuf) {
 	auto deltas = try_decode_deltas(
 	  header,
 	  mdbuf);
 	if (!deltas) {
 	  // This should be impossible, we did check the crc on the mdbuf
 	  logger().error(
-	    "Journal::replay_segment unable to decode deltas for record {}",
+	    "Journal::scan_segment_deltas unable to decode deltas for record {}",
 	    base);
 	  assert(deltas);
 	}
 
-	return seastar::do_with(
-	  std::move(*deltas),
-	  [=](auto &deltas) {
-	    return crimson::do_for_each(
-	      deltas,
-	      [=](auto &delta) {
-		/* The journal may validly contain deltas for extents in
-		 * since released segments.  We can detect those cases by
-		 * checking whether the segment in question currently has a
-		 * sequence number > the current journal segment seq. We can
-		 * safetly skip these deltas because the extent must already
-		 * have been rewritten.
-		 *
-		 * Note, this comparison exploits the fact that
-		 * SEGMENT_SEQ_NULL is a large number.
-		 */
-		if (delta.paddr != P_ADDR_NULL &&
-		    (segment_provider->get_seq(delta.paddr.segment) >
-		     seq.segment_seq)) {
-		  return replay_ertr::now();
-		} else {
-		  return handler(
-		    journal_seq_t{seq.segment_seq, base},
-		    base.add_offset(header.mdlength),
-		    delta);
-		}
-	      });
-	  });
+	for (auto &delta : *deltas) {
+	  /* The journal may validly contain deltas for extents in
+	   * since released segments.  We can detect those cases by
+	   * checking whether the segment in question currently has a
+	   * sequence number > the current journal segment seq. We can
+	   * safetly skip these deltas because the extent must already
+	   * have been rewritten.
+	   *
+	   * Note, this comparison exploits the fact that
+	   * SEGMENT_SEQ_NULL is a large number.  Extents placed in a
+	   * RandomBlockManager are never moved, see
+	   * Cache::replay_rbm_delta.
+	   */
+	  if (delta.paddr != P_ADDR_NULL &&
+	      !delta.paddr.is_rbm() &&
+	      (segment_provider->get_seq(delta.paddr.segment) >
+	       seq.segment_seq)) {
+	    continue;
+	  }
+	  out.push_back(
+	    replay_delta_t{
+	      journal_seq_t{seq.segment_seq, base},
+	      base.add_offset(header.mdlength),
+	      std::move(delta)});
+	}
+	return scan_valid_records_ertr::now();
       }),
     [=](auto &cursor, auto &dhandler) {
       return scan_valid_records(
@@ -613,18 +840,99 @@ Journal::replay_segment(
     });
 }
 
-Journal::replay_ret Journal::replay(delta_handler_t &&delta_handler)
+Journal::replay_ertr::future<>
+Journal::replay_segment(
+  const replay_deltas_t &deltas,
+  delta_handler_t &handler,
+  prefetch_handler_t &prefetch)
+{
+  /* Deltas have to be applied in journal order: an extent's dirty_from
+   * is set by the first delta applied to it and the dirty list must stay
+   * sorted by it.  What can be done ahead is reading in the extents the
+   * deltas apply to.  Only the first delta seen for each address is
+   * considered, and only if it is a version 0 delta, which is exactly
+   * the case where applying it in order would read the extent from disk.
+   */
+  std::vector<const delta_info_t*> to_prefetch;
+  if (prefetch) {
+    std::set<paddr_t> seen;
+    for (auto &i : deltas) {
+      if (i.delta.type == extent_types_t::ROOT ||
+	  i.delta.paddr == P_ADDR_NULL) {
+	continue;
+      }
+      if (seen.insert(i.delta.paddr).second && i.delta.pversion == 0) {
+	to_prefetch.push_back(&i.delta);
+      }
+    }
+  }
+  logger().debug(
+    "replay_segment: {} deltas, prefetching {} extents",
+    deltas.size(),
+    to_prefetch.size());
+  return seastar::do_with(
+    std::move(to_prefetch),
+    [&deltas, &handler, &prefetch](auto &to_prefetch) {
+      return replay_parallel_for_each(
+	to_prefetch.begin(),
+	to_prefetch.end(),
+	[&prefetch](auto delta) {
+	  return prefetch(*delta);
+	}).safe_then([&deltas, &handler] {
+	  return crimson::do_for_each(
+	    deltas,
+	    [&handler](auto &i) {
+	      return handler(i.seq, i.record_block_base, i.delta);
+	    });
+	});
+    });
+}
+
+Journal::replay_ret Journal::replay(
+  delta_handler_t &&delta_handler,
+  prefetch_handler_t &&prefetch_handler)
 {
   return seastar::do_with(
-    std::move(delta_handler), replay_segments_t(),
-    [this](auto &handler, auto &segments) mutable -> replay_ret {
+    std::move(delta_handler),
+    std::move(prefetch_handler),
+    replay_segments_t(),
+    std::vector<replay_deltas_t>(),
+    ceph::mono_clock::now(),
+    [this](auto &handler, auto &prefetch, auto &segments,
+	   auto &deltas, auto &start) mutable -> replay_ret {
       return find_replay_segments().safe_then(
-        [this, &handler, &segments](auto replay_segs) mutable {
+        [this, &segments, &deltas](auto replay_segs) mutable {
           logger().debug("replay: found {} segments", replay_segs.size());
           segments = std::move(replay_segs);
-          return crimson::do_for_each(segments, [this, &handler](auto i) mutable {
-            return replay_segment(i.first, i.second, handler);
-          });
+          deltas.resize(segments.size());
+          // scanning only reads, the segments can be read concurrently
+          return replay_parallel_for_each(
+            boost::make_counting_iterator(size_t(0)),
+            boost::make_counting_iterator(segments.size()),
+            [this, &segments, &deltas](size_t i) {
+              return scan_segment_deltas(
+                segments[i].first,
+                segments[i].second,
+                deltas[i]);
+            });
+        }).safe_then([this, &handler, &prefetch, &deltas] {
+          return crimson::do_for_each(
+            deltas,
+            [this, &handler, &prefetch](auto &segment_deltas) {
+              return replay_segment(segment_deltas, handler, prefetch);
+            });
+        }).safe_then([&segments, &deltas, &start] {
+          size_t num_deltas = 0;
+          for (auto &i : deltas) {
+            num_deltas += i.size();
+          }
+          logger().info(
+            "replay: replayed {} segments, {} deltas in {}s",
+            segments.size(),
+            num_deltas,
+            std::chrono::duration<double>(
+              ceph::mono_clock::now() - start).count());
+          deltas.clear();
         });
     });
 }
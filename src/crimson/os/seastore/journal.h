@@ -5,13 +5,18 @@
 
 #include "crimson/common/log.h"
 
+#include <optional>
+
 #include <boost/intrusive_ptr.hpp>
 
 #include <seastar/core/future.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/shared_ptr.hh>
 
 #include "include/ceph_assert.h"
 #include "include/buffer.h"
 #include "include/denc.h"
+#include "include/common_fwd.h"
 
 #include "crimson/os/seastore/segment_manager.h"
 #include "crimson/os/seastore/ordering_handle.h"
@@ -121,10 +126,30 @@ public:
 
 /**
  * Manages stream of atomically written records to a SegmentManager.
+ *
+ * Records are group committed: while batch_config_t::io_depth_limit
+ * writes are in flight, newly submitted records are appended to a
+ * pending batch which is written with a single device write once an
+ * in-flight write completes or the batch is full.  An idle journal thus
+ * writes each record immediately, and the batches grow with the load.
+ * Records keep the offsets they were assigned at submission, so batches
+ * are written, and records complete, in submission order.
  */
 class Journal {
 public:
-  Journal(SegmentManager &segment_manager);
+  struct batch_config_t {
+    /// batch writes in flight before new records wait to be batched
+    size_t io_depth_limit = 2;
+    /// records in a batch at which it is written regardless of io depth
+    size_t max_records = 64;
+    /// bytes in a batch at which it is written regardless of io depth
+    extent_len_t max_bytes = 1 << 20;
+  };
+
+  Journal(
+    SegmentManager &segment_manager,
+    batch_config_t batch_config = batch_config_t{});
+  ~Journal();
 
   /**
    * Sets the JournalSegmentProvider.
@@ -153,11 +178,19 @@ public:
   /**
    * close journal
    *
-   * TODO: should probably flush and disallow further writes
+   * Writes out the pending batch and waits for every batch write in
+   * flight to complete.
+   *
+   * TODO: should probably disallow further writes
    */
   using close_ertr = crimson::errorator<
     crimson::ct_error::input_output_error>;
-  close_ertr::future<> close() { return close_ertr::now(); }
+  close_ertr::future<> close();
+
+  /// records committed since the journal was constructed
+  uint64_t get_num_records() const;
+  /// device writes of record batches since the journal was constructed
+  uint64_t get_num_writes() const;
 
   /**
    * submit_record
@@ -203,6 +236,13 @@ public:
    *
    * record_block_start (argument to delta_handler) is the start of the
    * of the first block in the record
+   *
+   * The segments to replay are scanned concurrently.  Deltas are then
+   * passed to delta_handler in journal order, one segment at a time.
+   * If prefetch_handler is given, it is first called concurrently with
+   * the first delta of each extent address in the segment that has to
+   * be read from disk.  This lets the in order pass find those extents
+   * already read in.
    */
   using replay_ertr = SegmentManager::read_ertr;
   using replay_ret = replay_ertr::future<>;
@@ -210,7 +250,11 @@ public:
     replay_ret(journal_seq_t seq,
 	       paddr_t record_block_base,
 	       const delta_info_t&)>;
-  replay_ret replay(delta_handler_t &&delta_handler);
+  using prefetch_handler_t = std::function<
+    replay_ret(const delta_info_t&)>;
+  replay_ret replay(
+    delta_handler_t &&delta_handler,
+    prefetch_handler_t &&prefetch_handler = {});
 
   /**
    * scan_extents
@@ -251,6 +295,35 @@ private:
 
   WritePipeline *write_pipeline = nullptr;
 
+  const batch_config_t batch_config;
+
+  /// records encoded into the current segment but not yet written
+  struct record_batch_t {
+    segment_off_t start = 0;
+    ceph::bufferlist encoded;
+    size_t num_records = 0;
+    bool io_error = false;
+    seastar::shared_promise<> written;
+  };
+  using record_batch_ref = seastar::lw_shared_ptr<record_batch_t>;
+  record_batch_ref pending_batch;
+
+  /// number of batch writes in flight
+  size_t io_depth = 0;
+  /// set by close() while waiting for io_depth to drop to 0
+  std::optional<seastar::shared_promise<>> io_drained;
+
+  /// records per write and commit latency counters, see journal.cc
+  std::unique_ptr<PerfCounters> perf_logger;
+
+  /// append encoded record at target to the pending batch
+  record_batch_ref add_to_batch(
+    segment_off_t target,
+    ceph::bufferlist &&encoded);
+
+  /// start writing the pending batch, if any
+  void submit_pending_batch();
+
   /// prepare segment for writes, writes out segment header
   using initialize_segment_ertr = crimson::errorator<
     crimson::ct_error::input_output_error>;
@@ -399,12 +472,28 @@ private:
     found_record_handler_t &handler    ///< [in] handler for records
   ); ///< @return used budget
 
-  /// replays records starting at start through end of segment
+  struct replay_delta_t {
+    journal_seq_t seq;
+    paddr_t record_block_base;
+    delta_info_t delta;
+  };
+  using replay_deltas_t = std::vector<replay_delta_t>;
+
+  /// collects the live deltas of records starting at start through end
+  /// of segment
   replay_ertr::future<>
-  replay_segment(
+  scan_segment_deltas(
     journal_seq_t start,             ///< [in] starting addr, seq
     segment_header_t header,         ///< [in] segment header
-    delta_handler_t &delta_handler   ///< [in] processes deltas in order
+    replay_deltas_t &deltas          ///< [out] deltas in journal order
+  );
+
+  /// replays deltas collected from one segment
+  replay_ertr::future<>
+  replay_segment(
+    const replay_deltas_t &deltas,          ///< [in] deltas to replay
+    delta_handler_t &delta_handler,         ///< [in] processes deltas in order
+    prefetch_handler_t &prefetch_handler    ///< [in] reads extents ahead
   );
 
 };
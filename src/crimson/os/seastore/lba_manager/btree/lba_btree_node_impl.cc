@@ -437,13 +437,11 @@ LBAInternalNode::merge_entry(
 LBAInternalNode::internal_iterator_t
 LBAInternalNode::get_containing_child(laddr_t laddr)
 {
-  // TODO: binary search
-  for (auto i = begin(); i != end(); ++i) {
-    if (i.contains(laddr))
-      return i;
-  }
-  ceph_assert(0 == "invalid");
-  return end();
+  auto iter = upper_bound(laddr);
+  ceph_assert(iter != begin());
+  iter = iter - 1;
+  assert(iter.contains(laddr));
+  return iter;
 }
 
 std::ostream &LBALeafNode::print_detail(std::ostream &out) const
@@ -63,6 +63,13 @@ tree_cursor_t::~tree_cursor_t()
   }
 }
 
+tree_cursor_t::future<Ref<tree_cursor_t>>
+tree_cursor_t::get_next(context_t c)
+{
+  assert(!is_end());
+  return ref_leaf_node->get_next_cursor(c, position);
+}
+
 tree_cursor_t::future<>
 tree_cursor_t::extend_value(context_t c, value_size_t extend_size)
 {
@@ -317,6 +324,17 @@ node_future<> Node::insert_parent(context_t c, Ref<Node> right_node)
       c, parent_info().position, this, right_node);
 }
 
+node_future<Ref<tree_cursor_t>> Node::get_next_cursor_from_parent(context_t c)
+{
+  assert(!is_root());
+  // keep this node and its parent alive until the next cursor is resolved
+  Ref<Node> this_ref = this;
+  return parent_info().ptr->get_next_cursor(c, parent_info().position
+  ).safe_then([this_ref](auto cursor) {
+    return cursor;
+  });
+}
+
 node_future<Ref<Node>> Node::load(
     context_t c, laddr_t addr, bool expect_is_level_tail)
 {
@@ -413,6 +431,24 @@ node_future<> InternalNode::apply_child_split(
   });
 }
 
+node_future<Ref<tree_cursor_t>>
+InternalNode::get_next_cursor(context_t c, const search_position_t& child_pos)
+{
+  // the tail child of a tail node is the tail of its level, so the caller
+  // must have stopped there already
+  assert(!child_pos.is_end());
+  auto next_pos = child_pos;
+  impl->next_position(next_pos);
+  if (next_pos.is_end() && !impl->is_level_tail()) {
+    return get_next_cursor_from_parent(c);
+  }
+  laddr_t child_addr = impl->get_p_value(next_pos)->value;
+  return get_or_track_child(c, next_pos, child_addr
+  ).safe_then([c](auto child) {
+    return child->lookup_smallest(c);
+  });
+}
+
 node_future<Ref<InternalNode>> InternalNode::allocate_root(
     context_t c, level_t old_root_level,
     laddr_t old_root_addr, Super::URef&& super)
@@ -672,6 +708,24 @@ LeafNode::get_kv(const search_position_t& pos) const
   return {key_view, p_value_header};
 }
 
+node_future<Ref<tree_cursor_t>>
+LeafNode::get_next_cursor(context_t c, const search_position_t& pos)
+{
+  assert(!pos.is_end());
+  auto next_pos = pos;
+  impl->next_position(next_pos);
+  if (!next_pos.is_end()) {
+    auto [key_view, p_value_header] = get_kv(next_pos);
+    return node_ertr::make_ready_future<Ref<tree_cursor_t>>(
+        get_or_track_cursor(next_pos, key_view, p_value_header));
+  } else if (impl->is_level_tail()) {
+    return node_ertr::make_ready_future<Ref<tree_cursor_t>>(
+        new tree_cursor_t(this));
+  } else {
+    return get_next_cursor_from_parent(c);
+  }
+}
+
 node_future<> LeafNode::extend_value(
     context_t c, const search_position_t& pos, value_size_t extend_size)
 {
@@ -94,6 +94,15 @@ class tree_cursor_t final
     return cache.get_key_view();
   }
 
+  /**
+   * get_next
+   *
+   * Returns a cursor pointing to the next key in tree, or an end cursor if
+   * this is the largest one. The next leaf node is reached through the
+   * tracked parents rather than by another lookup from the root.
+   */
+  future<Ref<tree_cursor_t>> get_next(context_t);
+
   // public to Value
 
   /// Get the latest value_header_t pointer for read.
@@ -330,6 +339,8 @@ class Node
   };
   const parent_info_t& parent_info() const { return *_parent_info; }
   node_future<> insert_parent(context_t, Ref<Node> right_node);
+  /// Returns the smallest cursor of the right sibling sub-tree.
+  node_future<Ref<tree_cursor_t>> get_next_cursor_from_parent(context_t);
 
  private:
   /**
@@ -375,6 +386,8 @@ class InternalNode final : public Node {
 
   node_future<> apply_child_split(
       context_t, const search_position_t&, Ref<Node> left, Ref<Node> right);
+  node_future<Ref<tree_cursor_t>> get_next_cursor(
+      context_t, const search_position_t& child_pos);
   template <bool VALIDATE>
   void do_track_child(Node& child) {
     if constexpr (VALIDATE) {
@@ -479,6 +492,9 @@ class LeafNode final : public Node {
     assert(removed);
   }
 
+  node_future<Ref<tree_cursor_t>> get_next_cursor(
+      context_t, const search_position_t&);
+
   node_future<> extend_value(context_t, const search_position_t&, value_size_t);
   node_future<> trim_value(context_t, const search_position_t&, value_size_t);
 
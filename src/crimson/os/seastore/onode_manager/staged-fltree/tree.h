@@ -4,6 +4,8 @@
 #pragma once
 
 #include <ostream>
+#include <tuple>
+#include <vector>
 
 #include "common/hobject.h"
 #include "crimson/common/type_helpers.h"
@@ -96,14 +98,18 @@ class Btree {
       return !(*this == x);
     }
 
-    Cursor& operator++() {
-      // TODO
-      return *this;
-    }
-    Cursor operator++(int) {
-      Cursor tmp = *this;
-      ++*this;
-      return tmp;
+    /// Returns the cursor to the next object in order, may be end.
+    btree_future<Cursor> get_next(Transaction& t) {
+      assert(!is_end());
+      auto this_obj = *this;
+      return p_cursor->get_next(p_tree->get_context(t)
+      ).safe_then([this_obj] (Ref<tree_cursor_t> next_cursor) {
+        assert(next_cursor->is_end() ||
+               next_cursor->get_key_view(
+                 this_obj.p_tree->value_builder.get_header_magic()
+               ).to_ghobj() > this_obj.get_ghobj());
+        return Cursor{this_obj.p_tree, next_cursor};
+      });
     }
 
    private:
@@ -195,6 +201,51 @@ class Btree {
     );
   }
 
+  /**
+   * list
+   *
+   * Returns up to limit objects in [start, end) in order, walking the leaf
+   * nodes with a cursor instead of looking up each object from the root,
+   * together with the object to continue listing from, which is
+   * ghobject_t::get_max() if there are no more.
+   */
+  btree_future<std::tuple<std::vector<ghobject_t>, ghobject_t>>
+  list(Transaction& t, const ghobject_t& start,
+       const ghobject_t& end, uint64_t limit) {
+    using ret_t = std::tuple<std::vector<ghobject_t>, ghobject_t>;
+    return lower_bound(t, start
+    ).safe_then([&t, end, limit](auto cursor) {
+      return seastar::do_with(
+        std::move(cursor),
+        ret_t{{}, ghobject_t::get_max()},
+        [&t, end, limit](auto& cursor, auto& ret) {
+          return crimson::do_until(
+              [&t, end, limit, &cursor, &ret]() -> btree_future<bool> {
+            auto& [objs, next] = ret;
+            if (cursor.is_end()) {
+              return btree_ertr::make_ready_future<bool>(true);
+            }
+            auto obj = cursor.get_ghobj();
+            if (obj >= end) {
+              return btree_ertr::make_ready_future<bool>(true);
+            }
+            if (objs.size() >= limit) {
+              next = std::move(obj);
+              return btree_ertr::make_ready_future<bool>(true);
+            }
+            objs.push_back(std::move(obj));
+            return cursor.get_next(t
+            ).safe_then([&cursor](auto next_cursor) {
+              cursor = std::move(next_cursor);
+              return btree_ertr::make_ready_future<bool>(false);
+            });
+          }).safe_then([&ret] {
+            return std::move(ret);
+          });
+        });
+    });
+  }
+
   /*
    * modifiers
    */
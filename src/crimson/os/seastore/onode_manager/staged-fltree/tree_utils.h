@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <random>
@@ -347,6 +348,70 @@ class TreeBuilder {
     });
   }
 
+  future<> scan(Transaction& t) {
+    logger().info("Verifing scan ...");
+    auto expected = seastar::make_lw_shared<std::vector<ghobject_t>>();
+    for (auto iter = kvs.begin(); !iter.is_end(); ++iter) {
+      expected->push_back(iter.get_kv().first);
+    }
+    std::sort(expected->begin(), expected->end());
+    auto start_time = mono_clock::now();
+    return tree->begin(t
+    ).safe_then([&t, this, expected, start_time](auto cursor) {
+      return seastar::do_with(
+          std::move(cursor), expected->cbegin(),
+          [&t, this, expected, start_time](auto& cursor, auto& e_iter) {
+        return crimson::do_until(
+            [&t, &cursor, &e_iter, expected]() -> future<bool> {
+          if (cursor.is_end()) {
+            ceph_assert(e_iter == expected->cend());
+            return ertr::make_ready_future<bool>(true);
+          }
+          ceph_assert(e_iter != expected->cend());
+          ceph_assert(cursor.get_ghobj() == *e_iter);
+          ++e_iter;
+          return cursor.get_next(t).safe_then([&cursor](auto next) {
+            cursor = next;
+            return ertr::make_ready_future<bool>(false);
+          });
+        }).safe_then([expected, start_time] {
+          std::chrono::duration<double> duration = mono_clock::now() - start_time;
+          logger().warn("Scan {} kvs done! {}s, {} kvs/s",
+                        expected->size(), duration.count(),
+                        expected->size() / duration.count());
+        });
+      });
+    }).safe_then([&t, this, expected]() -> future<> {
+      if (expected->empty()) {
+        return ertr::now();
+      }
+      // list the same range again in batches from the middle
+      auto start = (*expected)[expected->size() / 2];
+      return seastar::do_with(
+          std::move(start), size_t(expected->size() / 2),
+          [&t, this, expected](auto& start, auto& index) {
+        return crimson::do_until(
+            [&t, this, &start, &index, expected]() -> future<bool> {
+          return tree->list(t, start, ghobject_t::get_max(), 100
+          ).safe_then([&start, &index, expected](auto ret) {
+            auto& [objs, next] = ret;
+            for (auto& obj : objs) {
+              ceph_assert(obj == (*expected)[index++]);
+            }
+            if (next == ghobject_t::get_max()) {
+              ceph_assert(index == expected->size());
+              return true;
+            }
+            ceph_assert(objs.size() == 100);
+            ceph_assert(next == (*expected)[index]);
+            start = next;
+            return false;
+          });
+        });
+      });
+    });
+  }
+
  private:
   static seastar::logger& logger() {
     return crimson::get_logger(ceph_subsys_filestore);
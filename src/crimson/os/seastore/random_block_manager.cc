@@ -0,0 +1,284 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "crimson/common/log.h"
+
+#include "include/buffer.h"
+#include "crimson/os/seastore/random_block_manager.h"
+
+namespace {
+  seastar::logger& logger() {
+    return crimson::get_logger(ceph_subsys_filestore);
+  }
+}
+
+namespace crimson::os::seastore {
+
+std::ostream &operator<<(std::ostream &out, const rbm_superblock_t &sb)
+{
+  return out << "rbm_superblock_t(size=" << sb.size
+	     << ", block_size=" << sb.block_size
+	     << ", bitmap_offset=" << sb.bitmap_offset
+	     << ", bitmap_size=" << sb.bitmap_size
+	     << ", data_offset=" << sb.data_offset
+	     << ", data_blocks=" << sb.data_blocks
+	     << ")";
+}
+
+static
+rbm_superblock_t make_superblock(
+  size_t size,
+  size_t block_size,
+  const seastore_meta_t &meta)
+{
+  // Each bitmap block covers block_size * 8 data blocks, so size the
+  // bitmap for the blocks left after the superblock and then trim the
+  // data area to whatever remains after the bitmap.
+  uint64_t blocks = size / block_size - 1;
+  uint64_t bits_per_block = block_size * 8;
+  uint64_t bitmap_blocks = (blocks + bits_per_block) / (bits_per_block + 1);
+  ceph_assert(bitmap_blocks < blocks);
+  return rbm_superblock_t{
+    size,
+    block_size,
+    block_size,
+    bitmap_blocks * block_size,
+    (1 + bitmap_blocks) * block_size,
+    std::min(blocks - bitmap_blocks, bitmap_blocks * bits_per_block),
+    meta
+  };
+}
+
+RandomBlockManager::mkfs_ertr::future<> RandomBlockManager::mkfs(
+  const seastore_meta_t &meta)
+{
+  superblock = make_superblock(
+    device.get_size(),
+    device.get_block_size(),
+    meta);
+  logger().debug("RandomBlockManager::mkfs: {}", superblock);
+  assert(ceph::encoded_sizeof_bounded<rbm_superblock_t>() <
+	 superblock.block_size);
+
+  bitmap = ceph::bufferptr(
+    ceph::buffer::create_page_aligned(superblock.bitmap_size));
+  bitmap.zero();
+  dirty_bitmap_blocks.clear();
+  free_blocks = superblock.data_blocks;
+  alloc_hint = 0;
+
+  return seastar::do_with(
+    ceph::bufferptr(ceph::buffer::create_page_aligned(superblock.block_size)),
+    [this](auto &bp) {
+      bufferlist bl;
+      encode(superblock, bl);
+      bp.zero();
+      bl.begin().copy(bl.length(), bp.c_str());
+      return device.write(0, bp);
+    }).safe_then([this] {
+      return device.write(superblock.bitmap_offset, bitmap);
+    }).safe_then([] {
+      logger().debug("RandomBlockManager::mkfs: complete");
+      return mkfs_ertr::now();
+    });
+}
+
+RandomBlockManager::open_ertr::future<> RandomBlockManager::open()
+{
+  return seastar::do_with(
+    ceph::bufferptr(ceph::buffer::create_page_aligned(
+      device.get_block_size())),
+    [this](auto &bp) {
+      return device.read(0, bp).safe_then([this, &bp]() -> open_ertr::future<> {
+	bufferlist bl;
+	bl.push_back(bp);
+	auto bliter = bl.cbegin();
+	try {
+	  decode(superblock, bliter);
+	} catch (ceph::buffer::error &e) {
+	  logger().error("RandomBlockManager::open: bad superblock {}", e.what());
+	  return crimson::ct_error::enodata::make();
+	}
+	if (superblock.block_size != device.get_block_size() ||
+	    superblock.size > device.get_size()) {
+	  logger().error(
+	    "RandomBlockManager::open: {} does not match device",
+	    superblock);
+	  return crimson::ct_error::enodata::make();
+	}
+	return open_ertr::now();
+      });
+    }).safe_then([this] {
+      bitmap = ceph::bufferptr(
+	ceph::buffer::create_page_aligned(superblock.bitmap_size));
+      return device.read(superblock.bitmap_offset, bitmap);
+    }).safe_then([this] {
+      dirty_bitmap_blocks.clear();
+      alloc_hint = 0;
+      free_blocks = 0;
+      for (rbm_blk_t i = 0; i < superblock.data_blocks; ++i) {
+	if (!test_bit(i)) {
+	  ++free_blocks;
+	}
+      }
+      logger().debug(
+	"RandomBlockManager::open: {}, {} free blocks",
+	superblock,
+	free_blocks);
+      return open_ertr::now();
+    });
+}
+
+void RandomBlockManager::set_bits(
+  rbm_blk_t blk, uint64_t count, bool allocated)
+{
+  assert(blk + count <= superblock.data_blocks);
+  auto bits_per_block = superblock.block_size * 8;
+  auto p = bitmap.c_str();
+  for (auto i = blk; i < blk + count; ++i) {
+    assert(test_bit(i) != allocated);
+    if (allocated) {
+      p[i / 8] |= (1 << (i % 8));
+    } else {
+      p[i / 8] &= ~(1 << (i % 8));
+    }
+  }
+  for (auto b = blk / bits_per_block;
+       b <= (blk + count - 1) / bits_per_block;
+       ++b) {
+    dirty_bitmap_blocks.insert(b);
+  }
+}
+
+rbm_blk_t RandomBlockManager::find_free(
+  rbm_blk_t from, rbm_blk_t to, uint64_t count) const
+{
+  auto p = reinterpret_cast<const unsigned char*>(bitmap.c_str());
+  rbm_blk_t run_start = from;
+  uint64_t run = 0;
+  for (rbm_blk_t i = from; i < to; ) {
+    if (run == 0 && i % 8 == 0 && i + 8 <= to && p[i / 8] == 0xff) {
+      // skip fully allocated bytes
+      i += 8;
+      run_start = i;
+      continue;
+    }
+    if (test_bit(i)) {
+      run = 0;
+      run_start = ++i;
+      continue;
+    }
+    if (++run == count) {
+      return run_start;
+    }
+    ++i;
+  }
+  return NULL_RBM_BLK;
+}
+
+RandomBlockManager::alloc_extent_ertr::future<rbm_blk_t>
+RandomBlockManager::alloc_extent(size_t length)
+{
+  auto count = get_blocks(length);
+  assert(count > 0);
+  if (count > free_blocks) {
+    return crimson::ct_error::enospc::make();
+  }
+  auto blk = find_free(alloc_hint, superblock.data_blocks, count);
+  if (blk == NULL_RBM_BLK) {
+    blk = find_free(
+      0,
+      std::min(alloc_hint + count - 1, superblock.data_blocks),
+      count);
+  }
+  if (blk == NULL_RBM_BLK) {
+    logger().debug(
+      "RandomBlockManager::alloc_extent: no run of {} blocks, {} free",
+      count,
+      free_blocks);
+    return crimson::ct_error::enospc::make();
+  }
+  set_bits(blk, count, true);
+  free_blocks -= count;
+  alloc_hint = blk + count;
+  logger().debug(
+    "RandomBlockManager::alloc_extent: {}~{}, {} free",
+    blk,
+    count,
+    free_blocks);
+  return alloc_extent_ertr::make_ready_future<rbm_blk_t>(blk);
+}
+
+void RandomBlockManager::free_extent(rbm_blk_t blk, size_t length)
+{
+  auto count = get_blocks(length);
+  set_bits(blk, count, false);
+  free_blocks += count;
+  logger().debug(
+    "RandomBlockManager::free_extent: {}~{}, {} free",
+    blk,
+    count,
+    free_blocks);
+}
+
+RandomBlockManager::sync_allocation_ertr::future<>
+RandomBlockManager::sync_allocation()
+{
+  // Each dirty block is copied out as it is written so that allocations
+  // made while the write is in flight go out with the next sync.
+  auto to_write = std::move(dirty_bitmap_blocks);
+  dirty_bitmap_blocks.clear();
+  return seastar::do_with(
+    std::move(to_write),
+    [this](auto &to_write) {
+      return crimson::do_for_each(
+	to_write.begin(),
+	to_write.end(),
+	[this](auto b) {
+	  auto bp = ceph::bufferptr(
+	    ceph::buffer::create_page_aligned(superblock.block_size));
+	  bp.copy_in(
+	    0,
+	    superblock.block_size,
+	    bitmap.c_str() + b * superblock.block_size);
+	  return seastar::do_with(
+	    std::move(bp),
+	    [this, b](auto &bp) {
+	      return device.write(
+		superblock.bitmap_offset + b * superblock.block_size,
+		bp);
+	    });
+	});
+    });
+}
+
+RandomBlockManager::read_ertr::future<> RandomBlockManager::read(
+  rbm_blk_t blk, ceph::bufferptr &out)
+{
+  if (out.length() % superblock.block_size != 0 ||
+      blk + get_blocks(out.length()) > superblock.data_blocks) {
+    logger().error(
+      "RandomBlockManager::read: invalid read {}~{}",
+      blk,
+      out.length());
+    return crimson::ct_error::invarg::make();
+  }
+  return device.read(get_offset(blk), out);
+}
+
+RandomBlockManager::write_ertr::future<> RandomBlockManager::write(
+  rbm_blk_t blk, ceph::bufferptr &bptr)
+{
+  if (bptr.length() % superblock.block_size != 0 ||
+      blk + get_blocks(bptr.length()) > superblock.data_blocks) {
+    logger().error(
+      "RandomBlockManager::write: invalid write {}~{}",
+      blk,
+      bptr.length());
+    return crimson::ct_error::invarg::make();
+  }
+  assert(is_allocated(blk));
+  return device.write(get_offset(blk), bptr);
+}
+
+}
@@ -0,0 +1,214 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <iosfwd>
+#include <set>
+
+#include <seastar/core/future.hh>
+
+#include "include/ceph_assert.h"
+#include "include/buffer.h"
+#include "include/denc.h"
+#include "crimson/common/errorator.h"
+#include "crimson/os/seastore/seastore_types.h"
+
+namespace crimson::os::seastore {
+
+/// block number within the data area of a RandomBlockManager
+using rbm_blk_t = uint64_t;
+constexpr rbm_blk_t NULL_RBM_BLK = std::numeric_limits<rbm_blk_t>::max();
+
+inline paddr_t make_rbm_paddr(rbm_blk_t blk) {
+  assert(blk <= (rbm_blk_t)std::numeric_limits<segment_off_t>::max());
+  return paddr_t{RBM_SEG_ID, (segment_off_t)blk};
+}
+
+inline rbm_blk_t get_rbm_blk(paddr_t addr) {
+  assert(addr.is_rbm());
+  return addr.offset;
+}
+
+/**
+ * RBMDevice
+ *
+ * Block addressable device allowing writes anywhere, in any order.
+ * Offsets and lengths are in bytes and must be block aligned.
+ */
+class RBMDevice {
+public:
+  using read_ertr = crimson::errorator<
+    crimson::ct_error::input_output_error,
+    crimson::ct_error::invarg,
+    crimson::ct_error::erange>;
+  virtual read_ertr::future<> read(
+    uint64_t offset,
+    ceph::bufferptr &out) = 0;
+
+  using write_ertr = crimson::errorator<
+    crimson::ct_error::input_output_error,
+    crimson::ct_error::invarg,
+    crimson::ct_error::erange>;
+  virtual write_ertr::future<> write(
+    uint64_t offset,
+    ceph::bufferptr &bptr) = 0;
+
+  virtual size_t get_size() const = 0;
+  virtual size_t get_block_size() const = 0;
+
+  virtual ~RBMDevice() {}
+};
+using RBMDeviceRef = std::unique_ptr<RBMDevice>;
+
+/**
+ * rbm_superblock_t
+ *
+ * Stored in the first block of the device, followed by the allocation
+ * bitmap and then the data area.
+ */
+struct rbm_superblock_t {
+  uint64_t size = 0;
+  uint64_t block_size = 0;
+
+  uint64_t bitmap_offset = 0;
+  uint64_t bitmap_size = 0;   ///< bytes, block aligned
+  uint64_t data_offset = 0;
+  uint64_t data_blocks = 0;
+
+  seastore_meta_t meta;
+
+  DENC(rbm_superblock_t, v, p) {
+    DENC_START(1, 1, p);
+    denc(v.size, p);
+    denc(v.block_size, p);
+    denc(v.bitmap_offset, p);
+    denc(v.bitmap_size, p);
+    denc(v.data_offset, p);
+    denc(v.data_blocks, p);
+    denc(v.meta, p);
+    DENC_FINISH(p);
+  }
+};
+std::ostream &operator<<(std::ostream &out, const rbm_superblock_t &sb);
+
+/**
+ * RandomBlockManager
+ *
+ * Manages space on an RBMDevice as fixed size blocks tracked by an
+ * allocation bitmap, so that an extent can be overwritten where it is
+ * rather than being rewritten to the head of a log and cleaned later.
+ *
+ * Allocation and release only update the in-memory bitmap and remember
+ * which bitmap blocks changed; sync_allocation() writes those back.
+ * The caller must sync before anything referring to newly allocated
+ * blocks is made durable, and must not reuse freed blocks before the
+ * release is durable.
+ */
+class RandomBlockManager {
+public:
+  RandomBlockManager(RBMDevice &device) : device(device) {}
+
+  /**
+   * mkfs
+   *
+   * Writes out a superblock and an empty allocation bitmap covering the
+   * rest of the device.
+   */
+  using mkfs_ertr = RBMDevice::write_ertr;
+  mkfs_ertr::future<> mkfs(const seastore_meta_t &meta);
+
+  /**
+   * open
+   *
+   * Reads in the superblock and allocation bitmap written by mkfs.
+   */
+  using open_ertr = crimson::errorator<
+    crimson::ct_error::input_output_error,
+    crimson::ct_error::invarg,
+    crimson::ct_error::erange,
+    crimson::ct_error::enodata>;
+  open_ertr::future<> open();
+
+  /**
+   * alloc_extent
+   *
+   * Allocates length bytes (block aligned) of contiguous blocks and
+   * returns the first.
+   */
+  using alloc_extent_ertr = crimson::errorator<
+    crimson::ct_error::enospc>;
+  alloc_extent_ertr::future<rbm_blk_t> alloc_extent(size_t length);
+
+  /// Releases length bytes of blocks starting at blk
+  void free_extent(rbm_blk_t blk, size_t length);
+
+  /// Writes out the bitmap blocks changed since the last sync
+  using sync_allocation_ertr = RBMDevice::write_ertr;
+  sync_allocation_ertr::future<> sync_allocation();
+
+  /// Reads out.length() bytes starting at blk
+  using read_ertr = RBMDevice::read_ertr;
+  read_ertr::future<> read(rbm_blk_t blk, ceph::bufferptr &out);
+
+  /// Writes bptr in place starting at blk, blocks must be allocated
+  using write_ertr = RBMDevice::write_ertr;
+  write_ertr::future<> write(rbm_blk_t blk, ceph::bufferptr &bptr);
+
+  bool is_allocated(rbm_blk_t blk) const {
+    assert(blk < superblock.data_blocks);
+    return test_bit(blk);
+  }
+
+  size_t get_block_size() const {
+    return superblock.block_size;
+  }
+
+  uint64_t get_data_blocks() const {
+    return superblock.data_blocks;
+  }
+
+  uint64_t get_free_blocks() const {
+    return free_blocks;
+  }
+
+  const seastore_meta_t &get_meta() const {
+    return superblock.meta;
+  }
+
+private:
+  RBMDevice &device;
+  rbm_superblock_t superblock;
+
+  /// one bit per data block, set if allocated
+  ceph::bufferptr bitmap;
+  /// indices of bitmap blocks changed since the last sync
+  std::set<uint64_t> dirty_bitmap_blocks;
+  uint64_t free_blocks = 0;
+  /// next fit: allocation resumes searching after the last allocation
+  rbm_blk_t alloc_hint = 0;
+
+  bool test_bit(rbm_blk_t blk) const {
+    return bitmap.c_str()[blk / 8] & (1 << (blk % 8));
+  }
+
+  void set_bits(rbm_blk_t blk, uint64_t count, bool allocated);
+
+  /// returns the first block of a run of count free blocks, searching
+  /// [from, to), or NULL_RBM_BLK
+  rbm_blk_t find_free(rbm_blk_t from, rbm_blk_t to, uint64_t count) const;
+
+  uint64_t get_blocks(size_t length) const {
+    assert(length % superblock.block_size == 0);
+    return length / superblock.block_size;
+  }
+
+  uint64_t get_offset(rbm_blk_t blk) const {
+    return superblock.data_offset + blk * superblock.block_size;
+  }
+};
+using RandomBlockManagerRef = std::unique_ptr<RandomBlockManager>;
+
+}
+
+WRITE_CLASS_DENC_BOUNDED(crimson::os::seastore::rbm_superblock_t)
@@ -0,0 +1,108 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "crimson/common/log.h"
+
+#include "include/buffer.h"
+#include "crimson/os/seastore/random_block_manager/block.h"
+
+namespace {
+  seastar::logger& logger() {
+    return crimson::get_logger(ceph_subsys_filestore);
+  }
+}
+
+namespace crimson::os::seastore::random_block_manager {
+
+BlockRBMDevice::access_ertr::future<> BlockRBMDevice::open(
+  const std::string &in_path,
+  size_t in_size)
+{
+  return seastar::do_with(
+    in_path,
+    [this, in_size](auto &path) {
+      return seastar::file_stat(path, seastar::follow_symlink::yes
+      ).then([this, in_size, &path](auto stat) {
+	size = stat.size ? stat.size : in_size;
+	block_size = stat.block_size;
+	return seastar::open_file_dma(
+	  path,
+	  seastar::open_flags::rw | seastar::open_flags::dsync
+	).then([this](auto file) {
+	  device = std::move(file);
+	  logger().debug(
+	    "BlockRBMDevice::open: size {}, block_size {}",
+	    size,
+	    block_size);
+	});
+      }).handle_exception([](auto e) -> access_ertr::future<> {
+	logger().error(
+	  "BlockRBMDevice::open: got error {}",
+	  e);
+	return crimson::ct_error::input_output_error::make();
+      });
+    });
+}
+
+BlockRBMDevice::close_ertr::future<> BlockRBMDevice::close()
+{
+  return device.close();
+}
+
+RBMDevice::read_ertr::future<> BlockRBMDevice::read(
+  uint64_t offset,
+  ceph::bufferptr &bptr)
+{
+  logger().debug(
+    "BlockRBMDevice::read: offset {} len {}",
+    offset,
+    bptr.length());
+  if (offset + bptr.length() > size) {
+    return crimson::ct_error::erange::make();
+  }
+  return device.dma_read(
+    offset,
+    bptr.c_str(),
+    bptr.length()
+  ).handle_exception([](auto e) -> read_ertr::future<size_t> {
+    logger().error(
+      "BlockRBMDevice::read: dma_read got error {}",
+      e);
+    return crimson::ct_error::input_output_error::make();
+  }).then([length=bptr.length()](auto result) -> read_ertr::future<> {
+    if (result != length) {
+      return crimson::ct_error::input_output_error::make();
+    }
+    return read_ertr::now();
+  });
+}
+
+RBMDevice::write_ertr::future<> BlockRBMDevice::write(
+  uint64_t offset,
+  ceph::bufferptr &bptr)
+{
+  logger().debug(
+    "BlockRBMDevice::write: offset {} len {}",
+    offset,
+    bptr.length());
+  if (offset + bptr.length() > size) {
+    return crimson::ct_error::erange::make();
+  }
+  return device.dma_write(
+    offset,
+    bptr.c_str(),
+    bptr.length()
+  ).handle_exception([](auto e) -> write_ertr::future<size_t> {
+    logger().error(
+      "BlockRBMDevice::write: dma_write got error {}",
+      e);
+    return crimson::ct_error::input_output_error::make();
+  }).then([length=bptr.length()](auto result) -> write_ertr::future<> {
+    if (result != length) {
+      return crimson::ct_error::input_output_error::make();
+    }
+    return write_ertr::now();
+  });
+}
+
+}
@@ -0,0 +1,58 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <seastar/core/file.hh>
+#include <seastar/core/future.hh>
+
+#include "crimson/os/seastore/random_block_manager.h"
+
+namespace crimson::os::seastore::random_block_manager {
+
+/**
+ * BlockRBMDevice
+ *
+ * RBMDevice over a file or block device opened for direct io, intended
+ * for NVMe devices where in place overwrites are cheap.
+ */
+class BlockRBMDevice final : public RBMDevice {
+  seastar::file device;
+  size_t size = 0;
+  size_t block_size = 0;
+
+public:
+  using access_ertr = crimson::errorator<
+    crimson::ct_error::input_output_error,
+    crimson::ct_error::permission_denied,
+    crimson::ct_error::enoent>;
+
+  /**
+   * open
+   *
+   * If the device has no size of its own (a regular file), size is used
+   * instead.
+   */
+  access_ertr::future<> open(const std::string &path, size_t size = 0);
+
+  using close_ertr = crimson::errorator<
+    crimson::ct_error::input_output_error>;
+  close_ertr::future<> close();
+
+  read_ertr::future<> read(
+    uint64_t offset,
+    ceph::bufferptr &out) final;
+
+  write_ertr::future<> write(
+    uint64_t offset,
+    ceph::bufferptr &bptr) final;
+
+  size_t get_size() const final {
+    return size;
+  }
+  size_t get_block_size() const final {
+    return block_size;
+  }
+};
+
+}
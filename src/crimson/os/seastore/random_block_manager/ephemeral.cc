@@ -0,0 +1,96 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <sys/mman.h>
+#include <string.h>
+
+#include "crimson/common/log.h"
+
+#include "include/buffer.h"
+#include "crimson/os/seastore/random_block_manager/ephemeral.h"
+
+namespace {
+  seastar::logger& logger() {
+    return crimson::get_logger(ceph_subsys_filestore);
+  }
+}
+
+namespace crimson::os::seastore::random_block_manager {
+
+std::ostream &operator<<(std::ostream &lhs, const ephemeral_config_t &c) {
+  return lhs << "ephemeral_config_t(size=" << c.size << ", block_size="
+	     << c.block_size << ")";
+}
+
+EphemeralRBMDeviceRef create_test_ephemeral() {
+  return EphemeralRBMDeviceRef(
+    new EphemeralRBMDevice(DEFAULT_TEST_EPHEMERAL));
+}
+
+EphemeralRBMDevice::init_ertr::future<> EphemeralRBMDevice::init()
+{
+  logger().debug(
+    "Initing ephemeral rbm device with config {}",
+    config);
+
+  if (config.block_size % (4<<10) != 0) {
+    return crimson::ct_error::invarg::make();
+  }
+  if (config.size % config.block_size != 0) {
+    return crimson::ct_error::invarg::make();
+  }
+
+  auto addr = ::mmap(
+    nullptr,
+    config.size,
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+    -1,
+    0);
+
+  if (addr == MAP_FAILED)
+    return crimson::ct_error::enospc::make();
+
+  buffer = (char*)addr;
+
+  ::memset(buffer, 0, config.size);
+  return init_ertr::now();
+}
+
+EphemeralRBMDevice::~EphemeralRBMDevice()
+{
+  if (buffer) {
+    ::munmap(buffer, config.size);
+  }
+}
+
+RBMDevice::read_ertr::future<> EphemeralRBMDevice::read(
+  uint64_t offset,
+  ceph::bufferptr &out)
+{
+  if (!check_extent(offset, out.length())) {
+    logger().error(
+      "EphemeralRBMDevice::read: invalid read {}~{}",
+      offset,
+      out.length());
+    return crimson::ct_error::invarg::make();
+  }
+  out.copy_in(0, out.length(), buffer + offset);
+  return read_ertr::now();
+}
+
+RBMDevice::write_ertr::future<> EphemeralRBMDevice::write(
+  uint64_t offset,
+  ceph::bufferptr &bptr)
+{
+  if (!check_extent(offset, bptr.length())) {
+    logger().error(
+      "EphemeralRBMDevice::write: invalid write {}~{}",
+      offset,
+      bptr.length());
+    return crimson::ct_error::invarg::make();
+  }
+  bptr.copy_out(0, bptr.length(), buffer + offset);
+  return write_ertr::now();
+}
+
+}
@@ -0,0 +1,69 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <seastar/core/future.hh>
+
+#include "crimson/os/seastore/random_block_manager.h"
+
+namespace crimson::os::seastore::random_block_manager {
+
+class EphemeralRBMDevice;
+using EphemeralRBMDeviceRef = std::unique_ptr<EphemeralRBMDevice>;
+
+struct ephemeral_config_t {
+  size_t size = 0;
+  size_t block_size = 0;
+};
+
+constexpr ephemeral_config_t DEFAULT_TEST_EPHEMERAL = {
+  64 << 20,
+  4 << 10
+};
+
+std::ostream &operator<<(std::ostream &, const ephemeral_config_t &);
+EphemeralRBMDeviceRef create_test_ephemeral();
+
+/**
+ * EphemeralRBMDevice
+ *
+ * Memory backed RBMDevice for tests.  Contents survive until the device
+ * is destroyed, so a RandomBlockManager may be reopened over it.
+ */
+class EphemeralRBMDevice final : public RBMDevice {
+  const ephemeral_config_t config;
+  char *buffer = nullptr;
+
+  bool check_extent(uint64_t offset, size_t len) const {
+    return offset % config.block_size == 0 &&
+      len % config.block_size == 0 &&
+      offset + len <= config.size;
+  }
+
+public:
+  EphemeralRBMDevice(ephemeral_config_t config) : config(config) {}
+  ~EphemeralRBMDevice();
+
+  using init_ertr = crimson::errorator<
+    crimson::ct_error::enospc,
+    crimson::ct_error::invarg>;
+  init_ertr::future<> init();
+
+  read_ertr::future<> read(
+    uint64_t offset,
+    ceph::bufferptr &out) final;
+
+  write_ertr::future<> write(
+    uint64_t offset,
+    ceph::bufferptr &bptr) final;
+
+  size_t get_size() const final {
+    return config.size;
+  }
+  size_t get_block_size() const final {
+    return config.block_size;
+  }
+};
+
+}
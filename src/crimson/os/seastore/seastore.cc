@@ -42,8 +42,17 @@ SeaStore::SeaStore(const std::string& path)
       std::make_unique<SegmentCleaner>(
 	SegmentCleaner::config_t::default_from_segment_manager(
 	  *segment_manager))),
-    cache(std::make_unique<Cache>(*segment_manager)),
-    journal(new Journal(*segment_manager)),
+    cache(std::make_unique<Cache>(
+      *segment_manager,
+      local_conf().get_val<Option::size_t>("seastore_cache_lru_size"))),
+    journal(new Journal(
+      *segment_manager,
+      Journal::batch_config_t{
+	local_conf().get_val<uint64_t>("seastore_journal_iodepth_limit"),
+	local_conf().get_val<uint64_t>("seastore_journal_batch_capacity"),
+	static_cast<extent_len_t>(
+	  local_conf().get_val<Option::size_t>(
+	    "seastore_journal_batch_flush_size"))})),
     lba_manager(
       lba_manager::create_lba_manager(*segment_manager, *cache)),
     transaction_manager(
@@ -15,6 +15,8 @@ std::ostream &segment_to_stream(std::ostream &out, const segment_id_t &t)
     return out << "RECORD_REL_SEG";
   else if (t == FAKE_SEG_ID)
     return out << "FAKE_SEG";
+  else if (t == RBM_SEG_ID)
+    return out << "RBM_SEG";
   else
     return out << t;
 }
@@ -44,6 +44,11 @@ constexpr segment_id_t BLOCK_REL_SEG_ID =
 constexpr segment_id_t FAKE_SEG_ID =
   std::numeric_limits<segment_id_t>::max() - 4;
 
+/* Used to denote extents placed by a RandomBlockManager rather than
+ * written to a segment, the offset is the first block */
+constexpr segment_id_t RBM_SEG_ID =
+  std::numeric_limits<segment_id_t>::max() - 5;
+
 std::ostream &segment_to_stream(std::ostream &, const segment_id_t &t);
 
 // Offset within a segment on disk, see SegmentManager
@@ -99,6 +104,10 @@ struct paddr_t {
     return segment == BLOCK_REL_SEG_ID;
   }
 
+  bool is_rbm() const {
+    return segment == RBM_SEG_ID;
+  }
+
   paddr_t add_offset(segment_off_t o) const {
     return paddr_t{segment, offset + o};
   }
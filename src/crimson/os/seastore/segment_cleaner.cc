@@ -324,12 +324,17 @@ SegmentCleaner::do_gc_ret SegmentCleaner::do_gc(
 		  addr,
 		  *ext);
 	      }
+	      gc_stats.gc_bytes_rewritten += ext->get_length();
 	      return ecb->rewrite_extent(
 		t,
 		ext);
 	    });
 	  }).safe_then([&t, this] {
 	    if (scan_cursor->is_complete()) {
+	      logger().debug(
+		"SegmentCleaner::do_gc: finished segment {}, write amplification {}",
+		scan_cursor->get_offset().segment,
+		gc_stats.get_write_amplification());
 	      t.mark_segment_to_release(scan_cursor->get_offset().segment);
 	      scan_cursor.reset();
 	    }
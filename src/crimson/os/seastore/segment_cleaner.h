@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <set>
+
 #include <boost/intrusive/set.hpp>
 
 #include "common/ceph_time.h"
@@ -204,6 +206,153 @@ public:
   bool equals(const SpaceTrackerI &other) const;
 };
 
+/**
+ * SegmentGCIndex
+ *
+ * Keeps closed segments ordered for gc victim selection so that picking
+ * the next victim doesn't need to look at every segment.
+ *
+ * GREEDY picks the segment with the fewest live bytes.
+ *
+ * COST_BENEFIT picks the segment maximizing
+ *   (free bytes * age) / (segment size + live bytes)
+ * where age is the number of journal segments written since the segment
+ * was, so that cold segments are cleaned at a higher utilization than hot
+ * ones which are still losing live data. Segments are bucketed by
+ * utilization and each bucket is ordered oldest first; only the oldest
+ * segment of each bucket is a candidate, which makes selection
+ * O(GC_BUCKETS) at the cost of ignoring the utilization differences
+ * within a bucket.
+ *
+ * Segments still in the journal are never victims. They are the
+ * youngest, so they only ever show up at the end of a bucket.
+ */
+class SegmentGCIndex {
+public:
+  enum class policy_t {
+    GREEDY,
+    COST_BENEFIT
+  };
+  static constexpr size_t GC_BUCKETS = 64;
+
+private:
+  struct entry_t {
+    bool indexed = false;
+    segment_seq_t seq = NULL_SEG_SEQ;
+    int64_t live_bytes = 0;
+  };
+
+  const policy_t policy;
+  const size_t segment_size;
+  std::vector<entry_t> entries;
+
+  /// GREEDY: (live bytes, segment)
+  std::set<std::pair<int64_t, segment_id_t>> by_live_bytes;
+  /// COST_BENEFIT: (seq, segment) for each utilization bucket
+  std::vector<std::set<std::pair<segment_seq_t, segment_id_t>>> buckets;
+
+  size_t get_bucket(int64_t live_bytes) const {
+    return std::min(
+      static_cast<size_t>(live_bytes) * GC_BUCKETS / segment_size,
+      GC_BUCKETS - 1);
+  }
+
+  static bool in_journal(segment_seq_t seq, journal_seq_t tail_committed) {
+    return seq != NULL_SEG_SEQ && tail_committed.segment_seq <= seq;
+  }
+
+  void link(segment_id_t segment) {
+    const auto &e = entries[segment];
+    if (policy == policy_t::GREEDY) {
+      by_live_bytes.emplace(e.live_bytes, segment);
+    } else {
+      buckets[get_bucket(e.live_bytes)].emplace(e.seq, segment);
+    }
+  }
+
+  void unlink(segment_id_t segment) {
+    const auto &e = entries[segment];
+    if (policy == policy_t::GREEDY) {
+      by_live_bytes.erase(std::make_pair(e.live_bytes, segment));
+    } else {
+      buckets[get_bucket(e.live_bytes)].erase(std::make_pair(e.seq, segment));
+    }
+  }
+
+public:
+  SegmentGCIndex(policy_t policy, size_t num_segments, size_t segment_size)
+    : policy(policy),
+      segment_size(segment_size),
+      entries(num_segments),
+      buckets(policy == policy_t::COST_BENEFIT ? GC_BUCKETS : 0) {}
+
+  void insert(segment_id_t segment, segment_seq_t seq, int64_t live_bytes) {
+    assert(segment < entries.size());
+    assert(!entries[segment].indexed);
+    entries[segment] = entry_t{true, seq, live_bytes};
+    link(segment);
+  }
+
+  void update(segment_id_t segment, int64_t live_bytes) {
+    assert(segment < entries.size());
+    assert(entries[segment].indexed);
+    unlink(segment);
+    entries[segment].live_bytes = live_bytes;
+    link(segment);
+  }
+
+  void remove(segment_id_t segment) {
+    assert(segment < entries.size());
+    assert(entries[segment].indexed);
+    unlink(segment);
+    entries[segment] = entry_t{};
+  }
+
+  bool contains(segment_id_t segment) const {
+    assert(segment < entries.size());
+    return entries[segment].indexed;
+  }
+
+  /**
+   * get_victim
+   *
+   * Returns the segment to gc next, or NULL_SEG_ID if every indexed
+   * segment is still in the journal.
+   */
+  segment_id_t get_victim(
+    journal_seq_t tail_committed,
+    segment_seq_t head_seq) const {
+    if (policy == policy_t::GREEDY) {
+      for (auto &[live_bytes, segment] : by_live_bytes) {
+	if (!in_journal(entries[segment].seq, tail_committed)) {
+	  return segment;
+	}
+      }
+      return NULL_SEG_ID;
+    }
+
+    segment_id_t ret = NULL_SEG_ID;
+    double best_score = -1;
+    for (auto &bucket : buckets) {
+      if (bucket.empty()) {
+	continue;
+      }
+      auto [seq, segment] = *bucket.begin();
+      if (in_journal(seq, tail_committed)) {
+	continue;
+      }
+      const double live = entries[segment].live_bytes;
+      const double age = (seq != NULL_SEG_SEQ && head_seq >= seq) ?
+	head_seq - seq + 1 : 1;
+      const double score = (segment_size - live) * age / (segment_size + live);
+      if (score > best_score) {
+	ret = segment;
+	best_score = score;
+      }
+    }
+    return ret;
+  }
+};
 
 class SegmentCleaner : public JournalSegmentProvider {
 public:
@@ -221,6 +370,8 @@ public:
 
     double available_ratio_hard_limit = 0;
 
+    SegmentGCIndex::policy_t gc_policy = SegmentGCIndex::policy_t::COST_BENEFIT;
+
     static config_t default_from_segment_manager(
       SegmentManager &manager) {
       return config_t{
@@ -312,11 +463,30 @@ public:
       segment_id_t id) = 0;
   };
 
+  /// GC accounting, used to derive write amplification
+  struct gc_stats_t {
+    /// bytes of extents committed since mount, including gc rewrites
+    uint64_t bytes_written = 0;
+    /// live bytes gc copied out of victim segments
+    uint64_t gc_bytes_rewritten = 0;
+    uint64_t segments_reclaimed = 0;
+
+    double get_write_amplification() const {
+      if (bytes_written <= gc_bytes_rewritten) {
+	return 1;
+      }
+      return (double)bytes_written /
+	(double)(bytes_written - gc_bytes_rewritten);
+    }
+  };
+
 private:
   const config_t config;
 
   SpaceTrackerIRef space_tracker;
   std::vector<segment_info_t> segments;
+  SegmentGCIndex gc_index;
+  gc_stats_t gc_stats;
   size_t empty_segments;
   int64_t used_bytes = 0;
   bool init_complete = false;
@@ -339,6 +509,7 @@ public:
 	(SpaceTrackerI*)new SpaceTrackerSimple(
 	  config.num_segments)),
       segments(config.num_segments),
+      gc_index(config.gc_policy, config.num_segments, config.segment_size),
       empty_segments(config.num_segments) {}
 
   get_segment_ret get_segment() final;
@@ -374,8 +545,8 @@ public:
       "SegmentCleaner::init_mark_segment_closed: segment {}, seq {}",
       segment,
       seq);
-    mark_closed(segment);
     segments[segment].journal_segment_seq = seq;
+    mark_closed(segment);
   }
 
   segment_seq_t get_seq(segment_id_t id) final {
@@ -383,9 +554,14 @@ public:
   }
 
   void mark_segment_released(segment_id_t segment) {
+    ++gc_stats.segments_reclaimed;
     return mark_empty(segment);
   }
 
+  const gc_stats_t &get_gc_stats() const {
+    return gc_stats;
+  }
+
   void mark_space_used(
     paddr_t addr,
     extent_len_t len,
@@ -396,11 +572,15 @@ public:
       return;
 
     used_bytes += len;
+    if (!init_scan) {
+      gc_stats.bytes_written += len;
+    }
     [[maybe_unused]] auto ret = space_tracker->allocate(
       addr.segment,
       addr.offset,
       len);
     assert(ret > 0);
+    update_gc_index(addr.segment);
   }
 
   void mark_space_free(
@@ -417,24 +597,19 @@ public:
       addr.offset,
       len);
     assert(ret >= 0);
+    update_gc_index(addr.segment);
   }
 
   segment_id_t get_next_gc_target() const {
-    segment_id_t ret = NULL_SEG_ID;
-    int64_t least_live_bytes = std::numeric_limits<int64_t>::max();
-    for (segment_id_t i = 0; i < segments.size(); ++i) {
-      if (segments[i].is_closed() &&
-	  !segments[i].is_in_journal(journal_tail_committed) &&
-	  space_tracker->get_usage(i) < least_live_bytes) {
-	ret = i;
-	least_live_bytes = space_tracker->get_usage(i);
-      }
-    }
+    segment_id_t ret = gc_index.get_victim(
+      journal_tail_committed,
+      journal_head.segment_seq);
     if (ret != NULL_SEG_ID) {
       crimson::get_logger(ceph_subsys_filestore).debug(
-	"SegmentCleaner::get_next_gc_target: segment {} seq {}",
+	"SegmentCleaner::get_next_gc_target: segment {} seq {} live {}",
 	ret,
-	segments[ret].journal_segment_seq);
+	segments[ret].journal_segment_seq,
+	space_tracker->get_usage(ret));
     }
     return ret;
   }
@@ -650,6 +825,12 @@ private:
     return std::max(for_reclaim, for_available);
   }
 
+  void update_gc_index(segment_id_t segment) {
+    if (segments[segment].is_closed()) {
+      gc_index.update(segment, space_tracker->get_usage(segment));
+    }
+  }
+
   void mark_closed(segment_id_t segment) {
     assert(segments.size() > segment);
     if (init_complete) {
@@ -663,6 +844,10 @@ private:
       "mark_closed: empty_segments: {}",
       empty_segments);
     segments[segment].state = Segment::segment_state_t::CLOSED;
+    gc_index.insert(
+      segment,
+      segments[segment].journal_segment_seq,
+      space_tracker->get_usage(segment));
   }
 
   void mark_empty(segment_id_t segment) {
@@ -674,6 +859,7 @@ private:
       space_tracker->dump_usage(segment);
       assert(space_tracker->get_usage(segment) == 0);
     }
+    gc_index.remove(segment);
     segments[segment].state = Segment::segment_state_t::EMPTY;
   }
 
@@ -9,6 +9,7 @@
 #include "crimson/os/seastore/seastore_types.h"
 #include "crimson/os/seastore/cached_extent.h"
 #include "crimson/os/seastore/root_block.h"
+#include "crimson/os/seastore/random_block_manager.h"
 
 namespace crimson::os::seastore {
 
@@ -71,11 +72,28 @@ public:
   void add_fresh_extent(CachedExtentRef ref) {
     ceph_assert(!is_weak());
     fresh_block_list.push_back(ref);
-    ref->set_paddr(make_record_relative_paddr(offset));
-    offset += ref->get_length();
+    if (!ref->get_paddr().is_rbm()) {
+      // extents already placed in the RandomBlockManager aren't part of
+      // the record
+      ref->set_paddr(make_record_relative_paddr(offset));
+      offset += ref->get_length();
+    }
     write_set.insert(*ref);
   }
 
+  /// Release blk~len back to the RandomBlockManager once *this commits
+  void add_rbm_release(rbm_blk_t blk, extent_len_t len) {
+    rbm_released.emplace_back(blk, len);
+  }
+
+  /// Release blk~len back to rbm unless *this commits
+  void add_rbm_allocation(
+    RandomBlockManager &_rbm, rbm_blk_t blk, extent_len_t len) {
+    assert(!rbm || rbm == &_rbm);
+    rbm = &_rbm;
+    rbm_allocated.emplace_back(blk, len);
+  }
+
   void add_mutated_extent(CachedExtentRef ref) {
     ceph_assert(!is_weak());
     mutated_block_list.push_back(ref);
@@ -133,6 +151,12 @@ private:
   ///< if != NULL_SEG_ID, release this segment after completion
   segment_id_t to_release = NULL_SEG_ID;
 
+  RandomBlockManager *rbm = nullptr;
+  ///< blocks allocated from rbm for fresh extents, cleared on commit
+  std::vector<std::pair<rbm_blk_t, extent_len_t>> rbm_allocated;
+  ///< blocks of uncached retired extents, released on commit
+  std::vector<std::pair<rbm_blk_t, extent_len_t>> rbm_released;
+
 public:
   Transaction(
     OrderingHandle &&handle,
@@ -145,6 +169,9 @@ public:
       i->state = CachedExtent::extent_state_t::INVALID;
       write_set.erase(*i++);
     }
+    for (auto &[blk, len] : rbm_allocated) {
+      rbm->free_extent(blk, len);
+    }
   }
 };
 using TransactionRef = Transaction::Ref;
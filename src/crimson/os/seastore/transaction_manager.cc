@@ -65,9 +65,14 @@ TransactionManager::mkfs_ertr::future<> TransactionManager::mkfs()
 TransactionManager::mount_ertr::future<> TransactionManager::mount()
 {
   cache.init();
-  return journal.replay([this](auto seq, auto paddr, const auto &e) {
-    return cache.replay_delta(seq, paddr, e);
-  }).safe_then([this] {
+  return journal.replay(
+    [this](auto seq, auto paddr, const auto &e) {
+      return cache.replay_delta(seq, paddr, e);
+    },
+    [this](const auto &e) {
+      return cache.prefetch_delta_extent(e);
+    }
+  ).safe_then([this] {
     return journal.open_for_write();
   }).safe_then([this](auto addr) {
     segment_cleaner.set_journal_head(addr);
@@ -82,6 +87,10 @@ TransactionManager::mount_ertr::future<> TransactionManager::mount()
           return lba_manager.scan_mapped_space(
             *t,
             [this](paddr_t addr, extent_len_t len) {
+              if (addr.is_rbm()) {
+                // tracked by the RandomBlockManager's bitmap
+                return;
+              }
               logger().debug("TransactionManager::mount: marking {}~{} used",
                            addr,
                            len);
@@ -157,7 +166,9 @@ TransactionManager::ref_ret TransactionManager::dec_ref(
       logger().debug(
 	"TransactionManager::dec_ref: offset {} refcount 0",
 	offset);
-      return cache.retire_extent_if_cached(t, result.addr).safe_then([] {
+      return cache.retire_extent_if_cached(
+	t, result.addr, result.length
+      ).safe_then([] {
 	return ref_ret(
 	  ref_ertr::ready_future_marker{},
 	  0);
@@ -204,8 +215,10 @@ TransactionManager::submit_transaction(
       return crimson::ct_error::eagain::make();
     }
 
-    return journal.submit_record(std::move(*record), tref.handle
-    ).safe_then([this, &tref](auto p) mutable {
+    return cache.write_rbm_extents(tref
+    ).safe_then([this, &tref, record=std::move(*record)]() mutable {
+      return journal.submit_record(std::move(record), tref.handle);
+    }).safe_then([this, &tref](auto p) mutable {
       auto [addr, journal_seq] = p;
       segment_cleaner.set_journal_head(journal_seq);
       cache.complete_commit(tref, addr, journal_seq, &segment_cleaner);
@@ -259,6 +272,32 @@ TransactionManager::rewrite_extent_ret TransactionManager::rewrite_extent(
     cache.duplicate_for_write(t, extent);
     return rewrite_extent_ertr::now();
   }
+
+  if (extent->get_paddr().is_rbm()) {
+    /* Rather than being moved, the extent is replaced by a fresh copy
+     * at the same paddr, which Cache::write_rbm_extents then writes out
+     * in place, so the lba mapping doesn't change.  Any transaction
+     * which has read the old copy will have to retry.
+     */
+    auto lextent = extent->cast<LogicalCachedExtent>();
+    cache.retire_extent(t, extent);
+    auto nlextent = cache.alloc_new_extent_by_type(
+      t,
+      lextent->get_type(),
+      lextent->get_length(),
+      lextent->get_paddr())->cast<LogicalCachedExtent>();
+    lextent->get_bptr().copy_out(
+      0,
+      lextent->get_length(),
+      nlextent->get_bptr().c_str());
+    nlextent->set_laddr(lextent->get_laddr());
+    nlextent->set_pin(lextent->get_pin().duplicate());
+    logger().debug(
+      "{}: rewriting {} in place",
+      __func__,
+      *lextent);
+    return rewrite_extent_ertr::now();
+  }
   return lba_manager.rewrite_extent(t, extent);
 }
 
@@ -195,7 +195,8 @@ public:
    * alloc_extent
    *
    * Allocates a new block of type T with the minimum lba range of size len
-   * greater than hint.
+   * greater than hint.  Data extents are placed in the RandomBlockManager
+   * if the Cache has one, see Cache::alloc_new_data_extent.
    */
   using alloc_extent_ertr = LBAManager::alloc_extent_ertr;
   template <typename T>
@@ -205,18 +206,20 @@ public:
     Transaction &t,
     laddr_t hint,
     extent_len_t len) {
-    auto ext = cache.alloc_new_extent<T>(
+    return cache.alloc_new_data_extent<T>(
       t,
-      len);
-    return lba_manager.alloc_extent(
-      t,
-      hint,
-      len,
-      ext->get_paddr()
-    ).safe_then([ext=std::move(ext)](auto &&ref) mutable {
-      ext->set_pin(std::move(ref));
-      return alloc_extent_ertr::make_ready_future<TCachedExtentRef<T>>(
-	std::move(ext));
+      len
+    ).safe_then([this, &t, hint, len](auto ext) {
+      return lba_manager.alloc_extent(
+	t,
+	hint,
+	len,
+	ext->get_paddr()
+      ).safe_then([ext=std::move(ext)](auto &&ref) mutable {
+	ext->set_pin(std::move(ref));
+	return alloc_extent_ertr::make_ready_future<TCachedExtentRef<T>>(
+	  std::move(ext));
+      });
     });
   }
 
@@ -0,0 +1,134 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include "BalancePredictor.h"
+
+#include <algorithm>
+
+#include "common/Formatter.h"
+
+void LoadHistory::sample(double now, double load, double alpha, double beta,
+			 size_t max_samples)
+{
+  if (samples.empty()) {
+    level = load;
+    trend = 0;
+  } else {
+    double dt = now - samples.back().first;
+    if (dt <= 0) {
+      // same epoch sampled twice; just refresh the latest value
+      samples.back().second = load;
+      return;
+    }
+    double prev_level = level;
+    level = alpha * load + (1 - alpha) * (level + trend * dt);
+    trend = beta * (level - prev_level) / dt + (1 - beta) * trend;
+  }
+  samples.emplace_back(now, load);
+  while (samples.size() > max_samples)
+    samples.pop_front();
+}
+
+double LoadHistory::predict(double horizon) const
+{
+  if (samples.empty())
+    return 0;
+  // a single sample says nothing about the trend
+  if (samples.size() == 1)
+    return std::max(0.0, level);
+  return std::max(0.0, level + trend * horizon);
+}
+
+void LoadHistory::dump(ceph::Formatter *f) const
+{
+  f->dump_float("level", level);
+  f->dump_float("trend", trend);
+  f->open_array_section("samples");
+  for (const auto& [stamp, load] : samples) {
+    f->open_object_section("sample");
+    f->dump_float("stamp", stamp);
+    f->dump_float("load", load);
+    f->close_section();
+  }
+  f->close_section();
+}
+
+double BalancePredictor::sample(dirfrag_t df, double now, double load)
+{
+  auto& h = subtrees[df];
+  h.sample(now, load, conf.alpha, conf.beta, conf.max_samples);
+  return h.predict(conf.horizon);
+}
+
+double BalancePredictor::sample_rank(mds_rank_t rank, double now, double load)
+{
+  auto& h = ranks[rank];
+  h.sample(now, load, conf.alpha, conf.beta, conf.max_samples);
+  return h.predict(conf.horizon);
+}
+
+double BalancePredictor::predict(dirfrag_t df, double fallback) const
+{
+  auto p = subtrees.find(df);
+  if (p == subtrees.end())
+    return fallback;
+  return p->second.predict(conf.horizon);
+}
+
+bool BalancePredictor::in_cooldown(dirfrag_t df, double now) const
+{
+  auto p = last_migrated.find(df);
+  return p != last_migrated.end() && now - p->second < conf.cooldown;
+}
+
+void BalancePredictor::trim(double before)
+{
+  for (auto p = subtrees.begin(); p != subtrees.end(); ) {
+    if (p->second.get_last_stamp() < before)
+      p = subtrees.erase(p);
+    else
+      ++p;
+  }
+  for (auto p = last_migrated.begin(); p != last_migrated.end(); ) {
+    if (p->second < before)
+      p = last_migrated.erase(p);
+    else
+      ++p;
+  }
+}
+
+void BalancePredictor::dump(ceph::Formatter *f) const
+{
+  f->open_object_section("predictor");
+  f->dump_float("horizon", conf.horizon);
+  f->dump_float("migration_cost", conf.migration_cost);
+  f->dump_float("cooldown", conf.cooldown);
+  f->open_array_section("ranks");
+  for (const auto& [rank, h] : ranks) {
+    f->open_object_section("rank");
+    f->dump_int("rank", rank);
+    f->dump_float("predicted", h.predict(conf.horizon));
+    h.dump(f);
+    f->close_section();
+  }
+  f->close_section();
+  f->open_array_section("subtrees");
+  for (const auto& [df, h] : subtrees) {
+    f->open_object_section("subtree");
+    f->dump_stream("dirfrag") << df;
+    f->dump_float("predicted", h.predict(conf.horizon));
+    h.dump(f);
+    f->close_section();
+  }
+  f->close_section();
+  f->close_section();
+}
@@ -0,0 +1,104 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_MDS_BALANCEPREDICTOR_H
+#define CEPH_MDS_BALANCEPREDICTOR_H
+
+#include <deque>
+#include <map>
+
+#include "mdstypes.h"
+
+/**
+ * A short time series of load samples for one subtree (or rank), with a
+ * double exponential (Holt) smoothed estimate of its level and trend.
+ *
+ * The instantaneous decay counters react to every burst; the smoothed
+ * level only moves when the load is sustained across several samples.
+ */
+class LoadHistory {
+public:
+  LoadHistory() {}
+
+  void sample(double now, double load, double alpha, double beta,
+	      size_t max_samples);
+
+  /// predicted load @a horizon seconds after the last sample, never < 0
+  double predict(double horizon) const;
+
+  double get_last_stamp() const {
+    return samples.empty() ? 0 : samples.back().first;
+  }
+  size_t get_num_samples() const { return samples.size(); }
+
+  void dump(ceph::Formatter *f) const;
+
+private:
+  std::deque<std::pair<double, double>> samples; // (stamp, load)
+  double level = 0;
+  double trend = 0;   // load change per second
+};
+
+/**
+ * Keeps per-subtree and per-rank load histories for the balancer and
+ * turns them into the sustained load it should act on.  Also remembers
+ * when subtrees last migrated so they are not bounced straight back.
+ */
+class BalancePredictor {
+public:
+  struct config_t {
+    double alpha = .5;           // level smoothing
+    double beta = .3;            // trend smoothing
+    double horizon = 30;         // seconds to predict ahead
+    double migration_cost = 0;   // load-seconds per migrated metadata item
+    double cooldown = 60;        // seconds a migrated subtree stays put
+    size_t max_samples = 16;
+  };
+
+  BalancePredictor() {}
+  explicit BalancePredictor(const config_t& c) : conf(c) {}
+
+  void set_config(const config_t& c) { conf = c; }
+  const config_t& get_config() const { return conf; }
+
+  /// record @a load for @a df and return its predicted sustained load
+  double sample(dirfrag_t df, double now, double load);
+  double sample_rank(mds_rank_t rank, double now, double load);
+
+  double predict(dirfrag_t df, double fallback) const;
+
+  /**
+   * Would moving a subtree with the given predicted load and number of
+   * metadata items pay for itself within the prediction horizon?
+   */
+  bool worth_migrating(double predicted, uint64_t nitems) const {
+    return predicted * conf.horizon > conf.migration_cost * nitems;
+  }
+
+  void note_migration(dirfrag_t df, double now) {
+    last_migrated[df] = now;
+  }
+  bool in_cooldown(dirfrag_t df, double now) const;
+
+  /// forget subtrees not sampled or migrated since @a before
+  void trim(double before);
+
+  void dump(ceph::Formatter *f) const;
+
+private:
+  config_t conf;
+  std::map<dirfrag_t, LoadHistory> subtrees;
+  std::map<mds_rank_t, LoadHistory> ranks;
+  std::map<dirfrag_t, double> last_migrated;
+};
+
+#endif
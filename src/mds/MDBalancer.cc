@@ -79,6 +79,8 @@ MDBalancer::MDBalancer(MDSRank *m, Messenger *msgr, MonClient *monc) :
 {
   bal_fragment_dirs = g_conf().get_val<bool>("mds_bal_fragment_dirs");
   bal_fragment_interval = g_conf().get_val<int64_t>("mds_bal_fragment_interval");
+  bal_predictive = g_conf().get_val<bool>("mds_bal_predictive");
+  load_predictor_config();
 }
 
 void MDBalancer::handle_conf_change(const std::set<std::string>& changed, const MDSMap& mds_map)
@@ -87,6 +89,25 @@ void MDBalancer::handle_conf_change(const std::set<std::string>& changed, const
     bal_fragment_dirs = g_conf().get_val<bool>("mds_bal_fragment_dirs");
   if (changed.count("mds_bal_fragment_interval"))
     bal_fragment_interval = g_conf().get_val<int64_t>("mds_bal_fragment_interval");
+  if (changed.count("mds_bal_predictive"))
+    bal_predictive = g_conf().get_val<bool>("mds_bal_predictive");
+  if (changed.count("mds_bal_predictive_horizon") ||
+      changed.count("mds_bal_predictive_alpha") ||
+      changed.count("mds_bal_predictive_beta") ||
+      changed.count("mds_bal_predictive_migration_cost") ||
+      changed.count("mds_bal_predictive_cooldown"))
+    load_predictor_config();
+}
+
+void MDBalancer::load_predictor_config()
+{
+  BalancePredictor::config_t c = predictor.get_config();
+  c.horizon = g_conf().get_val<double>("mds_bal_predictive_horizon");
+  c.alpha = g_conf().get_val<double>("mds_bal_predictive_alpha");
+  c.beta = g_conf().get_val<double>("mds_bal_predictive_beta");
+  c.migration_cost = g_conf().get_val<double>("mds_bal_predictive_migration_cost");
+  c.cooldown = g_conf().get_val<double>("mds_bal_predictive_cooldown");
+  predictor.set_config(c);
 }
 
 void MDBalancer::handle_export_pins(void)
@@ -704,10 +725,17 @@ void MDBalancer::prep_rebalance(int beat)
 
     double total_load = 0.0;
     multimap<double,mds_rank_t> load_map;
+    const double stamp = get_stamp(rebalance_time);
     for (mds_rank_t i=mds_rank_t(0); i < mds_rank_t(cluster_size); i++) {
       mds_load_t& load = mds_load.at(i);
 
       double l = load.mds_load() * load_fac;
+      if (bal_predictive) {
+	double predicted = predictor.sample_rank(i, stamp, l);
+	dout(15) << "  mds." << i << " load " << l
+		 << " predicted " << predicted << dendl;
+	l = predicted;
+      }
       mds_meta_load[i] = l;
 
       if (whoami == 0)
@@ -896,6 +924,13 @@ void MDBalancer::try_rebalance(balance_state_t& state)
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
 
+  const double stamp = get_stamp(rebalance_time);
+  if (bal_predictive) {
+    // forget subtrees we have not looked at for a while
+    predictor.trim(stamp - 10 * std::max(predictor.get_config().horizon,
+					 predictor.get_config().cooldown));
+  }
+
   for (auto& dir : mds->mdcache->get_fullauth_subtrees()) {
     CInode *diri = dir->get_inode();
     if (diri->is_mdsdir())
@@ -907,6 +942,13 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 
     mds_rank_t from = diri->authority().first;
     double pop = dir->pop_auth_subtree.meta_load();
+    if (bal_predictive) {
+      pop = predictor.sample(dir->dirfrag(), stamp, pop);
+      if (predictor.in_cooldown(dir->dirfrag(), stamp)) {
+	dout(15) << "  map: not moving recently migrated " << *dir << dendl;
+	continue;
+      }
+    }
     if (g_conf()->mds_bal_idle_threshold > 0 &&
 	pop < g_conf()->mds_bal_idle_threshold &&
 	diri != mds->mdcache->get_root() &&
@@ -1109,6 +1151,16 @@ void MDBalancer::find_exports(CDir *dir,
       subdir_sum += pop;
       dout(15) << "   subdir pop " << pop << " " << *subdir << dendl;
 
+      if (bal_predictive) {
+	const double stamp = get_stamp(rebalance_time);
+	pop = predictor.sample(subdir->dirfrag(), stamp, pop);
+	if (predictor.in_cooldown(subdir->dirfrag(), stamp) ||
+	    !predictor.worth_migrating(pop, subdir->get_num_any())) {
+	  dout(15) << "   predicted pop " << pop << ", not worth moving" << dendl;
+	  continue;
+	}
+      }
+
       if (pop < minchunk) {
 	num_idle_frags++;
 	continue;
@@ -1335,6 +1387,9 @@ void MDBalancer::subtract_export(CDir *dir)
 {
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
+  if (bal_predictive)
+    predictor.note_migration(dir->dirfrag(), get_stamp(clock::now()));
+
   while (true) {
     dir = dir->inode->get_parent_dir();
     if (!dir) break;
@@ -1349,6 +1404,9 @@ void MDBalancer::add_import(CDir *dir)
 {
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
+  if (bal_predictive)
+    predictor.note_migration(dir->dirfrag(), get_stamp(clock::now()));
+
   while (true) {
     dir = dir->inode->get_parent_dir();
     if (!dir) break;
@@ -1486,6 +1544,9 @@ int MDBalancer::dump_loads(Formatter *f) const
   }
   f->close_section(); // mds_import_map
 
+  if (bal_predictive)
+    predictor.dump(f);
+
   f->close_section(); // loads
   return 0;
 }
@@ -22,6 +22,7 @@
 #include "messages/MHeartbeat.h"
 
 #include "MDSMap.h"
+#include "BalancePredictor.h"
 
 class MDSRank;
 class MHeartbeat;
@@ -118,7 +119,13 @@ private:
    */
   void try_rebalance(balance_state_t& state);
 
+  void load_predictor_config();
+  double get_stamp(time t) const {
+    return std::chrono::duration<double>(t.time_since_epoch()).count();
+  }
+
   bool bal_fragment_dirs;
+  bool bal_predictive;
   int64_t bal_fragment_interval;
   static const unsigned int AUTH_TREES_THRESHOLD = 5;
 
@@ -153,5 +160,8 @@ private:
   // per-epoch state
   double my_load = 0;
   double target_load = 0;
+
+  // load histories for mds_bal_predictive
+  BalancePredictor predictor;
 };
 #endif
@@ -162,25 +162,40 @@ MDCache::MDCache(MDSRank *m, PurgeQueue &purge_queue_) :
 
   upkeeper = std::thread([this]() {
     std::unique_lock lock(upkeep_mutex);
+    /* set while a sliced trim pass still has slices to go */
+    bool trim_pending = false;
     while (!upkeep_trim_shutdown.load()) {
       auto now = clock::now();
       auto since = now-upkeep_last_trim;
       auto trim_interval = clock::duration(g_conf().get_val<std::chrono::seconds>("mds_cache_trim_interval"));
-      if (since >= trim_interval*.90) {
+      if (trim_pending || since >= trim_interval*.90) {
         lock.unlock(); /* mds_lock -> upkeep_mutex */
-        std::scoped_lock mds_lock(mds->mds_lock);
+        std::unique_lock mds_lock(mds->mds_lock);
         lock.lock();
         if (upkeep_trim_shutdown.load())
           return;
         if (mds->is_cache_trimmable()) {
-          dout(20) << "upkeep thread trimming cache; last trim " << since << " ago" << dendl;
-          trim_client_leases();
-          trim();
-          check_memory_usage();
-          auto flags = Server::RecallFlags::ENFORCE_MAX|Server::RecallFlags::ENFORCE_LIVENESS;
-          mds->server->recall_client_state(nullptr, flags);
-          upkeep_last_trim = now = clock::now();
+          if (!trim_pending) {
+            dout(20) << "upkeep thread trimming cache; last trim " << since << " ago" << dendl;
+            trim_client_leases();
+          }
+          const uint64_t slice = g_conf().get_val<Option::size_t>("mds_cache_trim_slice");
+          auto [throttled, trimmed] = trim(0, slice);
+          trim_pending = !throttled && slice > 0 && trimmed >= slice && cache_toofull();
+          if (trim_pending) {
+            /* drop mds_lock and wait before the next slice, so that requests
+             * queued behind this one are dispatched in between */
+            trim_interval = clock::duration(g_conf().get_val<std::chrono::milliseconds>("mds_cache_trim_slice_interval"));
+            dout(20) << "upkeep thread trimmed " << trimmed
+                     << ", next slice in " << trim_interval << dendl;
+          } else {
+            check_memory_usage();
+            auto flags = Server::RecallFlags::ENFORCE_MAX|Server::RecallFlags::ENFORCE_LIVENESS;
+            mds->server->recall_client_state(nullptr, flags);
+            upkeep_last_trim = now = clock::now();
+          }
         } else {
+          trim_pending = false;
           dout(10) << "cache not ready for trimming" << dendl;
         }
       } else {
@@ -6691,7 +6706,8 @@ void MDCache::purge_inodes(const interval_set<inodeno_t>& inos, LogSegment *ls)
 // ================================================================================
 // cache trimming
 
-std::pair<bool, uint64_t> MDCache::trim_lru(uint64_t count, expiremap& expiremap)
+std::pair<bool, uint64_t> MDCache::trim_lru(uint64_t count, uint64_t slice,
+					     expiremap& expiremap)
 {
   bool is_standby_replay = mds->is_standby_replay();
   std::vector<CDentry *> unexpirables;
@@ -6701,6 +6717,7 @@ std::pair<bool, uint64_t> MDCache::trim_lru(uint64_t count, expiremap& expiremap
 
   dout(7) << "trim_lru trimming " << count
           << " items from LRU"
+          << " slice=" << slice
           << " size=" << lru.lru_get_size()
           << " mid=" << lru.lru_get_top()
           << " pintail=" << lru.lru_get_pintail()
@@ -6712,6 +6729,7 @@ std::pair<bool, uint64_t> MDCache::trim_lru(uint64_t count, expiremap& expiremap
   while (1) {
     throttled |= trim_counter_start+trimmed >= trim_threshold;
     if (throttled) break;
+    if (slice && trimmed >= slice) break;
     CDentry *dn = static_cast<CDentry*>(bottom_lru.lru_expire());
     if (!dn)
       break;
@@ -6732,6 +6750,7 @@ std::pair<bool, uint64_t> MDCache::trim_lru(uint64_t count, expiremap& expiremap
   while (!throttled && (cache_toofull() || count > 0 || is_standby_replay)) {
     throttled |= trim_counter_start+trimmed >= trim_threshold;
     if (throttled) break;
+    if (slice && trimmed >= slice) break;
     CDentry *dn = static_cast<CDentry*>(lru.lru_expire());
     if (!dn) {
       break;
@@ -6765,22 +6784,24 @@ std::pair<bool, uint64_t> MDCache::trim_lru(uint64_t count, expiremap& expiremap
  * however, we may expire a replica whose authority is recovering.
  *
  * @param count is number of dentries to try to expire
+ * @param slice if nonzero, stop after trimming this many dentries from the LRU
  */
-std::pair<bool, uint64_t> MDCache::trim(uint64_t count)
+std::pair<bool, uint64_t> MDCache::trim(uint64_t count, uint64_t slice)
 {
   uint64_t used = cache_size();
   uint64_t limit = cache_memory_limit;
   expiremap expiremap;
+  utime_t start = ceph_clock_now();
 
   dout(7) << "trim bytes_used=" << bytes2str(used)
           << " limit=" << bytes2str(limit)
           << " reservation=" << cache_reservation
-          << "% count=" << count << dendl;
+          << "% count=" << count << " slice=" << slice << dendl;
 
   // process delayed eval_stray()
   stray_manager.advance_delayed();
 
-  auto result = trim_lru(count, expiremap);
+  auto result = trim_lru(count, slice, expiremap);
   auto& trimmed = result.second;
 
   // trim non-auth, non-bound subtrees
@@ -6893,6 +6914,13 @@ std::pair<bool, uint64_t> MDCache::trim(uint64_t count)
   // send any expire messages
   send_expire_messages(expiremap);
 
+  if (logger) {
+    utime_t lat = ceph_clock_now() - start;
+    logger->inc(l_mdc_trim_slices);
+    logger->tinc(l_mdc_trim_lat, lat);
+    logger->hinc(l_mdc_trim_lat_hist, lat.to_nsec(), trimmed);
+  }
+
   return result;
 }
 
@@ -13193,6 +13221,29 @@ void MDCache::register_perfcounters()
     pcb.add_u64_counter(l_mdss_ireq_inodestats, "ireq_inodestats",
                         "Internal Request type inode stats");
 
+    // mds_lock hold time of cache trimming
+    PerfHistogramCommon::axis_config_d trim_hist_x_axis_config{
+      "Latency (usec)",
+      PerfHistogramCommon::SCALE_LOG2, // Latency in logarithmic scale
+      0,                               // Start at 0
+      100000,                          // Quantization unit is 100usec
+      32,                              // Enough to cover multi-second stalls
+    };
+    PerfHistogramCommon::axis_config_d trim_hist_y_axis_config{
+      "Dentries trimmed",
+      PerfHistogramCommon::SCALE_LOG2, // Trimmed count in logarithmic scale
+      0,                               // Start at 0
+      64,                              // Quantization unit is 64 dentries
+      20,                              // Enough to cover mds_cache_trim_threshold
+    };
+    pcb.add_u64_counter(l_mdc_trim_slices, "trim_slices",
+                        "Cache trims");
+    pcb.add_time_avg(l_mdc_trim_lat, "trim_latency",
+                     "Time mds_lock is held per cache trim");
+    pcb.add_u64_counter_histogram(l_mdc_trim_lat_hist, "trim_latency_histogram",
+                                  trim_hist_x_axis_config, trim_hist_y_axis_config,
+                                  "Histogram of cache trim mds_lock hold time + dentries trimmed");
+
     logger.reset(pcb.create_perf_counters());
     g_ceph_context->get_perfcounters_collection()->add(logger.get());
     recovery_queue.set_logger(logger.get());
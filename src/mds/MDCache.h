@@ -106,6 +106,11 @@ enum {
   l_mdss_ireq_fragstats,
   l_mdss_ireq_inodestats,
 
+  // How many times the cache was trimmed, and how long mds_lock was held
+  l_mdc_trim_slices,
+  l_mdc_trim_lat,
+  l_mdc_trim_lat_hist,
+
   l_mdc_last,
 };
 
@@ -609,7 +614,7 @@ class MDCache {
   size_t get_cache_size() { return lru.lru_get_size(); }
 
   // trimming
-  std::pair<bool, uint64_t> trim(uint64_t count=0);
+  std::pair<bool, uint64_t> trim(uint64_t count=0, uint64_t slice=0);
 
   bool trim_non_auth_subtree(CDir *directory);
   void standby_trim_segment(LogSegment *ls);
@@ -1266,7 +1271,8 @@ class MDCache {
 
   void identify_files_to_recover();
 
-  std::pair<bool, uint64_t> trim_lru(uint64_t count, expiremap& expiremap);
+  std::pair<bool, uint64_t> trim_lru(uint64_t count, uint64_t slice,
+				     expiremap& expiremap);
   bool trim_dentry(CDentry *dn, expiremap& expiremap);
   void trim_dirfrag(CDir *dir, CDir *con, expiremap& expiremap);
   bool trim_inode(CDentry *dn, CInode *in, CDir *con, expiremap&);
@@ -67,6 +67,10 @@ void MDLog::create_logger()
   plb.add_u64_counter(l_mdl_replayed, "replayed", "Events replayed",
 		      "repl", PerfCountersBuilder::PRIO_INTERESTING);
   plb.add_time_avg(l_mdl_jlat, "jlat", "Journaler flush latency");
+  plb.add_u64_avg(l_mdl_evbatch, "evbatch", "Events per submit batch");
+  plb.add_u64_avg(l_mdl_evflush, "evflush", "Events per journal flush");
+  plb.add_u64_counter(l_mdl_jflush, "jflush", "Journal flushes issued");
+  plb.add_time_avg(l_mdl_enclat, "enclat", "Submit batch encode latency");
   plb.add_u64_counter(l_mdl_evex, "evex", "Total expired events");
   plb.add_u64_counter(l_mdl_evtrm, "evtrm", "Trimmed events");
   plb.add_u64_counter(l_mdl_segadd, "segadd", "Segments added");
@@ -181,6 +185,7 @@ void MDLog::create(MDSContext *c)
   logger->set(l_mdl_expos, journaler->get_expire_pos());
   logger->set(l_mdl_wrpos, journaler->get_write_pos());
 
+  _start_encoders();
   submit_thread.create("md_submit");
 }
 
@@ -192,6 +197,7 @@ void MDLog::open(MDSContext *c)
   recovery_thread.set_completion(c);
   recovery_thread.create("md_recov_open");
 
+  _start_encoders();
   submit_thread.create("md_submit");
   // either append() or replay() will follow.
 }
@@ -356,6 +362,10 @@ void MDLog::_submit_thread()
 
   std::unique_lock locker{submit_mutex};
 
+  std::vector<PendingEvent> batch;
+  std::vector<bufferlist> bls;
+  uint64_t unflushed_events = 0;
+
   while (!mds->is_daemon_stopping()) {
     if (g_conf()->mds_log_pause) {
       submit_cond.wait(locker);
@@ -373,52 +383,70 @@ void MDLog::_submit_thread()
       continue;
     }
 
+    // take everything queued so far (up to the batch limit), so that the
+    // events which piled up while the previous batch was being written
+    // share a single journal flush.
+    const size_t max_batch =
+      g_conf().get_val<uint64_t>("mds_log_submit_batch_events");
     int64_t features = mdsmap_up_features;
-    PendingEvent data = it->second.front();
-    it->second.pop_front();
-
-    locker.unlock();
-
-    if (data.le) {
-      LogEvent *le = data.le;
-      LogSegment *ls = le->_segment;
-      // encode it, with event type
-      bufferlist bl;
-      le->encode_with_header(bl, features);
-
-      uint64_t write_pos = journaler->get_write_pos();
-
-      le->set_start_off(write_pos);
-      if (le->get_type() == EVENT_SUBTREEMAP)
-	ls->offset = write_pos;
-
-      dout(5) << "_submit_thread " << write_pos << "~" << bl.length()
-	      << " : " << *le << dendl;
-
-      // journal it.
-      const uint64_t new_write_pos = journaler->append_entry(bl);  // bl is destroyed.
-      ls->end = new_write_pos;
-
-      MDSLogContextBase *fin;
-      if (data.fin) {
-	fin = dynamic_cast<MDSLogContextBase*>(data.fin);
-	ceph_assert(fin);
-	fin->set_write_pos(new_write_pos);
-      } else {
-	fin = new C_MDL_Flushed(this, new_write_pos);
+    batch.clear();
+    while (it != pending_events.end() && batch.size() < max_batch) {
+      auto& q = it->second;
+      while (!q.empty() && batch.size() < max_batch) {
+	batch.push_back(q.front());
+	q.pop_front();
       }
+      if (q.empty() && std::next(it) != pending_events.end())
+	it = pending_events.erase(it);
+      else
+	++it;
+    }
 
-      journaler->wait_for_flush(fin);
-
-      if (data.flush)
-	journaler->flush();
-
-      if (logger)
-	logger->set(l_mdl_wrpos, ls->end);
+    locker.unlock();
 
-      delete le;
-    } else {
-      if (data.fin) {
+    bls.clear();
+    bls.resize(batch.size());
+    _encode_batch(batch, bls, features);
+
+    bool do_flush = false;
+    uint64_t num_batch_events = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      PendingEvent& data = batch[i];
+      if (data.le) {
+	LogEvent *le = data.le;
+	LogSegment *ls = le->_segment;
+	bufferlist& bl = bls[i];
+
+	uint64_t write_pos = journaler->get_write_pos();
+
+	le->set_start_off(write_pos);
+	if (le->get_type() == EVENT_SUBTREEMAP)
+	  ls->offset = write_pos;
+
+	dout(5) << "_submit_thread " << write_pos << "~" << bl.length()
+		<< " : " << *le << dendl;
+
+	// journal it.
+	const uint64_t new_write_pos = journaler->append_entry(bl);  // bl is destroyed.
+	ls->end = new_write_pos;
+
+	MDSLogContextBase *fin;
+	if (data.fin) {
+	  fin = dynamic_cast<MDSLogContextBase*>(data.fin);
+	  ceph_assert(fin);
+	  fin->set_write_pos(new_write_pos);
+	} else {
+	  fin = new C_MDL_Flushed(this, new_write_pos);
+	}
+
+	journaler->wait_for_flush(fin);
+	num_batch_events++;
+
+	if (logger)
+	  logger->set(l_mdl_wrpos, ls->end);
+
+	delete le;
+      } else if (data.fin) {
 	MDSContext* fin =
 		dynamic_cast<MDSContext*>(data.fin);
 	ceph_assert(fin);
@@ -427,17 +455,126 @@ void MDLog::_submit_thread()
 	journaler->wait_for_flush(fin2);
       }
       if (data.flush)
-	journaler->flush();
+	do_flush = true;
     }
 
+    // group commit: one flush covers every flush request in the batch.
+    if (do_flush)
+      journaler->flush();
+
+    unflushed_events += num_batch_events;
+    if (logger) {
+      logger->inc(l_mdl_evbatch, num_batch_events);
+      if (do_flush) {
+	logger->inc(l_mdl_jflush);
+	logger->inc(l_mdl_evflush, unflushed_events);
+      }
+    }
+    if (do_flush)
+      unflushed_events = 0;
+
     locker.lock();
-    if (data.flush)
-      unflushed = 0;
-    else if (data.le)
-      unflushed++;
+    for (auto& data : batch) {
+      if (data.flush)
+	unflushed = 0;
+      else if (data.le)
+	unflushed++;
+    }
   }
 }
 
+void MDLog::_start_encoders()
+{
+  std::lock_guard l(encode_mutex);
+  ceph_assert(encode_threads.empty());
+  encode_stop = false;
+  const auto n = g_conf().get_val<uint64_t>("mds_log_submit_encoders");
+  for (uint64_t i = 0; i < n; ++i) {
+    encode_threads.emplace_back(std::make_unique<EncodeThread>(this));
+    encode_threads.back()->create("md_log_enc");
+  }
+}
+
+void MDLog::_stop_encoders()
+{
+  {
+    std::lock_guard l(encode_mutex);
+    encode_stop = true;
+    encode_cond.notify_all();
+  }
+  for (auto& t : encode_threads)
+    t->join();
+  encode_threads.clear();
+}
+
+/**
+ * Claim and encode the next event of the current batch.  Called with
+ * encode_mutex held; drops it while encoding.  Returns false if there
+ * was nothing left to claim.
+ */
+bool MDLog::_encode_one(std::unique_lock<ceph::mutex>& l)
+{
+  EncodeBatch *b = encode_batch;
+  if (!b || b->next >= b->events->size())
+    return false;
+
+  size_t i = b->next++;
+  l.unlock();
+  LogEvent *le = (*b->events)[i].le;
+  if (le)
+    le->encode_with_header((*b->bls)[i], b->features);
+  l.lock();
+
+  if (++b->done == b->events->size())
+    encode_done_cond.notify_all();
+  return true;
+}
+
+void MDLog::_encode_thread()
+{
+  std::unique_lock l(encode_mutex);
+  while (!encode_stop) {
+    if (!_encode_one(l))
+      encode_cond.wait(l);
+  }
+}
+
+void MDLog::_encode_batch(std::vector<PendingEvent>& batch,
+			  std::vector<bufferlist>& bls, uint64_t features)
+{
+  utime_t start = ceph_clock_now();
+
+  size_t num_events = 0;
+  for (auto& data : batch) {
+    if (data.le)
+      num_events++;
+  }
+
+  if (num_events < 2 || encode_threads.empty()) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (batch[i].le)
+	batch[i].le->encode_with_header(bls[i], features);
+    }
+  } else {
+    EncodeBatch b;
+    b.events = &batch;
+    b.bls = &bls;
+    b.features = features;
+
+    std::unique_lock l(encode_mutex);
+    encode_batch = &b;
+    encode_cond.notify_all();
+    // the submit thread encodes alongside the helpers
+    while (_encode_one(l))
+      ;
+    encode_done_cond.wait(l, [&b, &batch] { return b.done == batch.size(); });
+    encode_batch = nullptr;
+  }
+
+  if (logger && num_events)
+    logger->tinc(l_mdl_enclat, ceph_clock_now() - start);
+}
+
 void MDLog::wait_for_safe(MDSContext *c)
 {
   submit_mutex.lock();
@@ -511,6 +648,7 @@ void MDLog::shutdown()
       submit_thread.join();
     }
   }
+  _stop_encoders();
 
   // Replay thread can be stuck inside e.g. Journaler::wait_for_readable,
   // so we need to shutdown the journaler first.
@@ -35,6 +35,10 @@ enum {
   l_mdl_rdpos,
   l_mdl_jlat,
   l_mdl_replayed,
+  l_mdl_evbatch,
+  l_mdl_evflush,
+  l_mdl_jflush,
+  l_mdl_enclat,
   l_mdl_last,
 };
 
@@ -50,6 +54,8 @@ enum {
 
 #include <list>
 #include <map>
+#include <memory>
+#include <vector>
 
 class Journaler;
 class JournalPointer;
@@ -220,10 +226,32 @@ protected:
     MDLog *log;
   } submit_thread;
 
+  // Helpers encoding the events of a submit batch in parallel
+  class EncodeThread : public Thread {
+  public:
+    explicit EncodeThread(MDLog *l) : log(l) {}
+    void* entry() override {
+      log->_encode_thread();
+      return 0;
+    }
+  private:
+    MDLog *log;
+  };
+
+  // A batch of events being encoded; owned by the submit thread
+  struct EncodeBatch {
+    std::vector<PendingEvent> *events = nullptr;
+    std::vector<bufferlist> *bls = nullptr;
+    uint64_t features = 0;
+    size_t next = 0;      // next event to claim
+    size_t done = 0;      // events encoded
+  };
+
   friend class ReplayThread;
   friend class C_MDL_Replay;
   friend class MDSLogContextBase;
   friend class SubmitThread;
+  friend class EncodeThread;
   // -- subtreemaps --
   friend class ESubtreeMap;
   friend class MDCache;
@@ -242,6 +270,12 @@ protected:
   }
 
   void _submit_thread();
+  void _start_encoders();
+  void _stop_encoders();
+  void _encode_thread();
+  bool _encode_one(std::unique_lock<ceph::mutex>& l);
+  void _encode_batch(std::vector<PendingEvent>& batch,
+		     std::vector<bufferlist>& bls, uint64_t features);
 
   uint64_t get_last_segment_seq() const {
     ceph_assert(!segments.empty());
@@ -288,6 +322,13 @@ protected:
   ceph::mutex submit_mutex = ceph::make_mutex("MDLog::submit_mutex");
   ceph::condition_variable submit_cond;
 
+  std::vector<std::unique_ptr<EncodeThread>> encode_threads;
+  ceph::mutex encode_mutex = ceph::make_mutex("MDLog::encode_mutex");
+  ceph::condition_variable encode_cond;       // work available / stopping
+  ceph::condition_variable encode_done_cond;  // batch fully encoded
+  EncodeBatch *encode_batch = nullptr;
+  bool encode_stop = false;
+
 private:
   friend class C_MaybeExpiredSegment;
   friend class C_MDL_Flushed;
@@ -3323,6 +3323,8 @@ void MDSRank::create_logger()
                     "Inodes with capabilities");
     mds_plb.add_u64(l_mds_subtrees, "subtrees", "Subtrees");
     mds_plb.add_u64(l_mds_load_cent, "load_cent", "Load per cent");
+    mds_plb.add_time_avg(l_mds_dispatch_lock_wait, "dispatch_lock_wait",
+                         "Time messages waited for mds_lock before dispatch");
     mds_plb.add_u64_counter(l_mds_openino_dir_fetch, "openino_dir_fetch",
                             "OpenIno incomplete directory fetchings");
 
@@ -1164,7 +1164,13 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
     pool_stat_t &pool_sum_ref = pg_pool_sum[update_pool];
     if (pg_stat_iter == pg_stat.end()) {
       pg_stat.insert(make_pair(update_pg, update_stat));
+      mark_purged_snaps_dirty(update_pool);
     } else {
+      const pg_stat_t &old_stat = pg_stat_iter->second;
+      if ((old_stat.state == 0) != (update_stat.state == 0) ||
+	  old_stat.purged_snaps != update_stat.purged_snaps) {
+	mark_purged_snaps_dirty(update_pool);
+      }
       stat_pg_sub(update_pg, pg_stat_iter->second);
       pool_sum_ref.sub(pg_stat_iter->second);
       pg_stat_iter->second = update_stat;
@@ -1218,6 +1224,7 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
     bool pool_erased = false;
     if (s != pg_stat.end()) {
       pool_erased = stat_pg_sub(removed_pg, s->second);
+      mark_purged_snaps_dirty(removed_pg.pool());
 
       // decrease pool stats if pg was removed
       auto pool_stats_it = pg_pool_sum.find(removed_pg.pool());
@@ -1240,10 +1247,12 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
       stat_osd_sub(t->first, t->second);
       osd_stat.erase(t);
     }
-    for (auto i = pool_statfs.begin();  i != pool_statfs.end(); ++i) {
+    for (auto i = pool_statfs.begin();  i != pool_statfs.end();) {
       if (i->first.second == *p) {
 	pg_pool_sum[i->first.first].sub(i->second);
-	pool_statfs.erase(i);
+	i = pool_statfs.erase(i);
+      } else {
+	++i;
       }
     }
   }
@@ -1292,6 +1301,9 @@ void PGMap::calc_stats()
   pg_pool_sum.clear();
   num_pg_by_pool.clear();
   pg_by_osd.clear();
+  pg_by_pool.clear();
+  purged_snaps_dirty.clear();
+  purged_snaps_all_dirty = true;
   pg_sum = pool_stat_t();
   osd_sum = osd_stat_t();
   osd_sum_by_class.clear();
@@ -1328,6 +1340,7 @@ void PGMap::stat_pg_add(const pg_t &pgid, const pg_stat_t &s,
   num_pg_by_state[s.state]++;
   num_pg_by_pool_state[pgid.pool()][s.state]++;
   num_pg_by_pool[pool]++;
+  pg_by_pool[pool].insert(pgid);
 
   if ((s.state & PG_STATE_CREATING) &&
       s.parent_split_bits == 0) {
@@ -1388,6 +1401,11 @@ bool PGMap::stat_pg_sub(const pg_t &pgid, const pg_stat_t &s,
   if (end == 0) {
     pool_erased = true;
   }
+  if (auto p = pg_by_pool.find(pgid.pool()); p != pg_by_pool.end()) {
+    p->second.erase(pgid);
+    if (p->second.empty())
+      pg_by_pool.erase(p);
+  }
 
   if ((s.state & PG_STATE_CREATING) &&
       s.parent_split_bits == 0) {
@@ -1455,33 +1473,65 @@ bool PGMap::stat_pg_sub(const pg_t &pgid, const pg_stat_t &s,
 
 void PGMap::calc_purged_snaps()
 {
-  purged_snaps.clear();
-  set<int64_t> unknown;
-  for (auto& i : pg_stat) {
-    if (i.second.state == 0) {
-      unknown.insert(i.first.pool());
-      purged_snaps.erase(i.first.pool());
-      continue;
-    } else if (unknown.count(i.first.pool())) {
-      continue;
+  if (purged_snaps_all_dirty) {
+    purged_snaps.clear();
+    for (auto& [pool, pgs] : pg_by_pool) {
+      calc_pool_purged_snaps(pool);
+    }
+    purged_snaps_all_dirty = false;
+  } else {
+    for (auto pool : purged_snaps_dirty) {
+      calc_pool_purged_snaps(pool);
+    }
+  }
+  purged_snaps_dirty.clear();
+}
+
+void PGMap::calc_pool_purged_snaps(int64_t pool)
+{
+  purged_snaps.erase(pool);
+  auto p = pg_by_pool.find(pool);
+  if (p == pg_by_pool.end()) {
+    return;
+  }
+  interval_set<snapid_t> *r = nullptr;
+  for (auto& pgid : p->second) {
+    auto& stat = pg_stat.at(pgid);
+    if (stat.state == 0) {
+      // unknown pg; we can't say anything about the pool
+      purged_snaps.erase(pool);
+      return;
     }
-    auto j = purged_snaps.find(i.first.pool());
-    if (j == purged_snaps.end()) {
+    if (!r) {
       // base case
-      purged_snaps[i.first.pool()] = i.second.purged_snaps;
+      r = &purged_snaps[pool];
+      *r = stat.purged_snaps;
     } else {
-      j->second.intersection_of(i.second.purged_snaps);
+      r->intersection_of(stat.purged_snaps);
     }
   }
 }
 
 void PGMap::calc_osd_sum_by_class(const OSDMap& osdmap)
 {
+  if (osd_class_epoch == osdmap.get_epoch() && osd_class_epoch) {
+    // kept up to date by stat_osd_{add,sub}
+    return;
+  }
+  osd_class.clear();
+  for (int osd = 0; osd < osdmap.get_max_osd(); ++osd) {
+    const char *class_name = osdmap.crush->get_item_class(osd);
+    if (class_name) {
+      osd_class.emplace(osd, class_name);
+    }
+  }
+  osd_class_epoch = osdmap.get_epoch();
+
   osd_sum_by_class.clear();
   for (auto& i : osd_stat) {
-    const char *class_name = osdmap.crush->get_item_class(i.first);
-    if (class_name) {
-      osd_sum_by_class[class_name].add(i.second);
+    auto c = osd_class.find(i.first);
+    if (c != osd_class.end()) {
+      osd_sum_by_class[c->second].add(i.second);
     }
   }
 }
@@ -1490,6 +1540,9 @@ void PGMap::stat_osd_add(int osd, const osd_stat_t &s)
 {
   num_osd++;
   osd_sum.add(s);
+  if (auto c = osd_class.find(osd); c != osd_class.end()) {
+    osd_sum_by_class[c->second].add(s);
+  }
   if (osd >= (int)osd_last_seq.size()) {
     osd_last_seq.resize(osd + 1);
   }
@@ -1500,6 +1553,12 @@ void PGMap::stat_osd_sub(int osd, const osd_stat_t &s)
 {
   num_osd--;
   osd_sum.sub(s);
+  if (auto c = osd_class.find(osd); c != osd_class.end()) {
+    auto p = osd_sum_by_class.find(c->second);
+    if (p != osd_sum_by_class.end()) {
+      p->second.sub(s);
+    }
+  }
   ceph_assert(osd < (int)osd_last_seq.size());
   osd_last_seq[osd] = 0;
 }
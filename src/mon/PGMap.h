@@ -303,6 +303,7 @@ public:
 
   // aggregate stats (soft state), generated by calc_stats()
   mempool::pgmap::unordered_map<int,std::set<pg_t> > pg_by_osd;
+  mempool::pgmap::unordered_map<int64_t,mempool::pgmap::set<pg_t>> pg_by_pool;
   mempool::pgmap::unordered_map<int,int> blocked_by_sum;
   mempool::pgmap::list<std::pair<pool_stat_t, utime_t> > pg_sum_deltas;
   mempool::pgmap::unordered_map<int64_t,mempool::pgmap::unordered_map<uint64_t,int32_t>> num_pg_by_pool_state;
@@ -325,6 +326,7 @@ public:
     }
 
     pg_pool_sum.erase(pool);
+    pg_by_pool.erase(pool);
     num_pg_by_pool_state.erase(pool);
     num_pg_by_pool.erase(pool);
     per_pool_sum_deltas.erase(pool);
@@ -348,6 +350,22 @@ public:
                              const int64_t pool,
                              const pool_stat_t& old_pool_sum);
 
+  // The digest aggregates below are kept up to date as incrementals are
+  // applied, so encode_digest() only recomputes what actually changed.
+
+  // pools whose purged_snaps need recomputing
+  mempool::pgmap::set<int64_t> purged_snaps_dirty;
+  bool purged_snaps_all_dirty = true;
+  void mark_purged_snaps_dirty(int64_t pool) {
+    if (!purged_snaps_all_dirty)
+      purged_snaps_dirty.insert(pool);
+  }
+  void calc_pool_purged_snaps(int64_t pool);
+
+  // crush class of each osd, as of osdmap epoch osd_class_epoch
+  mempool::pgmap::unordered_map<int32_t,std::string> osd_class;
+  epoch_t osd_class_epoch = 0;
+
  public:
 
   mempool::pgmap::set<pg_t> creating_pgs;
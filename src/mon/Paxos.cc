@@ -118,6 +118,10 @@ void Paxos::init_logger()
   pcb.add_u64_avg(l_paxos_collect_keys, "collect_keys", "Keys in transaction on peon collect");
   pcb.add_u64_avg(l_paxos_collect_bytes, "collect_bytes", "Data in transaction on peon collect", NULL, 0, unit_t(UNIT_BYTES));
   pcb.add_time_avg(l_paxos_collect_latency, "collect_latency", "Peon collect latency");
+  pcb.add_u64_avg(l_paxos_propose_services, "propose_services",
+                  "Service updates coalesced into each proposal");
+  pcb.add_time_avg(l_paxos_propose_latency, "propose_latency",
+                   "Latency from first pending update to commit of its proposal");
   pcb.add_u64_counter(l_paxos_collect_uncommitted, "collect_uncommitted", "Uncommitted values in started and handled collects");
   pcb.add_u64_counter(l_paxos_collect_timeout, "collect_timeout", "Collect timeouts");
   pcb.add_u64_counter(l_paxos_accept_timeout, "accept_timeout", "Accept timeouts");
@@ -892,6 +896,10 @@ void Paxos::commit_finish()
   dout(20) << __func__ << " " << (last_committed+1) << dendl;
   utime_t end = ceph_clock_now();
   logger->tinc(l_paxos_commit_latency, end - commit_start_stamp);
+  if (committing_proposal_stamp != utime_t()) {
+    logger->tinc(l_paxos_propose_latency, end - committing_proposal_stamp);
+    committing_proposal_stamp = utime_t();
+  }
 
   ceph_assert(g_conf()->paxos_kill_at != 8);
 
@@ -1547,6 +1555,8 @@ void Paxos::propose_pending()
 
   pending_proposal.reset();
 
+  logger->inc(l_paxos_propose_services, pending_finishers.size());
+  committing_proposal_stamp = pending_proposal_stamp;
   committing_finishers.swap(pending_finishers);
   state = STATE_UPDATING;
   begin(bl);
@@ -1564,6 +1574,7 @@ MonitorDBStore::TransactionRef Paxos::get_pending_transaction()
   ceph_assert(mon.is_leader());
   if (!pending_proposal) {
     pending_proposal.reset(new MonitorDBStore::Transaction);
+    pending_proposal_stamp = ceph_clock_now();
     ceph_assert(pending_finishers.empty());
   }
   return pending_proposal;
@@ -156,6 +156,8 @@ enum {
   l_paxos_share_state_bytes,
   l_paxos_new_pn,
   l_paxos_new_pn_latency,
+  l_paxos_propose_services,
+  l_paxos_propose_latency,
   l_paxos_last,
 };
 
@@ -589,6 +591,13 @@ private:
    * to be committed.
    */
   std::list<Context*> pending_finishers;
+  /**
+   * When the pending transaction was started, and when the one currently
+   * being committed was; used to measure how long an update waits for
+   * its round to commit.
+   */
+  utime_t pending_proposal_stamp;
+  utime_t committing_proposal_stamp;
 
   /**
    * Finishers for committing transaction
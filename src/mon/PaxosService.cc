@@ -249,6 +249,22 @@ void PaxosService::propose_pending()
     }
   };
   paxos.queue_pending_finisher(new C_Committed(this));
+
+  if (g_conf().get_val<bool>("paxos_propose_coalesce") &&
+      paxos.is_active() && !paxos.is_plugged()) {
+    // we are about to start a round: let the services that are only
+    // waiting out their proposal interval ride along in the same
+    // transaction instead of each paying for a round of their own.
+    paxos.plug();
+    for (auto& svc : mon.paxos_service) {
+      if (svc.get() != this && svc->is_proposal_delayed()) {
+	dout(10) << __func__ << " coalescing pending "
+		 << svc->get_service_name() << dendl;
+	svc->propose_pending();
+      }
+    }
+    paxos.unplug();
+  }
   paxos.trigger_propose();
 }
 
@@ -510,6 +510,14 @@ public:
       (paxos.is_active() || paxos.is_updating() || paxos.is_writing());
   }
 
+  /**
+   * Check if we have pending changes that are only waiting for our
+   * proposal_timer to fire.
+   */
+  bool is_proposal_delayed() const {
+    return have_pending && proposal_timer && is_active();
+  }
+
   /**
    * Check if we are readable.
    *
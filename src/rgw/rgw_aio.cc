@@ -105,6 +105,25 @@ Aio::OpFunc aio_abstract(Op&& op, optional_yield y) {
   return aio_abstract(std::forward<Op>(op));
 }
 
+// completes a data cache read, or hands the request to the fallback op
+struct CacheReadHandler {
+  Aio* aio;
+  AioResult& r;
+  Aio::OpFunc fallback;
+  int ret;
+  bufferlist bl;
+
+  void operator()() {
+    if (ret < 0) {
+      std::move(fallback)(aio, r);
+      return;
+    }
+    r.result = 0;
+    r.data = std::move(bl);
+    aio->put(r);
+  }
+};
+
 } // anonymous namespace
 
 Aio::OpFunc Aio::librados_op(librados::ObjectReadOperation&& op,
@@ -116,4 +135,31 @@ Aio::OpFunc Aio::librados_op(librados::ObjectWriteOperation&& op,
   return aio_abstract(std::move(op), y);
 }
 
+Aio::OpFunc Aio::datacache_op(RGWDataCache* cache, RGWDataCache::hit_t&& hit,
+                              OpFunc&& fallback, optional_yield y) {
+  if (y) {
+    auto yield = y.get_yield_context();
+    return [cache, hit = std::move(hit), fallback = std::move(fallback),
+            yield] (Aio* aio, AioResult& r) mutable {
+      // like the librados completions, finish on the yield_context's strand
+      // so the fallback can submit and put() without locking
+      using namespace boost::asio;
+      async_completion<spawn::yield_context, void()> init(yield);
+      auto ex = get_associated_executor(init.completion_handler);
+      cache->read(hit, [aio, &r, ex, fallback = std::move(fallback)]
+                  (int ret, bufferlist&& bl) mutable {
+          post(ex, CacheReadHandler{aio, r, std::move(fallback),
+                                    ret, std::move(bl)});
+        });
+    };
+  }
+  return [cache, hit = std::move(hit), fallback = std::move(fallback)]
+    (Aio* aio, AioResult& r) mutable {
+      cache->read(hit, [aio, &r, fallback = std::move(fallback)]
+                  (int ret, bufferlist&& bl) mutable {
+          CacheReadHandler{aio, r, std::move(fallback), ret, std::move(bl)}();
+        });
+    };
+}
+
 } // namespace rgw
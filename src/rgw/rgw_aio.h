@@ -26,6 +26,7 @@
 #include "services/svc_rados.h" // cant forward declare RGWSI_RADOS::Obj
 
 #include "rgw_common.h"
+#include "rgw_datacache.h"
 
 #include "include/function2.hpp"
 
@@ -91,10 +92,17 @@ class Aio {
   // wait for all outstanding completions and return their results
   virtual AioResultList drain() = 0;
 
+  // change the window of a throttling implementation
+  virtual void set_window(uint64_t window) {}
+
   static OpFunc librados_op(librados::ObjectReadOperation&& op,
                             optional_yield y);
   static OpFunc librados_op(librados::ObjectWriteOperation&& op,
                             optional_yield y);
+  // read a stripe from the local data cache, running fallback instead if
+  // it can't be read from there
+  static OpFunc datacache_op(RGWDataCache* cache, RGWDataCache::hit_t&& hit,
+                             OpFunc&& fallback, optional_yield y);
 };
 
 } // namespace rgw
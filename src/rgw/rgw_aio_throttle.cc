@@ -13,6 +13,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "include/rados/librados.hpp"
 
 #include "rgw_aio_throttle.h"
@@ -109,6 +111,15 @@ AioResultList BlockingAioThrottle::drain()
   return std::move(completed);
 }
 
+void BlockingAioThrottle::set_window(uint64_t w)
+{
+  std::scoped_lock lock{mutex};
+  window = w;
+  if (waiter_ready()) {
+    cond.notify_one();
+  }
+}
+
 template <typename CompletionToken>
 auto YieldingAioThrottle::async_wait(CompletionToken&& token)
 {
@@ -199,4 +210,32 @@ AioResultList YieldingAioThrottle::drain()
   }
   return std::move(completed);
 }
+
+void YieldingAioThrottle::set_window(uint64_t w)
+{
+  // only called from within the coroutine, so nobody can be waiting
+  window = w;
+}
+
+void AdaptiveWindow::complete(uint64_t bytes, ceph::timespan lat,
+                              Clock::time_point now)
+{
+  const double l = std::chrono::duration<double>(lat).count();
+  latency = latency ? (latency * 7 + l) / 8 : l;
+
+  round_bytes += bytes;
+  if (round_bytes < window) {
+    return;
+  }
+  const double elapsed = std::chrono::duration<double>(now - round_start).count();
+  if (elapsed > 0) {
+    max_rate = std::max(max_rate, round_bytes / elapsed);
+  }
+  round_start = now;
+  round_bytes = 0;
+
+  const double bdp = 2 * max_rate * latency;
+  window = std::clamp<uint64_t>(bdp, min, max);
+}
+
 } // namespace rgw
@@ -18,6 +18,7 @@
 #include "include/rados/librados_fwd.hpp"
 #include <memory>
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/async/completion.h"
 #include "common/async/yield_context.h"
 #include "services/svc_rados.h"
@@ -27,7 +28,7 @@ namespace rgw {
 
 class Throttle {
  protected:
-  const uint64_t window;
+  uint64_t window;
   uint64_t pending_size = 0;
 
   AioResultList pending;
@@ -76,6 +77,8 @@ class BlockingAioThrottle final : public Aio, private Throttle {
   AioResultList wait() override final;
 
   AioResultList drain() override final;
+
+  void set_window(uint64_t window) override final;
 };
 
 // a throttle that yields the coroutine instead of blocking. all public
@@ -110,6 +113,33 @@ class YieldingAioThrottle final : public Aio, private Throttle {
   AioResultList wait() override final;
 
   AioResultList drain() override final;
+
+  void set_window(uint64_t window) override final;
+};
+
+// sizes an aio window to the observed bandwidth-delay product. the window
+// starts at min and keeps growing while that raises the rate at which ops
+// complete, settling at twice the best rate seen times the op latency. for
+// writes, that rate is also bounded by how fast the client sends the data
+class AdaptiveWindow {
+  using Clock = ceph::mono_clock;
+  const uint64_t min;
+  const uint64_t max;
+  uint64_t window;
+  Clock::time_point round_start;
+  uint64_t round_bytes = 0;
+  double max_rate = 0; // bytes/sec, best over a round of one window
+  double latency = 0; // seconds, smoothed
+ public:
+  AdaptiveWindow(uint64_t min, uint64_t max, Clock::time_point now)
+    : min(min), max(std::max(min, max)), window(min), round_start(now) {}
+
+  // account for a read of the given size and latency that completed at now
+  void complete(uint64_t bytes, ceph::timespan lat, Clock::time_point now);
+
+  uint64_t get() const { return window; }
+  double get_max_rate() const { return max_rate; }
+  double get_latency() const { return latency; }
 };
 
 // return a smart pointer to Aio
@@ -56,6 +56,7 @@ class StreamIO : public rgw::asio::ClientIO {
   spawn::yield_context yield;
   parse_buffer& buffer;
   ceph::timespan request_timeout;
+  std::vector<boost::asio::const_buffer> buffers;
  public:
   StreamIO(CephContext *cct, Stream& stream, rgw::asio::parser_type& parser,
            spawn::yield_context yield,
@@ -68,13 +69,28 @@ class StreamIO : public rgw::asio::ClientIO {
   {}
 
   size_t write_data(const char* buf, size_t len) override {
+    return write(boost::asio::buffer(buf, len));
+  }
+
+  size_t write_buffers(const ceph::bufferlist& bl) override {
+    // point at the bufferlist's segments rather than making it contiguous.
+    // on a plain socket the whole sequence goes out with writev()
+    buffers.clear();
+    buffers.reserve(bl.get_num_buffers());
+    for (const auto& ptr : bl.buffers()) {
+      buffers.emplace_back(ptr.c_str(), ptr.length());
+    }
+    return write(buffers);
+  }
+
+  template <typename ConstBufferSequence>
+  size_t write(const ConstBufferSequence& seq) {
     boost::system::error_code ec;
     auto& timeout = get_lowest_layer(stream);
     if (request_timeout.count()) {
       timeout.expires_after(request_timeout);
     }
-    auto bytes = boost::asio::async_write(stream, boost::asio::buffer(buf, len),
-                                          yield[ec]);
+    auto bytes = boost::asio::async_write(stream, seq, yield[ec]);
     if (ec) {
       ldout(cct, 4) << "write_data failed: " << ec.message() << dendl;
       if (ec==boost::asio::error::broken_pipe) {
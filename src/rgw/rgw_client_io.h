@@ -146,6 +146,19 @@ public:
    * of response's body. On failure throws rgw::io::Exception. */
   virtual size_t send_body(const char* buf, size_t len) = 0;
 
+  /* Generate a part of response's body by taking the whole content of @bl.
+   * Front-ends able to write a sequence of buffers at once should override
+   * this to avoid making @bl contiguous. By default each segment is passed
+   * to send_body() separately. On success returns number of generated bytes
+   * of response's body. On failure throws rgw::io::Exception. */
+  virtual size_t send_body_list(const ceph::bufferlist& bl) {
+    size_t sent = 0;
+    for (const auto& ptr : bl.buffers()) {
+      sent += send_body(ptr.c_str(), ptr.length());
+    }
+    return sent;
+  }
+
   /* Flushes all already generated data to a direct client of RadosGW.
    * On failure throws rgw::io::Exception containing errno. */
   virtual void flush() = 0;
@@ -200,6 +213,13 @@ protected:
     return get_decoratee().init_env(cct);
   }
 
+  /* Decorators don't forward send_body_list() by default as they may need
+   * to see every piece of the body through send_body(). Those leaving the
+   * body untouched can pass the whole list down with this. */
+  size_t forward_body_list(const ceph::bufferlist& bl) {
+    return get_decoratee().send_body_list(bl);
+  }
+
 public:
   explicit DecoratedRestfulClient(DecorateeT&& decoratee)
     : decoratee(std::forward<DecorateeT>(decoratee)) {
@@ -0,0 +1,345 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+#include "rgw_datacache.h"
+
+#include <algorithm>
+#include <future>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/errno.h"
+#include "common/perf_counters.h"
+#include "rgw_perf_counters.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_rgw
+#undef dout_prefix
+#define dout_prefix *_dout << "rgw datacache: "
+
+static constexpr std::string_view FILE_PREFIX = "rgwdc.";
+
+RGWDataCache::RGWDataCache(CephContext *cct, const config_t& conf)
+  : cct(cct), conf(conf), writer(this)
+{}
+
+RGWDataCache::~RGWDataCache()
+{
+  shutdown();
+}
+
+std::string RGWDataCache::file_path(uint64_t id) const
+{
+  return conf.path + "/" + std::string(FILE_PREFIX) + std::to_string(id);
+}
+
+int RGWDataCache::init()
+{
+  if (::mkdir(conf.path.c_str(), 0750) < 0 && errno != EEXIST) {
+    int r = -errno;
+    lderr(cct) << "failed to create " << conf.path << ": "
+               << cpp_strerror(r) << dendl;
+    return r;
+  }
+  DIR *dir = ::opendir(conf.path.c_str());
+  if (!dir) {
+    int r = -errno;
+    lderr(cct) << "failed to open " << conf.path << ": "
+               << cpp_strerror(r) << dendl;
+    return r;
+  }
+  // the index is not persistent; only touch files we created
+  unsigned removed = 0;
+  while (struct dirent *de = ::readdir(dir)) {
+    std::string_view name(de->d_name);
+    if (name.substr(0, FILE_PREFIX.size()) == FILE_PREFIX) {
+      ::unlinkat(::dirfd(dir), de->d_name, 0);
+      removed++;
+    }
+  }
+  ::closedir(dir);
+  ldout(cct, 1) << "using " << conf.path << " capacity " << conf.capacity
+                << ", removed " << removed << " stale entries" << dendl;
+
+  writer.create("rgw_datacache");
+  for (unsigned i = 0; i < std::max(conf.read_threads, 1u); i++) {
+    readers.push_back(std::make_unique<Reader>(this));
+    readers.back()->create("rgw_dc_read");
+  }
+  return 0;
+}
+
+void RGWDataCache::shutdown()
+{
+  {
+    std::lock_guard l{lock};
+    if (stopping)
+      return;
+    stopping = true;
+    cond.notify_all();
+    read_cond.notify_all();
+  }
+  if (writer.is_started())
+    writer.join();
+  for (auto& reader : readers)
+    reader->join();
+  readers.clear();
+}
+
+std::optional<RGWDataCache::hit_t>
+RGWDataCache::lookup(const std::string& group, const std::string& tag,
+                     const std::string& key)
+{
+  std::vector<uint64_t> removed;
+  std::optional<hit_t> hit;
+  {
+    std::lock_guard l{lock};
+    auto g = groups.find(group);
+    if (g != groups.end() && g->second.tag != tag) {
+      ldout(cct, 20) << group << " changed, dropping cached stripes" << dendl;
+      remove_group(group, removed);
+    } else if (auto e = entries.find(key); e != entries.end()) {
+      lru.splice(lru.begin(), lru, e->second.lru_pos);
+      hit = hit_t{key, e->second.id, e->second.len};
+    }
+  }
+  unlink_files(removed);
+  if (!hit && perfcounter)
+    perfcounter->inc(l_rgw_datacache_miss);
+  return hit;
+}
+
+void RGWDataCache::read(const hit_t& hit, read_callback_t&& cb)
+{
+  std::unique_lock l{lock};
+  if (stopping) {
+    l.unlock();
+    cb(-ECANCELED, {});
+    return;
+  }
+  reads.push_back(Read{hit, std::move(cb)});
+  read_cond.notify_one();
+}
+
+bool RGWDataCache::get(const std::string& group, const std::string& tag,
+                       const std::string& key, ceph::bufferlist *bl)
+{
+  auto hit = lookup(group, tag, key);
+  if (!hit)
+    return false;
+  std::promise<int> done;
+  read(*hit, [&done, bl] (int r, ceph::bufferlist&& data) {
+    *bl = std::move(data);
+    done.set_value(r);
+  });
+  return done.get_future().get() >= 0;
+}
+
+int RGWDataCache::read_file(const hit_t& hit, ceph::bufferlist *bl)
+{
+  std::string err;
+  int r = bl->read_file(file_path(hit.id).c_str(), &err);
+  if (r >= 0 && bl->length() == hit.len) {
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_datacache_hit);
+      perfcounter->inc(l_rgw_datacache_hit_b, hit.len);
+    }
+    return 0;
+  }
+  // evicted while we were reading it, or the file went bad
+  ldout(cct, 10) << "failed to read " << file_path(hit.id) << ": " << err << dendl;
+  bl->clear();
+  if (r < 0 && r != -ENOENT) {
+    std::vector<uint64_t> removed;
+    {
+      std::lock_guard l{lock};
+      if (auto e = entries.find(hit.key);
+          e != entries.end() && e->second.id == hit.id)
+        remove_entry(hit.key, removed);
+    }
+    unlink_files(removed);
+  }
+  if (perfcounter)
+    perfcounter->inc(l_rgw_datacache_miss);
+  return r < 0 ? r : -EIO;
+}
+
+void RGWDataCache::reader_entry()
+{
+  std::unique_lock l{lock};
+  while (!stopping) {
+    if (reads.empty()) {
+      read_cond.wait(l);
+      continue;
+    }
+    Read rd = std::move(reads.front());
+    reads.pop_front();
+    l.unlock();
+
+    ceph::bufferlist bl;
+    int r = read_file(rd.hit, &bl);
+    rd.cb(r, std::move(bl));
+
+    l.lock();
+  }
+  // let the callers fall back to reading RADOS
+  auto cancelled = std::move(reads);
+  reads.clear();
+  l.unlock();
+  for (auto& rd : cancelled)
+    rd.cb(-ECANCELED, {});
+}
+
+void RGWDataCache::put(const std::string& group, const std::string& tag,
+                       const std::string& key, const ceph::bufferlist& bl)
+{
+  if (perfcounter)
+    perfcounter->inc(l_rgw_datacache_miss_b, bl.length());
+  if (!bl.length() || bl.length() > conf.capacity)
+    return;
+  std::lock_guard l{lock};
+  if (stopping)
+    return;
+  if (pending + bl.length() > conf.max_pending) {
+    ldout(cct, 20) << "writer is behind, not caching " << key << dendl;
+    if (perfcounter)
+      perfcounter->inc(l_rgw_datacache_drop);
+    return;
+  }
+  pending += bl.length();
+  fills.push_back(Fill{group, tag, key, bl});
+  cond.notify_all();
+}
+
+void RGWDataCache::invalidate(const std::string& group)
+{
+  std::vector<uint64_t> removed;
+  {
+    std::lock_guard l{lock};
+    for (auto f = fills.begin(); f != fills.end(); ) {
+      if (f->group == group) {
+        pending -= f->bl.length();
+        f = fills.erase(f);
+      } else {
+        ++f;
+      }
+    }
+    if (writing_group == group)
+      writing_cancelled = true;
+    remove_group(group, removed);
+  }
+  unlink_files(removed);
+}
+
+uint64_t RGWDataCache::get_size() const
+{
+  std::lock_guard l{lock};
+  return size;
+}
+
+uint64_t RGWDataCache::get_num_entries() const
+{
+  std::lock_guard l{lock};
+  return entries.size();
+}
+
+void RGWDataCache::remove_entry(const std::string& key,
+                                std::vector<uint64_t>& removed)
+{
+  auto e = entries.find(key);
+  if (e == entries.end())
+    return;
+  auto g = groups.find(e->second.group);
+  if (g != groups.end()) {
+    g->second.keys.erase(key);
+    if (g->second.keys.empty())
+      groups.erase(g);
+  }
+  size -= e->second.len;
+  removed.push_back(e->second.id);
+  lru.erase(e->second.lru_pos);
+  entries.erase(e);
+}
+
+void RGWDataCache::remove_group(const std::string& group,
+                                std::vector<uint64_t>& removed)
+{
+  auto g = groups.find(group);
+  if (g == groups.end())
+    return;
+  for (auto& key : g->second.keys) {
+    auto e = entries.find(key);
+    if (e == entries.end())
+      continue;
+    size -= e->second.len;
+    removed.push_back(e->second.id);
+    lru.erase(e->second.lru_pos);
+    entries.erase(e);
+  }
+  groups.erase(g);
+}
+
+void RGWDataCache::unlink_files(const std::vector<uint64_t>& removed)
+{
+  for (auto id : removed)
+    ::unlink(file_path(id).c_str());
+}
+
+void RGWDataCache::writer_entry()
+{
+  std::unique_lock l{lock};
+  while (!stopping) {
+    if (fills.empty()) {
+      cond.wait(l);
+      continue;
+    }
+    Fill f = std::move(fills.front());
+    fills.pop_front();
+    writing_group = f.group;
+    writing_cancelled = false;
+    uint64_t id = next_id++;
+    uint64_t len = f.bl.length();
+    l.unlock();
+
+    int r = f.bl.write_file(file_path(id).c_str(), 0600);
+    std::vector<uint64_t> removed;
+
+    l.lock();
+    pending -= len;
+    writing_group.clear();
+    if (r < 0) {
+      ldout(cct, 0) << "ERROR: failed to write " << file_path(id) << ": "
+                    << cpp_strerror(r) << dendl;
+      removed.push_back(id);
+    } else if (writing_cancelled || stopping) {
+      removed.push_back(id);
+    } else {
+      auto g = groups.find(f.group);
+      if (g != groups.end() && g->second.tag != f.tag) {
+        // whichever version was read last wins
+        remove_group(f.group, removed);
+      }
+      remove_entry(f.key, removed);
+      auto& group = groups[f.group];
+      group.tag = f.tag;
+      group.keys.insert(f.key);
+      lru.push_front(f.key);
+      entries[f.key] = Entry{f.group, id, len, lru.begin()};
+      size += len;
+      while (size > conf.capacity && !lru.empty()) {
+        remove_entry(lru.back(), removed);
+        if (perfcounter)
+          perfcounter->inc(l_rgw_datacache_evict);
+      }
+    }
+    if (perfcounter)
+      perfcounter->set(l_rgw_datacache_size, size);
+    l.unlock();
+    unlink_files(removed);
+    l.lock();
+  }
+  pending = 0;
+  fills.clear();
+}
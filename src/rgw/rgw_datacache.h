@@ -0,0 +1,151 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "include/buffer.h"
+#include "include/function2.hpp"
+#include "common/Thread.h"
+#include "common/ceph_mutex.h"
+#include "common/dout.h"
+
+/**
+ * Read-through cache of object data stripes in a local directory,
+ * meant to be put on a fast local SSD in front of the data pools.
+ *
+ * Entries are stripes as read from RADOS, keyed by the raw object, offset
+ * and length of the read.  Every entry belongs to the head object it was
+ * read for and is only valid for that object's tag: a read that sees a
+ * different tag drops everything cached for the old version, and writes
+ * and deletes through this gateway invalidate the head explicitly.
+ *
+ * Lookups only consult the in-memory index.  The files themselves are
+ * read by a pool of reader threads, so that a GET never waits on the
+ * local disk in the frontend's threads.  Fills are handed to a writer
+ * thread and only become visible once they are on disk; if too much
+ * data is waiting to be written, new fills are dropped.  The index
+ * lives in memory only, so stale files are removed on startup.
+ * Eviction is least recently used, by bytes.
+ */
+class RGWDataCache {
+public:
+  struct config_t {
+    std::string path;
+    uint64_t capacity = 0;      // bytes on disk
+    uint64_t max_pending = 0;   // bytes queued for the writer
+    unsigned read_threads = 1;
+  };
+
+  /// a stripe found by lookup(), to be passed to read()
+  struct hit_t {
+    std::string key;
+    uint64_t id;
+    uint64_t len;
+  };
+  /// called from a reader thread with the stripe or a negative error
+  using read_callback_t = fu2::unique_function<void(int, ceph::bufferlist&&)>;
+
+  RGWDataCache(CephContext *cct, const config_t& conf);
+  ~RGWDataCache();
+
+  int init();
+  void shutdown();
+
+  /// find a cached stripe of @a group at @a tag without reading it
+  std::optional<hit_t> lookup(const std::string& group, const std::string& tag,
+                              const std::string& key);
+  /// read a stripe in the background. the entry may be evicted before it
+  /// is read, in which case @a cb gets -ENOENT and the caller reads RADOS
+  void read(const hit_t& hit, read_callback_t&& cb);
+  /// lookup() and read(), waiting for the read
+  bool get(const std::string& group, const std::string& tag,
+           const std::string& key, ceph::bufferlist *bl);
+  /// queue a stripe read from RADOS to be cached
+  void put(const std::string& group, const std::string& tag,
+           const std::string& key, const ceph::bufferlist& bl);
+  /// forget everything cached for @a group
+  void invalidate(const std::string& group);
+
+  uint64_t get_size() const;
+  uint64_t get_num_entries() const;
+
+private:
+  struct Entry {
+    std::string group;
+    uint64_t id;
+    uint64_t len;
+    std::list<std::string>::iterator lru_pos;
+  };
+  struct Group {
+    std::string tag;
+    std::unordered_set<std::string> keys;
+  };
+  struct Fill {
+    std::string group;
+    std::string tag;
+    std::string key;
+    ceph::bufferlist bl;
+  };
+  struct Read {
+    hit_t hit;
+    read_callback_t cb;
+  };
+
+  class Writer : public Thread {
+    RGWDataCache *cache;
+  public:
+    explicit Writer(RGWDataCache *c) : cache(c) {}
+    void *entry() override {
+      cache->writer_entry();
+      return nullptr;
+    }
+  };
+
+  class Reader : public Thread {
+    RGWDataCache *cache;
+  public:
+    explicit Reader(RGWDataCache *c) : cache(c) {}
+    void *entry() override {
+      cache->reader_entry();
+      return nullptr;
+    }
+  };
+
+  std::string file_path(uint64_t id) const;
+  void writer_entry();
+  void reader_entry();
+  int read_file(const hit_t& hit, ceph::bufferlist *bl);
+  // with lock held; collect the ids of removed files in @a removed
+  void remove_entry(const std::string& key, std::vector<uint64_t>& removed);
+  void remove_group(const std::string& group, std::vector<uint64_t>& removed);
+  void unlink_files(const std::vector<uint64_t>& removed);
+
+  CephContext *cct;
+  const config_t conf;
+
+  mutable ceph::mutex lock = ceph::make_mutex("RGWDataCache::lock");
+  ceph::condition_variable cond;
+  std::unordered_map<std::string, Entry> entries;
+  std::unordered_map<std::string, Group> groups;
+  std::list<std::string> lru;   // most recently used first
+  uint64_t size = 0;
+  uint64_t next_id = 0;
+
+  ceph::condition_variable read_cond;
+  std::list<Read> reads;
+  std::list<Fill> fills;
+  uint64_t pending = 0;
+  std::string writing_group;    // group of the fill being written
+  bool writing_cancelled = false;
+  bool stopping = false;
+  Writer writer;
+  std::vector<std::unique_ptr<Reader>> readers;
+};
@@ -15,8 +15,10 @@
 #include "include/random.h"
 #include "rgw_gc_log.h"
 
+#include <algorithm>
 #include <list> // XXX
 #include <sstream>
+#include <thread>
 #include "xxhash.h"
 
 #define dout_context g_ceph_context
@@ -34,6 +36,7 @@ void RGWGC::initialize(CephContext *_cct, RGWRados *_store) {
   max_objs = min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max());
 
   obj_names = new string[max_objs];
+  transitioned_objects_cache = std::vector<std::atomic<bool>>(max_objs);
 
   for (int i = 0; i < max_objs; i++) {
     obj_names[i] = gc_oid_prefix;
@@ -41,9 +44,6 @@ void RGWGC::initialize(CephContext *_cct, RGWRados *_store) {
     snprintf(buf, 32, ".%d", i);
     obj_names[i].append(buf);
 
-    auto it = transitioned_objects_cache.begin() + i;
-    transitioned_objects_cache.insert(it, false);
-
     //version = 0 -> not ready for transition
     //version = 1 -> marked ready for transition
     librados::ObjectWriteOperation op;
@@ -168,19 +168,12 @@ int RGWGC::async_defer_chain(const string& tag, const cls_rgw_obj_chain& chain)
   return ret;
 }
 
-int RGWGC::remove(int index, const std::vector<string>& tags, AioCompletion **pc)
+int RGWGC::remove(int index, const std::vector<string>& tags, AioCompletion *c)
 {
   ObjectWriteOperation op;
   cls_rgw_gc_remove(op, tags);
 
-  auto c = librados::Rados::aio_create_completion(nullptr, nullptr);
-  int ret = store->gc_aio_operate(obj_names[index], c, &op);
-  if (ret < 0) {
-    c->release();
-  } else {
-    *pc = c;
-  }
-  return ret;
+  return store->gc_aio_operate(obj_names[index], c, &op);
 }
 
 int RGWGC::remove(int index, int num_entries)
@@ -301,6 +294,50 @@ class RGWGCIOManager {
     string tag;
   };
 
+  /* completions hold a reference on the waiter rather than on the manager,
+   * so one that fires after we gave up on it while going down is harmless
+   */
+  struct Waiter {
+    ceph::mutex lock = ceph::make_mutex("RGWGCIOManager::Waiter");
+    ceph::condition_variable cond;
+  };
+  std::shared_ptr<Waiter> waiter = std::make_shared<Waiter>();
+
+  static void io_complete(librados::completion_t, void *arg) {
+    std::unique_ptr<std::shared_ptr<Waiter>> w{static_cast<std::shared_ptr<Waiter>*>(arg)};
+    std::lock_guard l{(*w)->lock};
+    (*w)->cond.notify_all();
+  }
+
+  template <typename Submit>
+  int submit(Submit&& f, librados::AioCompletion **pc) {
+    auto ref = std::make_unique<std::shared_ptr<Waiter>>(waiter);
+    auto c = librados::Rados::aio_create_completion(ref.get(), io_complete);
+    int ret = f(c);
+    if (ret < 0) {
+      c->release();
+      return ret;
+    }
+    ref.release(); // io_complete() frees it
+    *pc = c;
+    return 0;
+  }
+
+  /* returns the first io that has completed, not necessarily the oldest, so
+   * one slow osd doesn't hold up the rest of the window
+   */
+  deque<IO>::iterator wait_for_any() {
+    std::unique_lock l{waiter->lock};
+    for (;;) {
+      auto it = std::find_if(ios.begin(), ios.end(),
+                             [](const IO& io) { return io.c->is_complete(); });
+      if (it != ios.end()) {
+        return it;
+      }
+      waiter->cond.wait(l);
+    }
+  }
+
   deque<IO> ios;
   vector<std::vector<string> > remove_tags;
   /* tracks the number of remaining shadow objects for a given tag in order to
@@ -311,6 +348,8 @@ class RGWGCIOManager {
 #define MAX_AIO_DEFAULT 10
   size_t max_aio{MAX_AIO_DEFAULT};
 
+  uint64_t num_tails{0};
+
 public:
   RGWGCIOManager(const DoutPrefixProvider* _dpp, CephContext *_cct, RGWGC *_gc) : dpp(_dpp),
                                                   cct(_cct),
@@ -339,8 +378,10 @@ public:
       }
     }
 
-    auto c = librados::Rados::aio_create_completion(nullptr, nullptr);
-    int ret = ioctx->aio_operate(oid, c, op);
+    librados::AioCompletion *c;
+    int ret = submit([&](librados::AioCompletion *c) {
+                       return ioctx->aio_operate(oid, c, op);
+                     }, &c);
     if (ret < 0) {
       return ret;
     }
@@ -351,8 +392,9 @@ public:
 
   int handle_next_completion() {
     ceph_assert(!ios.empty());
-    IO& io = ios.front();
-    io.c->wait_for_complete();
+    auto it = wait_for_any();
+    IO io = std::move(*it);
+    ios.erase(it);
     int ret = io.c->get_return_value();
     io.c->release();
 
@@ -371,15 +413,22 @@ public:
     if (ret < 0) {
       ldpp_dout(dpp, 0) << "WARNING: gc could not remove oid=" << io.oid <<
 	", ret=" << ret << dendl;
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_gc_tail_fail);
+      }
       goto done;
     }
 
+    ++num_tails;
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_gc_tail_remove);
+    }
+
     if (! gc->transitioned_objects_cache[io.index]) {
       schedule_tag_removal(io.index, io.tag);
     }
 
   done:
-    ios.pop_front();
     return ret;
   }
 
@@ -452,7 +501,9 @@ public:
 	}
       );
 
-    int ret = gc->remove(index, rt, &index_io.c);
+    int ret = submit([&](librados::AioCompletion *c) {
+                       return gc->remove(index, rt, c);
+                     }, &index_io.c);
     if (ret < 0) {
       /* we already cleared list of tags, this prevents us from
        * ballooning in case of a persistent problem
@@ -491,6 +542,8 @@ public:
     }
     return 0;
   }
+
+  uint64_t get_num_tails() const { return num_tails; }
 }; // class RGWGCIOManger
 
 int RGWGC::process(int index, int max_secs, bool expired_only,
@@ -528,7 +581,7 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
   bool truncated;
   IoCtx *ctx = new IoCtx;
   do {
-    int max = 100;
+    const int max = cct->_conf.get_val<int64_t>("rgw_gc_list_batch_size");
     std::list<cls_rgw_gc_obj_info> entries;
 
     int ret = 0;
@@ -676,18 +729,48 @@ int RGWGC::process(bool expired_only)
   int max_secs = cct->_conf->rgw_gc_processor_max_time;
 
   const int start = ceph::util::generate_random_number(0, max_objs - 1);
+  const int64_t concurrency = std::clamp<int64_t>(
+    cct->_conf.get_val<int64_t>("rgw_gc_max_concurrent_shards"), 1, max_objs);
 
-  RGWGCIOManager io_manager(this, store->ctx(), this);
+  /* each thread takes the next unprocessed shard and keeps its own window
+   * of rgw_gc_max_concurrent_io ios in flight
+   */
+  std::atomic<int> next{0};
+  std::atomic<int> error{0};
+  std::atomic<uint64_t> num_tails{0};
+  auto process_shards = [&] {
+    RGWGCIOManager io_manager(this, store->ctx(), this);
+    for (int i = next++; i < max_objs && !error; i = next++) {
+      int index = (i + start) % max_objs;
+      int ret = process(index, max_secs, expired_only, io_manager);
+      if (ret < 0) {
+        int expected = 0;
+        error.compare_exchange_strong(expected, ret);
+        return;
+      }
+    }
+    if (!going_down()) {
+      io_manager.drain();
+    }
+    num_tails += io_manager.get_num_tails();
+  };
 
-  for (int i = 0; i < max_objs; i++) {
-    int index = (i + start) % max_objs;
-    int ret = process(index, max_secs, expired_only, io_manager);
-    if (ret < 0)
-      return ret;
+  auto start_time = ceph::mono_clock::now();
+  std::vector<std::thread> threads;
+  for (int64_t i = 1; i < concurrency; ++i) {
+    threads.push_back(make_named_thread("gc_shard", process_shards));
   }
-  if (!going_down()) {
-    io_manager.drain();
+  process_shards();
+  for (auto& t : threads) {
+    t.join();
   }
+  if (error) {
+    return error;
+  }
+
+  auto elapsed = std::chrono::duration<double>(ceph::mono_clock::now() - start_time).count();
+  ldpp_dout(this, 2) << "RGWGC::process removed " << num_tails << " tail objects in "
+    << elapsed << "s (" << (elapsed > 0 ? num_tails / elapsed : 0) << " objs/s)" << dendl;
 
   return 0;
 }
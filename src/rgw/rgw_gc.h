@@ -50,7 +50,7 @@ public:
     stop_processor();
     finalize();
   }
-  vector<bool> transitioned_objects_cache;
+  std::vector<std::atomic<bool>> transitioned_objects_cache;
   int send_chain(cls_rgw_obj_chain& chain, const string& tag);
 
   // asynchronously defer garbage collection on an object that's still being read
@@ -59,7 +59,7 @@ public:
   // callback for when async_defer_chain() fails with ECANCELED
   void on_defer_canceled(const cls_rgw_gc_obj_info& info);
 
-  int remove(int index, const std::vector<string>& tags, librados::AioCompletion **pc);
+  int remove(int index, const std::vector<string>& tags, librados::AioCompletion *c);
   int remove(int index, int num_entries);
 
   void initialize(CephContext *_cct, RGWRados *_store);
@@ -438,6 +438,10 @@ public:
     list_params.prefix = prefix;
   }
 
+  void set_shard(int shard_id) {
+    list_params.shard_id = shard_id;
+  }
+
   int init(const DoutPrefixProvider *dpp) {
     return fetch(dpp);
   }
@@ -558,6 +562,8 @@ struct lc_op_ctx {
 
 }; /* lc_op_ctx */
 
+static bool queue_expired_obj(lc_op_ctx& oc);
+
 static int remove_expired_obj(const DoutPrefixProvider *dpp, lc_op_ctx& oc, bool remove_indeed)
 {
   auto& store = oc.store;
@@ -690,9 +696,20 @@ private:
   vector<WorkItem> items;
   work_f f;
 
+  /* expired objects of one bucket, removed together by flush_expired().
+   * only touched by this thread */
+  struct {
+    rgw::sal::RGWRadosStore* store{nullptr};
+    rgw::sal::RGWBucket* bucket{nullptr};
+    std::vector<rgw_bucket_dir_entry> entries;
+  } expired;
+  size_t expire_batch_max;
+
 public:
   WorkQ(RGWLC::LCWorker* wk, uint32_t ix, uint32_t qmax)
-    : wk(wk), qmax(qmax), ix(ix), flags(FLAG_NONE), f(bsf)
+    : wk(wk), qmax(qmax), ix(ix), flags(FLAG_NONE), f(bsf),
+      expire_batch_max(wk->cct->_conf.get_val<int64_t>(
+			 "rgw_lc_delete_batch_size"))
     {
       create(thr_name().c_str());
     }
@@ -728,11 +745,68 @@ public:
     }
   }
 
+  /* returns false if the object has to be removed on its own */
+  bool add_expired(lc_op_ctx& oc) {
+    if (expire_batch_max <= 1) {
+      return false;
+    }
+    if (expired.bucket != oc.bucket) {
+      flush_expired();
+      expired.store = oc.store;
+      expired.bucket = oc.bucket;
+    }
+    expired.entries.push_back(oc.o);
+    if (expired.entries.size() >= expire_batch_max) {
+      flush_expired();
+    }
+    return true;
+  }
+
 private:
+  void flush_expired() {
+    if (expired.entries.empty()) {
+      return;
+    }
+    auto dpp = wk->get_lc();
+    RGWObjectCtx rctx(expired.store);
+    uint64_t deleted = 0;
+    auto start = ceph::mono_clock::now();
+    int r = expired.store->getRados()->delete_objs_bulk(
+      dpp, rctx, expired.bucket->get_info(), expired.entries, &deleted,
+      null_yield);
+    auto latency = ceph::mono_clock::now() - start;
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: delete_objs_bulk() " << expired.bucket
+			<< " " << cpp_strerror(r) << " " << thr_name()
+			<< dendl;
+    }
+    ldpp_dout(dpp, 2) << "DELETED: " << deleted << " of "
+		      << expired.entries.size() << " objects from "
+		      << expired.bucket << " in " << latency << " "
+		      << thr_name() << dendl;
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_lc_expire_current, deleted);
+      perfcounter->inc(l_rgw_lc_delete_batch, 1);
+    }
+    expired.entries.clear();
+
+    wk->update_pace(latency);
+    if (uint32_t pace = wk->pace_ms; pace > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(pace));
+    }
+  }
+
   dequeue_result dequeue() {
     unique_lock uniq(mtx);
     while ((!wk->get_lc()->going_down()) &&
 	   (items.size() == 0)) {
+      /* out of work, remove what we have batched up */
+      if (!expired.entries.empty()) {
+	uniq.unlock();
+	flush_expired();
+	uniq.lock();
+	continue;
+      }
       /* clear drain state, as we are NOT doing work and qlen==0 */
       if (flags & FLAG_EDRAIN_SYNC) {
 	flags &= ~FLAG_EDRAIN_SYNC;
@@ -765,11 +839,16 @@ private:
   }
 }; /* WorkQ */
 
+static bool queue_expired_obj(lc_op_ctx& oc)
+{
+  return oc.wq->add_expired(oc);
+}
+
 class RGWLC::WorkPool
 {
   using TVector = ceph::containers::tiny_vector<WorkQ, 3>;
   TVector wqs;
-  uint64_t ix;
+  std::atomic<uint64_t> ix;
 
 public:
   WorkPool(RGWLC::LCWorker* wk, uint16_t n_threads, uint32_t qmax)
@@ -794,8 +873,7 @@ public:
   }
 
   void enqueue(WorkItem item) {
-    const auto tix = ix;
-    ix = (ix+1) % wqs.size();
+    const auto tix = ix++ % wqs.size();
     (wqs[tix]).enqueue(std::move(item));
   }
 
@@ -814,6 +892,30 @@ RGWLC::LCWorker::LCWorker(const DoutPrefixProvider* dpp, CephContext *cct,
   workpool = new WorkPool(this, wpw, 512);
 }
 
+/* back off while deletes are slower than rgw_lc_delete_latency_target,
+ * which is taken as a sign that the cluster is busy, and speed up again
+ * once they are faster */
+void RGWLC::LCWorker::update_pace(ceph::timespan batch_latency)
+{
+  static constexpr uint32_t max_pace_ms = 1000;
+  auto target = std::chrono::milliseconds(
+    cct->_conf.get_val<int64_t>("rgw_lc_delete_latency_target"));
+  uint32_t pace = pace_ms;
+  if (target.count() <= 0) {
+    pace = 0;
+  } else if (batch_latency > target) {
+    pace = std::min(std::max(pace * 2, 1u), max_pace_ms);
+  } else {
+    pace /= 2;
+  }
+  if (pace != pace_ms) {
+    ldpp_dout(dpp, 10) << "LC: worker " << ix << " delete batch took "
+		       << batch_latency << ", pacing at " << pace << "ms"
+		       << dendl;
+    pace_ms = pace;
+  }
+}
+
 static inline bool worker_should_stop(time_t stop_at, bool once)
 {
   return !once && stop_at < time(nullptr);
@@ -1085,6 +1187,10 @@ public:
 		       << " " << oc.wq->thr_name() << dendl;
     } else {
       /* ! o.is_delete_marker() */
+      if (!oc.bucket->versioned() && queue_expired_obj(oc)) {
+	/* removed later, together with other expired objects */
+	return 0;
+      }
       r = remove_expired_obj(oc.dpp, oc, !oc.bucket->versioned());
       if (r < 0) {
 	ldout(oc.cct, 0) << "ERROR: remove_expired_obj "
@@ -1506,6 +1612,8 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
 
   rgw_obj_key pre_marker;
   rgw_obj_key next_marker;
+  std::atomic<uint64_t> num_listed{0};
+  const auto process_start = ceph::mono_clock::now();
   for(auto prefix_iter = prefix_map.begin(); prefix_iter != prefix_map.end();
       ++prefix_iter) {
 
@@ -1530,29 +1638,78 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
       pre_marker = next_marker;
     }
 
-    LCObjsLister ol(store, bucket.get());
-    ol.set_prefix(prefix_iter->first);
-
-    ret = ol.init(this);
-    if (ret < 0) {
-      if (ret == (-ENOENT))
-        return 0;
-      ldpp_dout(this, 0) << "ERROR: store->list_objects():" <<dendl;
-      return ret;
+    /* list the index shards in parallel, each feeding the workpool */
+    const uint32_t num_shards = std::max(
+      bucket->get_info().layout.current_index.layout.normal.num_shards, 1u);
+    std::vector<std::unique_ptr<LCObjsLister>> listers;
+    for (uint32_t i = 0; i < num_shards; ++i) {
+      auto& ol = listers.emplace_back(
+	std::make_unique<LCObjsLister>(store, bucket.get()));
+      ol->set_prefix(prefix_iter->first);
+      if (num_shards > 1) {
+	ol->set_shard(i);
+      }
     }
 
-    op_env oenv(op, store, worker, bucket.get(), ol);
-    LCOpRule orule(oenv);
-    orule.build(); // why can't ctor do it?
-    rgw_bucket_dir_entry* o{nullptr};
-    for (; ol.get_obj(this, &o /* , fetch_barrier */); ol.next()) {
-      orule.update();
-      std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
-      worker->workpool->enqueue(WorkItem{t1});
+    std::atomic<uint32_t> next_shard{0};
+    std::atomic<int> list_ret{0};
+    auto list_shards = [&] {
+      for (uint32_t i = next_shard++; i < num_shards; i = next_shard++) {
+	if (going_down()) {
+	  return;
+	}
+	auto& ol = *listers[i];
+	int r = ol.init(this);
+	if (r < 0) {
+	  if (r != -ENOENT) {
+	    ldpp_dout(this, 0) << "ERROR: store->list_objects(): shard " << i
+			       << " ret=" << r << dendl;
+	    list_ret = r;
+	  }
+	  continue;
+	}
+
+	op_env oenv(op, store, worker, bucket.get(), ol);
+	LCOpRule orule(oenv);
+	orule.build(); // why can't ctor do it?
+	rgw_bucket_dir_entry* o{nullptr};
+	uint64_t count = 0;
+	for (; ol.get_obj(this, &o /* , fetch_barrier */); ol.next()) {
+	  orule.update();
+	  std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
+	  worker->workpool->enqueue(WorkItem{t1});
+	  ++count;
+	}
+	num_listed += count;
+	if (perfcounter) {
+	  perfcounter->inc(l_rgw_lc_processed, count);
+	}
+      }
+    };
+
+    const auto list_concurrency = std::clamp<int64_t>(
+      cct->_conf.get_val<int64_t>("rgw_lc_list_concurrency"), 1, num_shards);
+    std::vector<std::thread> list_threads;
+    for (int64_t i = 1; i < list_concurrency; ++i) {
+      list_threads.push_back(make_named_thread("lc_list", list_shards));
+    }
+    list_shards();
+    for (auto& t : list_threads) {
+      t.join();
     }
     worker->workpool->drain();
+    if (list_ret < 0) {
+      return list_ret;
+    }
   }
 
+  auto elapsed = std::chrono::duration<double>(
+    ceph::mono_clock::now() - process_start).count();
+  ldpp_dout(this, 5) << __func__ << "(): " << bucket_name << " evaluated "
+		     << num_listed.load() << " objects in " << elapsed << "s ("
+		     << (elapsed > 0 ? num_listed / elapsed : 0) << " objs/s)"
+		     << dendl;
+
   ret = handle_multipart_expiration(bucket.get(), prefix_map, worker, stop_at, once);
   return ret;
 }
@@ -481,6 +481,8 @@ public:
     std::mutex lock;
     std::condition_variable cond;
     WorkPool* workpool{nullptr};
+    /* ms to wait after each batch of deletes, adjusted by update_pace() */
+    std::atomic<uint32_t> pace_ms{0};
 
   public:
 
@@ -494,6 +496,7 @@ public:
     void stop();
     bool should_work(utime_t& now);
     int schedule_next_start_time(utime_t& start, utime_t& now);
+    void update_pace(ceph::timespan batch_latency);
     ~LCWorker();
 
     friend class RGWRados;
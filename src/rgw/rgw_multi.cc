@@ -200,6 +200,136 @@ int list_multipart_parts(rgw::sal::RGWRadosStore *store, struct req_state *s,
 			      next_marker, truncated, assume_unsorted);
 }
 
+static string part_key(int num)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "part.%08d", num);
+  return buf;
+}
+
+int RGWMultipartPartsReader::init()
+{
+  if (!is_v2_upload_id(upload_id)) {
+    return 0;
+  }
+
+  rgw_obj obj;
+  obj.init_ns(bucket_info.bucket, meta_oid, RGW_OBJ_NS_MULTIPART);
+  obj.set_in_extra_data(true);
+
+  rgw_raw_obj raw_obj;
+  store->getRados()->obj_to_raw(bucket_info.placement_rule, obj, &raw_obj);
+
+  rgw_rados_ref ref;
+  int ret = store->getRados()->get_raw_obj_ref(raw_obj, &ref);
+  if (ret < 0) {
+    return ret;
+  }
+  ioctx = ref.pool.ioctx();
+  oid = ref.obj.oid;
+  read_ahead = true;
+
+  while (next_batch < num_batches && reads.size() < max_aio) {
+    ret = issue(next_batch++);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+int RGWMultipartPartsReader::issue(int batch)
+{
+  auto read = std::make_unique<Read>();
+  librados::ObjectReadOperation op;
+  op.omap_get_vals2(part_key(batch * batch_size), batch_size + 1,
+                    &read->vals, &read->more, &read->rval);
+  read->c = librados::Rados::aio_create_completion(nullptr, nullptr);
+  int ret = ioctx.aio_operate(oid, read->c, &op, nullptr);
+  if (ret < 0) {
+    read->c->release();
+    return ret;
+  }
+  reads.push_back(std::move(read));
+  return 0;
+}
+
+void RGWMultipartPartsReader::cancel()
+{
+  /* the completions write into the reads, so they can't go before them */
+  for (auto& read : reads) {
+    read->c->wait_for_complete();
+    read->c->release();
+  }
+  reads.clear();
+  read_ahead = false;
+}
+
+int RGWMultipartPartsReader::next(map<uint32_t, RGWUploadPartInfo>& parts,
+                                  bool *truncated)
+{
+  if (!read_ahead || reads.empty()) {
+    /* past the parts the client listed, or not a sorted upload */
+    cancel();
+    return list_multipart_parts(store, bucket_info, cct, upload_id, meta_oid,
+                                batch_size, marker, parts, &marker, truncated);
+  }
+
+  auto read = std::move(reads.front());
+  reads.pop_front();
+  read->c->wait_for_complete();
+  int ret = read->c->get_return_value();
+  read->c->release();
+  if (ret == 0) {
+    ret = read->rval;
+  }
+  if (ret < 0) {
+    cancel();
+    return ret;
+  }
+
+  if (next_batch < num_batches) {
+    ret = issue(next_batch++);
+    if (ret < 0) {
+      cancel();
+      return ret;
+    }
+  }
+
+  parts.clear();
+  uint32_t expected_next = marker + 1;
+  int i = 0;
+  auto iter = read->vals.begin();
+  for (; i < batch_size && iter != read->vals.end(); ++iter, ++i) {
+    RGWUploadPartInfo info;
+    try {
+      auto bli = iter->second.cbegin();
+      decode(info, bli);
+    } catch (buffer::error& err) {
+      ldout(cct, 0) << "ERROR: could not part info, caught buffer::error" <<
+	dendl;
+      cancel();
+      return -EIO;
+    }
+    if (info.num != expected_next) {
+      /* the batches were laid out for parts 1..N, which this upload doesn't
+       * have; let list_multipart_parts() sort it out from here */
+      cancel();
+      return list_multipart_parts(store, bucket_info, cct, upload_id, meta_oid,
+                                  batch_size, marker, parts, &marker,
+                                  truncated, true);
+    }
+    ++expected_next;
+    parts[info.num] = std::move(info);
+  }
+
+  *truncated = (iter != read->vals.end()) || read->more;
+  if (!parts.empty()) {
+    marker = parts.rbegin()->first;
+  }
+  return 0;
+}
+
 int abort_multipart_upload(const DoutPrefixProvider *dpp,
                            rgw::sal::RGWRadosStore *store, CephContext *cct,
 			   RGWObjectCtx *obj_ctx, RGWBucketInfo& bucket_info,
@@ -4,7 +4,11 @@
 #ifndef CEPH_RGW_MULTI_H
 #define CEPH_RGW_MULTI_H
 
+#include <algorithm>
+#include <deque>
 #include <map>
+#include <memory>
+#include "include/rados/librados.hpp"
 #include "rgw_xml.h"
 #include "rgw_obj_manifest.h"
 #include "rgw_compression_types.h"
@@ -123,6 +127,53 @@ extern int list_multipart_parts(rgw::sal::RGWRadosStore *store, struct req_state
                                 int *next_marker, bool *truncated,
                                 bool assume_unsorted = false);
 
+/* Reads the parts of an upload in batches of @batch_size for its completion.
+ * The omap keys of v2 uploads sort by part number, so as long as the parts
+ * are numbered 1..N the key range of every batch is known up front, and up
+ * to @max_aio batches are read ahead while the caller works on the current
+ * one. Anything else is read through list_multipart_parts(). */
+class RGWMultipartPartsReader {
+  struct Read {
+    librados::AioCompletion *c{nullptr};
+    std::map<string, bufferlist> vals;
+    bool more{false};
+    int rval{0};
+  };
+
+  rgw::sal::RGWRadosStore *store;
+  RGWBucketInfo& bucket_info;
+  CephContext *cct;
+  const string upload_id;
+  const string meta_oid;
+  const int batch_size;
+  const size_t max_aio;
+  const int num_batches;
+
+  librados::IoCtx ioctx;
+  string oid;
+  bool read_ahead = false;
+  int next_batch = 0; /* the next batch to issue a read for */
+  int marker = 0;
+  std::deque<std::unique_ptr<Read>> reads;
+
+  int issue(int batch);
+  void cancel();
+
+public:
+  RGWMultipartPartsReader(rgw::sal::RGWRadosStore *store,
+                          RGWBucketInfo& bucket_info, CephContext *cct,
+                          const string& upload_id, const string& meta_oid,
+                          int batch_size, size_t max_aio, int expected_parts)
+    : store(store), bucket_info(bucket_info), cct(cct),
+      upload_id(upload_id), meta_oid(meta_oid),
+      batch_size(batch_size), max_aio(std::max<size_t>(max_aio, 1)),
+      num_batches((expected_parts + batch_size - 1) / batch_size) {}
+  ~RGWMultipartPartsReader() { cancel(); }
+
+  int init();
+  int next(map<uint32_t, RGWUploadPartInfo>& parts, bool *truncated);
+};
+
 extern int abort_multipart_upload(const DoutPrefixProvider *dpp, rgw::sal::RGWRadosStore *store, CephContext *cct, RGWObjectCtx *obj_ctx,
                                 RGWBucketInfo& bucket_info, RGWMPObj& mp_obj);
 
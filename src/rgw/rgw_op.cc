@@ -5934,7 +5934,6 @@ void RGWCompleteMultipart::execute(optional_yield y)
   int total_parts = 0;
   int handled_parts = 0;
   int max_parts = 1000;
-  int marker = 0;
   bool truncated;
   RGWCompressionInfo cs_info;
   bool compressed = false;
@@ -5975,9 +5974,19 @@ void RGWCompleteMultipart::execute(optional_yield y)
   }
   attrs = meta_obj->get_attrs();
 
+  RGWMultipartPartsReader parts_reader(store, s->bucket->get_info(), s->cct,
+    upload_id, meta_oid, max_parts,
+    s->cct->_conf.get_val<int64_t>("rgw_multipart_complete_max_aio"),
+    parts->parts.size());
+  op_ret = parts_reader.init();
+  if (op_ret < 0) {
+    ldpp_dout(this, 0) << "ERROR: failed to read parts of upload " << upload_id
+		     << " ret=" << op_ret << dendl;
+    return;
+  }
+
   do {
-    op_ret = list_multipart_parts(store, s, upload_id, meta_oid, max_parts,
-				  marker, obj_parts, &marker, &truncated);
+    op_ret = parts_reader.next(obj_parts, &truncated);
     if (op_ret == -ENOENT) {
       op_ret = -ERR_NO_SUCH_UPLOAD;
     }
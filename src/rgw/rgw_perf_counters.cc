@@ -21,6 +21,9 @@ int rgw_perf_start(CephContext *cct)
   plb.add_u64_counter(l_rgw_get, "get", "Gets");
   plb.add_u64_counter(l_rgw_get_b, "get_b", "Size of gets");
   plb.add_time_avg(l_rgw_get_lat, "get_initial_lat", "Get latency");
+  plb.add_u64_avg(l_rgw_get_obj_rate, "get_obj_rate", "Rate of reads from RADOS per get (bytes/sec)");
+  plb.add_u64_avg(l_rgw_get_obj_window, "get_obj_window", "Adaptive read window size at the end of a get");
+  plb.add_u64_avg(l_rgw_put_obj_window, "put_obj_window", "Adaptive write window size at the end of a put");
   plb.add_u64_counter(l_rgw_put, "put", "Puts");
   plb.add_u64_counter(l_rgw_put_b, "put_b", "Size of puts");
   plb.add_time_avg(l_rgw_put_lat, "put_initial_lat", "Put latency");
@@ -31,10 +34,24 @@ int rgw_perf_start(CephContext *cct)
   plb.add_u64_counter(l_rgw_cache_hit, "cache_hit", "Cache hits");
   plb.add_u64_counter(l_rgw_cache_miss, "cache_miss", "Cache miss");
 
+  plb.add_u64_counter(l_rgw_datacache_hit, "datacache_hit", "Data cache hits");
+  plb.add_u64_counter(l_rgw_datacache_miss, "datacache_miss", "Data cache misses");
+  plb.add_u64_counter(l_rgw_datacache_hit_b, "datacache_hit_b", "Bytes read from the data cache");
+  plb.add_u64_counter(l_rgw_datacache_miss_b, "datacache_miss_b", "Bytes read from RADOS on data cache misses");
+  plb.add_u64_counter(l_rgw_datacache_evict, "datacache_evict", "Data cache evictions");
+  plb.add_u64_counter(l_rgw_datacache_drop, "datacache_drop", "Data cache fills dropped while the writer was behind");
+  plb.add_u64(l_rgw_datacache_size, "datacache_size", "Bytes in the data cache");
+
+  plb.add_u64_counter(l_rgw_bucket_list_read, "bucket_list_read", "Index entries read by ordered bucket listings");
+  plb.add_u64_counter(l_rgw_bucket_list_returned, "bucket_list_returned", "Index entries returned by ordered bucket listings");
+  plb.add_u64_counter(l_rgw_bucket_list_refill, "bucket_list_refill", "Index shard reads issued to refill an ordered bucket listing");
+
   plb.add_u64_counter(l_rgw_keystone_token_cache_hit, "keystone_token_cache_hit", "Keystone token cache hits");
   plb.add_u64_counter(l_rgw_keystone_token_cache_miss, "keystone_token_cache_miss", "Keystone token cache miss");
 
   plb.add_u64_counter(l_rgw_gc_retire, "gc_retire_object", "GC object retires");
+  plb.add_u64_counter(l_rgw_gc_tail_remove, "gc_tail_remove", "GC tail objects removed");
+  plb.add_u64_counter(l_rgw_gc_tail_fail, "gc_tail_fail", "GC tail object removals that failed");
 
   plb.add_u64_counter(l_rgw_lc_expire_current, "lc_expire_current",
 		      "Lifecycle current expiration");
@@ -49,6 +66,10 @@ int rgw_perf_start(CephContext *cct)
 		      "Lifecycle non-current transition");
   plb.add_u64_counter(l_rgw_lc_abort_mpu, "lc_abort_mpu",
 		      "Lifecycle abort multipart upload");
+  plb.add_u64_counter(l_rgw_lc_processed, "lc_processed",
+		      "Lifecycle objects evaluated");
+  plb.add_u64_counter(l_rgw_lc_delete_batch, "lc_delete_batch",
+		      "Lifecycle batches of expired objects removed");
 
   plb.add_u64_counter(l_rgw_pubsub_event_triggered, "pubsub_event_triggered", "Pubsub events with at least one topic");
   plb.add_u64_counter(l_rgw_pubsub_event_lost, "pubsub_event_lost", "Pubsub events lost");
@@ -17,6 +17,9 @@ enum {
   l_rgw_get,
   l_rgw_get_b,
   l_rgw_get_lat,
+  l_rgw_get_obj_rate,
+  l_rgw_get_obj_window,
+  l_rgw_put_obj_window,
 
   l_rgw_put,
   l_rgw_put_b,
@@ -28,10 +31,24 @@ enum {
   l_rgw_cache_hit,
   l_rgw_cache_miss,
 
+  l_rgw_datacache_hit,
+  l_rgw_datacache_miss,
+  l_rgw_datacache_hit_b,
+  l_rgw_datacache_miss_b,
+  l_rgw_datacache_evict,
+  l_rgw_datacache_drop,
+  l_rgw_datacache_size,
+
+  l_rgw_bucket_list_read,
+  l_rgw_bucket_list_returned,
+  l_rgw_bucket_list_refill,
+
   l_rgw_keystone_token_cache_hit,
   l_rgw_keystone_token_cache_miss,
 
   l_rgw_gc_retire,
+  l_rgw_gc_tail_remove,
+  l_rgw_gc_tail_fail,
 
   l_rgw_lc_expire_current,
   l_rgw_lc_expire_noncurrent,
@@ -39,6 +56,8 @@ enum {
   l_rgw_lc_transition_current,
   l_rgw_lc_transition_noncurrent,
   l_rgw_lc_abort_mpu,
+  l_rgw_lc_processed,
+  l_rgw_lc_delete_batch,
 
   l_rgw_pubsub_event_triggered,
   l_rgw_pubsub_event_lost,
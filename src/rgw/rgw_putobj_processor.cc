@@ -19,6 +19,7 @@
 #include "rgw_compression.h"
 #include "services/svc_sys_obj.h"
 #include "rgw_sal_rados.h"
+#include "rgw_perf_counters.h"
 
 #define dout_subsys ceph_subsys_rgw
 
@@ -74,6 +75,41 @@ static int process_completed(const AioResultList& completed, RawObjSet *written)
   return error.value_or(0);
 }
 
+void RadosWriter::init_window()
+{
+  auto cct = store->ctx();
+  const uint64_t min = cct->_conf->rgw_put_obj_min_window_size;
+  const uint64_t max = cct->_conf->rgw_put_obj_max_window_size;
+  start = ceph::mono_clock::now();
+  if (max > min) {
+    window.emplace(min, max, start);
+  }
+}
+
+void RadosWriter::update_window(const AioResultList& completed)
+{
+  if (completed.empty()) {
+    return;
+  }
+  const auto now = ceph::mono_clock::now();
+  for (auto& r : completed) {
+    auto s = submitted.find(r.id);
+    if (s == submitted.end()) {
+      continue;
+    }
+    if (r.result >= 0) {
+      bytes_written += s->second.bytes;
+      if (window) {
+        window->complete(s->second.bytes, now - s->second.time, now);
+      }
+    }
+    submitted.erase(s);
+  }
+  if (window) {
+    aio->set_window(window->get());
+  }
+}
+
 int RadosWriter::set_stripe_obj(const rgw_raw_obj& raw_obj)
 {
   stripe_obj = store->svc()->rados->obj(raw_obj);
@@ -93,8 +129,17 @@ int RadosWriter::process(bufferlist&& bl, uint64_t offset)
   } else {
     op.write(offset, data);
   }
-  constexpr uint64_t id = 0; // unused
-  auto c = aio->get(stripe_obj, Aio::librados_op(std::move(op), y), cost, id);
+  // note when the write is actually sent, after any wait for the window
+  const uint64_t id = next_id++;
+  auto& s = submitted[id];
+  s.bytes = cost;
+  auto write = [&s, f = Aio::librados_op(std::move(op), y)]
+    (Aio* aio, AioResult& r) mutable {
+      s.time = ceph::mono_clock::now();
+      std::move(f)(aio, r);
+    };
+  auto c = aio->get(stripe_obj, std::move(write), cost, id);
+  update_window(c);
   return process_completed(c, &written);
 }
 
@@ -106,16 +151,29 @@ int RadosWriter::write_exclusive(const bufferlist& data)
   op.create(true); // exclusive create
   op.write_full(data);
 
-  constexpr uint64_t id = 0; // unused
+  const uint64_t id = next_id++; // not measured
   auto c = aio->get(stripe_obj, Aio::librados_op(std::move(op), y), cost, id);
   auto d = aio->drain();
   c.splice(c.end(), d);
+  update_window(c);
   return process_completed(c, &written);
 }
 
 int RadosWriter::drain()
 {
-  return process_completed(aio->drain(), &written);
+  auto c = aio->drain();
+  update_window(c);
+  if (window && bytes_written) {
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_put_obj_window, window->get());
+    }
+    const double elapsed = std::chrono::duration<double>(ceph::mono_clock::now() - start).count();
+    ldpp_dout(dpp, 20) << "wrote " << bytes_written << " bytes at "
+        << (elapsed > 0 ? uint64_t(bytes_written / elapsed) : 0)
+        << " B/s, write latency " << window->get_latency()
+        << "s, final window " << window->get() << dendl;
+  }
+  return process_completed(c, &written);
 }
 
 RadosWriter::~RadosWriter()
@@ -183,6 +241,17 @@ int ManifestObjectProcessor::next(uint64_t offset, uint64_t *pstripe_size)
   if (r < 0) {
     return r;
   }
+  // tail stripes aren't limited by the head's atomic write size, so larger
+  // stripes of a streaming upload can be written in fewer ops. keep the
+  // write size a multiple of the chunk size to preserve pool alignment, and
+  // within the smallest window so the throttle can always admit it
+  auto cct = store->ctx();
+  const uint64_t max_write_size = std::min<uint64_t>(
+    cct->_conf.get_val<Option::size_t>("rgw_put_obj_max_write_size"),
+    cct->_conf->rgw_put_obj_min_window_size);
+  if (chunk_size && max_write_size > chunk_size) {
+    chunk_size = max_write_size / chunk_size * chunk_size;
+  }
   r = writer.set_stripe_obj(stripe_obj);
   if (r < 0) {
     return r;
@@ -15,9 +15,11 @@
 
 #pragma once
 
+#include <map>
 #include <optional>
 
 #include "rgw_putobj.h"
+#include "rgw_aio_throttle.h"
 #include "services/svc_rados.h"
 #include "services/svc_tier_rados.h"
 #include "rgw_sal.h"
@@ -89,6 +91,21 @@ class RadosWriter : public DataProcessor {
   const DoutPrefixProvider *dpp;
   optional_yield y;
 
+  // resizes the aio window between rgw_put_obj_min_window_size and
+  // rgw_put_obj_max_window_size from the write latency and throughput
+  std::optional<AdaptiveWindow> window;
+  struct Submitted {
+    ceph::mono_time time;
+    uint64_t bytes = 0;
+  };
+  std::map<uint64_t, Submitted> submitted; // id -> write start
+  uint64_t next_id = 0;
+  uint64_t bytes_written = 0;
+  ceph::mono_time start;
+
+  void init_window();
+  void update_window(const AioResultList& completed);
+
  public:
   RadosWriter(Aio *aio, rgw::sal::RGWRadosStore *store,
 	      rgw::sal::RGWBucket* bucket,
@@ -96,11 +113,15 @@ class RadosWriter : public DataProcessor {
               const DoutPrefixProvider *dpp, optional_yield y)
     : aio(aio), store(store), bucket(bucket),
       obj_ctx(obj_ctx), head_obj(std::move(_head_obj)), dpp(dpp), y(y)
-  {}
+  {
+    init_window();
+  }
   RadosWriter(RadosWriter&& r)
     : aio(r.aio), store(r.store), bucket(r.bucket),
       obj_ctx(r.obj_ctx), head_obj(std::move(r.head_obj)), dpp(r.dpp), y(r.y)
-  {}
+  {
+    init_window();
+  }
 
   ~RadosWriter();
 
@@ -24,6 +24,7 @@
 #include "rgw_sal.h"
 #include "rgw_zone.h"
 #include "rgw_cache.h"
+#include "rgw_datacache.h"
 #include "rgw_acl.h"
 #include "rgw_acl_s3.h" /* for dumping s3policy in debug log */
 #include "rgw_aio_throttle.h"
@@ -66,6 +67,7 @@ using namespace librados;
 #include "rgw_lc.h"
 
 #include "rgw_object_expirer_core.h"
+#include "rgw_perf_counters.h"
 #include "rgw_sync.h"
 #include "rgw_sync_counters.h"
 #include "rgw_sync_trace.h"
@@ -1072,6 +1074,12 @@ void RGWRados::finalize()
   delete obj_expirer;
   obj_expirer = NULL;
 
+  if (data_cache) {
+    data_cache->shutdown();
+    delete data_cache;
+    data_cache = nullptr;
+  }
+
   RGWQuotaHandler::free_handler(quota_handler);
   if (cr_registry) {
     cr_registry->put();
@@ -1314,6 +1322,21 @@ int RGWRados::init_complete(const DoutPrefixProvider *dpp)
 
   reshard_wait = std::make_shared<RGWReshardWait>();
 
+  if (use_cache && cct->_conf.get_val<bool>("rgw_datacache_enabled")) {
+    RGWDataCache::config_t dc_conf;
+    dc_conf.path = cct->_conf.get_val<std::string>("rgw_datacache_path");
+    dc_conf.capacity = cct->_conf.get_val<Option::size_t>("rgw_datacache_size");
+    dc_conf.max_pending = cct->_conf.get_val<Option::size_t>("rgw_datacache_max_pending");
+    dc_conf.read_threads = cct->_conf.get_val<uint64_t>("rgw_datacache_read_threads");
+    data_cache = new RGWDataCache(cct, dc_conf);
+    ret = data_cache->init();
+    if (ret < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: failed to initialize data cache in "
+                        << dc_conf.path << dendl;
+      return ret;
+    }
+  }
+
   reshard = new RGWReshard(this->store);
 
   /* only the master zone in the zonegroup reshards buckets */
@@ -3170,6 +3193,10 @@ int RGWRados::Object::Write::_do_write_meta(const DoutPrefixProvider *dpp,
   epoch = ioctx.get_last_version();
   poolid = ioctx.get_id();
 
+  if (auto data_cache = store->get_data_cache(); data_cache) {
+    data_cache->invalidate(ref.obj.oid);
+  }
+
   r = target->complete_atomic_modification();
   if (r < 0) {
     ldout(store->ctx(), 0) << "ERROR: complete_atomic_modification returned r=" << r << dendl;
@@ -5154,6 +5181,9 @@ int RGWRados::Object::Delete::delete_obj(optional_yield y, const DoutPrefixProvi
 
   int64_t poolid = ioctx.get_id();
   if (r >= 0) {
+    if (auto data_cache = store->get_data_cache(); data_cache) {
+      data_cache->invalidate(ref.obj.oid);
+    }
     tombstone_cache_t *obj_tombstone_cache = store->get_tombstone_cache();
     if (obj_tombstone_cache) {
       tombstone_entry entry{*state};
@@ -6316,6 +6346,15 @@ struct get_obj_data {
   rgw::AioResultList completed; // completed read results, sorted by offset
   optional_yield yield;
 
+  RGWDataCache* cache = nullptr;
+  std::string cache_group; // head object the stripes are cached under
+  std::string cache_tag;
+  std::map<uint64_t, std::string> cache_fills; // offset -> stripe key
+
+  std::optional<rgw::AdaptiveWindow> window;
+  std::map<uint64_t, ceph::mono_time> submitted; // offset -> read start
+  uint64_t bytes_read = 0; // from rados
+
   get_obj_data(RGWRados* store, RGWGetDataCB* cb, rgw::Aio* aio,
                uint64_t offset, optional_yield yield)
     : store(store), client_cb(cb), aio(aio), offset(offset), yield(yield) {}
@@ -6326,6 +6365,24 @@ struct get_obj_data {
       return r;
     }
 
+    if (!results.empty()) {
+      auto now = ceph::mono_clock::now();
+      for (auto& e : results) {
+        auto s = submitted.find(e.id);
+        if (s == submitted.end()) {
+          continue; // from the data cache
+        }
+        bytes_read += e.data.length();
+        if (window) {
+          window->complete(e.data.length(), now - s->second, now);
+        }
+        submitted.erase(s);
+      }
+      if (window) {
+        aio->set_window(window->get());
+      }
+    }
+
     auto cmp = [](const auto& lhs, const auto& rhs) { return lhs.id < rhs.id; };
     results.sort(cmp); // merge() requires results to be sorted first
     completed.merge(results, cmp); // merge results in sorted order
@@ -6334,6 +6391,11 @@ struct get_obj_data {
       auto bl = std::move(completed.front().data);
       completed.pop_front_and_dispose(std::default_delete<rgw::AioResultEntry>{});
 
+      if (auto fill = cache_fills.find(offset); fill != cache_fills.end()) {
+        cache->put(cache_group, cache_tag, fill->second, bl);
+        cache_fills.erase(fill);
+      }
+
       offset += bl.length();
       int r = client_cb->handle_data(bl, 0, bl.length());
       if (r < 0) {
@@ -6403,6 +6465,14 @@ int RGWRados::get_obj_iterate_cb(const rgw_raw_obj& read_obj, off_t obj_ofs,
     }
   }
 
+  if (d->cache && d->cache_tag.empty()) {
+    if (astate && astate->obj_tag.length()) {
+      d->cache_tag = astate->obj_tag.to_str();
+    } else {
+      d->cache = nullptr; // can't tell versions apart, don't cache
+    }
+  }
+
   auto obj = d->store->svc.rados->obj(read_obj);
   int r = obj.open();
   if (r < 0) {
@@ -6410,13 +6480,38 @@ int RGWRados::get_obj_iterate_cb(const rgw_raw_obj& read_obj, off_t obj_ofs,
     return r;
   }
 
-  ldout(cct, 20) << "rados->get_obj_iterate_cb oid=" << read_obj.oid << " obj-ofs=" << obj_ofs << " read_ofs=" << read_ofs << " len=" << len << dendl;
   op.read(read_ofs, len, nullptr, nullptr);
 
   const uint64_t cost = len;
   const uint64_t id = obj_ofs; // use logical object offset for sorting replies
 
-  auto completed = d->aio->get(obj, rgw::Aio::librados_op(std::move(op), d->yield), cost, id);
+  if (d->cache) {
+    std::string key = d->cache_group + '\0' + read_obj.pool.to_str() + '\0' +
+      read_obj.oid + '\0' + std::to_string(read_ofs) + '\0' + std::to_string(len);
+    if (auto hit = d->cache->lookup(d->cache_group, d->cache_tag, key); hit) {
+      ldout(cct, 20) << "datacache hit oid=" << read_obj.oid << " obj-ofs=" << obj_ofs
+          << " read_ofs=" << read_ofs << " len=" << len << dendl;
+      // falls back to the rados read if the stripe can't be read
+      auto completed = d->aio->get(obj,
+          rgw::Aio::datacache_op(d->cache, std::move(*hit),
+                                 rgw::Aio::librados_op(std::move(op), d->yield),
+                                 d->yield),
+          cost, id);
+      return d->flush(std::move(completed));
+    }
+    d->cache_fills[obj_ofs] = std::move(key);
+  }
+
+  ldout(cct, 20) << "rados->get_obj_iterate_cb oid=" << read_obj.oid << " obj-ofs=" << obj_ofs << " read_ofs=" << read_ofs << " len=" << len << dendl;
+
+  // note when the read is actually sent, after any wait for the window
+  auto& submitted = d->submitted[id];
+  auto read = [&submitted, f = rgw::Aio::librados_op(std::move(op), d->yield)]
+    (rgw::Aio* aio, rgw::AioResult& r) mutable {
+      submitted = ceph::mono_clock::now();
+      std::move(f)(aio, r);
+    };
+  auto completed = d->aio->get(obj, std::move(read), cost, id);
 
   return d->flush(std::move(completed));
 }
@@ -6429,10 +6524,23 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
   RGWObjectCtx& obj_ctx = source->get_ctx();
   const uint64_t chunk_size = cct->_conf->rgw_get_obj_max_req_size;
   const uint64_t window_size = cct->_conf->rgw_get_obj_window_size;
+  const uint64_t max_window_size = cct->_conf.get_val<Option::size_t>("rgw_get_obj_max_window_size");
 
   auto aio = rgw::make_throttle(window_size, y);
   get_obj_data data(store, cb, &*aio, ofs, y);
 
+  const auto start = ceph::mono_clock::now();
+  if (max_window_size > window_size) {
+    data.window.emplace(window_size, max_window_size, start);
+  }
+
+  data.cache = store->get_data_cache();
+  if (data.cache) {
+    rgw_raw_obj head;
+    store->obj_to_raw(source->get_bucket_info().placement_rule, state.obj, &head);
+    data.cache_group = head.oid;
+  }
+
   int r = store->iterate_obj(dpp, obj_ctx, source->get_bucket_info(), state.obj,
                              ofs, end, chunk_size, _get_obj_iterate_cb, &data, y);
   if (r < 0) {
@@ -6441,7 +6549,25 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
     return r;
   }
 
-  return data.drain();
+  r = data.drain();
+  if (r < 0) {
+    return r;
+  }
+
+  const double elapsed = std::chrono::duration<double>(ceph::mono_clock::now() - start).count();
+  const uint64_t rate = elapsed > 0 ? data.bytes_read / elapsed : 0;
+  if (data.bytes_read && perfcounter) {
+    perfcounter->inc(l_rgw_get_obj_rate, rate);
+  }
+  if (data.window) {
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_get_obj_window, data.window->get());
+    }
+    ldpp_dout(dpp, 10) << "read " << data.bytes_read << " bytes from rados at "
+        << rate << " B/s, read latency " << data.window->get_latency()
+        << "s, final window " << data.window->get() << dendl;
+  }
+  return 0;
 }
 
 int RGWRados::iterate_obj(const DoutPrefixProvider *dpp, RGWObjectCtx& obj_ctx,
@@ -8393,18 +8519,36 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    // number of entries last requested from this shard
+    uint32_t batch;
+    // where the next read from this shard starts; entries are moved
+    // out of the results as they are consumed, so keep a copy
+    cls_rgw_obj_key next_start;
 
     // manages an iterator through a shard and provides other
     // accessors
     ShardTracker(size_t _shard_idx,
 		 rgw_cls_list_ret& _result,
-		 const std::string& _oid_name):
+		 const std::string& _oid_name,
+		 uint32_t _batch,
+		 const cls_rgw_obj_key& _start):
       shard_idx(_shard_idx),
       result(_result),
       oid_name(_oid_name),
-      cursor(_result.dir.m.begin()),
-      end(_result.dir.m.end())
-    {}
+      batch(_batch),
+      next_start(_start)
+    {
+      reset();
+    }
+
+    // call after the results have been replaced by a new read
+    void reset() {
+      cursor = result.dir.m.begin();
+      end = result.dir.m.end();
+      if (cursor != end) {
+	next_start = result.dir.m.rbegin()->second.key;
+      }
+    }
 
     inline const std::string& entry_name() const {
       return cursor->first;
@@ -8438,28 +8582,71 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     }
   };
 
+  uint32_t count = 0;
+  uint64_t entries_read = 0;
+  uint32_t refills = 0;
+
   // one tracker per shard requested (may not be all shards)
   std::vector<ShardTracker> results_trackers;
   results_trackers.reserve(shard_list_results.size());
   for (auto& r : shard_list_results) {
-    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first]);
-
-    // if any *one* shard's result is trucated, the entire result is
-    // truncated
-    *is_truncated = *is_truncated || r.second.is_truncated;
+    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first],
+				  num_entries_per_shard, start_after_key);
+    entries_read += r.second.dir.m.size();
 
     // unless *all* are shards are cls_filtered, the entire result is
     // not filtered
     *cls_filtered = *cls_filtered && r.second.cls_filtered;
   }
 
+  // once a truncated shard runs out of entries, none of the remaining
+  // candidates can be returned before we know what comes next in that
+  // shard; read the next batch from that shard only, doubling the batch
+  // size each time so a shard that holds most of the listing quickly
+  // catches up with it. returns the number of entries read
+  auto refill = [&](ShardTracker& t) -> int {
+    const uint32_t remaining = num_entries - count;
+    t.batch = std::min(t.batch * 2, std::max(remaining, 8u));
+
+    map<int, string> oid{{int(t.shard_idx), t.oid_name}};
+    map<int, rgw_cls_list_ret> ret;
+    int r = CLSRGWIssueBucketList(ioctx, t.next_start, prefix, delimiter,
+				  t.batch, list_versions, oid, ret, 1)();
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: RGWRados::" << __func__ <<
+	": failed to list shard " << t.oid_name << ": r=" << r << dendl;
+      return r;
+    }
+    t.result = std::move(ret[t.shard_idx]);
+    t.reset();
+    *cls_filtered = *cls_filtered && t.result.cls_filtered;
+
+    const size_t n = t.result.dir.m.size();
+    entries_read += n;
+    ++refills;
+    ldout(cct, 20) << "RGWRados::" << __func__ << ": refilled shard " <<
+      t.shard_idx << " with " << n << " of " << t.batch << " entries" <<
+      dendl;
+    return n;
+  };
+
   // create a map to track the next candidate entry from ShardTracker
   // (key=candidate, value=index into results_trackers); as we consume
   // entries from shards, we replace them with the next entries in the
   // shards until we run out
   map<string, size_t> candidates;
   size_t tracker_idx = 0;
+  bool starved = false; // a truncated shard returned nothing
   for (auto& t : results_trackers) {
+    // a shard may come back empty but truncated when cls filtering
+    // skipped everything it looked at
+    while (t.at_end() && t.is_truncated() && !starved) {
+      r = refill(t);
+      if (r < 0) {
+	return r;
+      }
+      starved = (r == 0);
+    }
     // it's important that the values in the map refer to the index
     // into the results_trackers vector, which may not be the same
     // as the shard number (i.e., when not all shards are requested)
@@ -8467,11 +8654,10 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     ++tracker_idx;
   }
 
-  rgw_bucket_dir_entry*
-    last_entry_visited = nullptr; // to set last_entry (marker)
+  // to set last_entry (marker)
+  std::optional<rgw_obj_index_key> last_entry_visited;
   map<string, bufferlist> updates;
-  uint32_t count = 0;
-  while (count < num_entries && !candidates.empty()) {
+  while (count < num_entries && !candidates.empty() && !starved) {
     r = 0;
     // select the next entry in lexical order (first key in map);
     // again tracker_idx is not necessarily shard number, but is index
@@ -8507,16 +8693,15 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       r = 0;
     }
 
+    last_entry_visited = dirent.key;
     if (r >= 0) {
       ldout(cct, 10) << "RGWRados::" << __func__ << ": got " <<
 	dirent.key.name << "[" << dirent.key.instance << "]" << dendl;
       m[name] = std::move(dirent);
-      last_entry_visited = &(m[name]);
       ++count;
     } else {
       ldout(cct, 10) << "RGWRados::" << __func__ << ": skipping " <<
 	dirent.key.name << "[" << dirent.key.instance << "]" << dendl;
-      last_entry_visited = &tracker.dir_entry();
     }
 
     // refresh the candidates map
@@ -8525,12 +8710,19 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 
     next_candidate(cct, tracker, candidates, tracker_idx);
 
-    if (tracker.at_end() && tracker.is_truncated()) {
-      // once we exhaust one shard that is truncated, we need to stop,
-      // as we cannot be certain that one of the next entries needs to
-      // come from that shard; S3 and swift protocols allow returning
-      // fewer than what was requested
-      break;
+    // once we exhaust a shard that is truncated we cannot be certain
+    // that one of the next entries doesn't need to come from that
+    // shard, so read more from it before going on
+    while (count < num_entries && !starved &&
+	   tracker.at_end() && tracker.is_truncated()) {
+      r = refill(tracker);
+      if (r < 0) {
+	return r;
+      }
+      // S3 and swift protocols allow returning fewer than what was
+      // requested, so stop rather than spin on an empty shard
+      starved = (r == 0);
+      next_candidate(cct, tracker, candidates, tracker_idx);
     }
   } // while we haven't provided requested # of result entries
 
@@ -8567,8 +8759,17 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       count << ", which is truncated" << dendl;
   }
 
-  if (last_entry_visited != nullptr && last_entry) {
-    *last_entry = last_entry_visited->key;
+  ldout(cct, 10) << "RGWRados::" << __func__ << ": read " << entries_read <<
+    " entries from " << shard_count << " shard(s) with " << refills <<
+    " refill(s) to return " << count << dendl;
+  if (perfcounter) {
+    perfcounter->inc(l_rgw_bucket_list_read, entries_read);
+    perfcounter->inc(l_rgw_bucket_list_returned, count);
+    perfcounter->inc(l_rgw_bucket_list_refill, refills);
+  }
+
+  if (last_entry_visited && last_entry) {
+    *last_entry = *last_entry_visited;
     ldout(cct, 20) << "RGWRados::" << __func__ <<
       ": returning, last_entry=" << *last_entry << dendl;
   } else {
@@ -9204,3 +9405,158 @@ int RGWRados::delete_obj_aio(const DoutPrefixProvider *dpp, const rgw_obj& obj,
   }
   return ret;
 }
+
+/*
+ * Remove a batch of plain (unversioned) objects, as lifecycle expiration
+ * does. The head objects are removed concurrently, each guarded by its
+ * tag, and then the index entries of each shard are removed with a single
+ * bucket_remove_entries call, which leaves alone any entry that changed
+ * since it was listed. No index operation is prepared, so an entry whose
+ * head was removed stays listed until the next pass finds it gone.
+ */
+int RGWRados::delete_objs_bulk(const DoutPrefixProvider *dpp,
+                               RGWObjectCtx& obj_ctx,
+                               RGWBucketInfo& bucket_info,
+                               const std::vector<rgw_bucket_dir_entry>& entries,
+                               uint64_t *num_deleted, optional_yield y)
+{
+  struct head_del {
+    const rgw_bucket_dir_entry& entry;
+    rgw_obj obj;
+    RGWObjState *state;
+    rgw_rados_ref ref;
+    librados::AioCompletion *c{nullptr};
+  };
+  std::vector<head_del> dels;
+  dels.reserve(entries.size());
+  std::map<int, std::map<cls_rgw_obj_key, rgw_bucket_entry_ver>> removals;
+  int ret = 0;
+
+  for (auto& e : entries) {
+    rgw_obj obj(bucket_info.bucket, e.key);
+    RGWObjState *state;
+    int r = get_obj_state(dpp, &obj_ctx, bucket_info, obj, &state, false, y);
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: " << __func__ << "(): failed to get state of "
+                        << obj << " r=" << r << dendl;
+      ret = r;
+      continue;
+    }
+    int shard_id;
+    r = get_target_shard_id(bucket_info.layout.current_index.layout.normal,
+                            e.key.name, &shard_id);
+    if (r < 0) {
+      ret = r;
+      continue;
+    }
+    if (!state->exists) {
+      /* the head is already gone, only the index entry is left */
+      removals[shard_id][cls_rgw_obj_key(e.key.name, e.key.instance)] = e.ver;
+      continue;
+    }
+    if (state->epoch != e.ver.epoch) {
+      ldpp_dout(dpp, 10) << __func__ << "(): " << obj
+                         << " was modified since it was listed, skipping" << dendl;
+      continue;
+    }
+
+    head_del d{e, obj, state};
+    r = get_obj_head_ref(bucket_info, obj, &d.ref);
+    if (r < 0) {
+      ret = r;
+      continue;
+    }
+    ObjectWriteOperation op;
+    if (state->obj_tag.length() && !state->fake_tag) {
+      op.cmpxattr(RGW_ATTR_ID_TAG, LIBRADOS_CMPXATTR_OP_EQ, state->obj_tag);
+    }
+    remove_rgw_head_obj(op);
+    d.c = librados::Rados::aio_create_completion(nullptr, nullptr);
+    r = d.ref.pool.ioctx().aio_operate(d.ref.obj.oid, d.c, &op);
+    if (r < 0) {
+      d.c->release();
+      ret = r;
+      continue;
+    }
+    dels.push_back(std::move(d));
+  }
+
+  uint64_t deleted = 0;
+  uint64_t deleted_size = 0;
+  for (auto& d : dels) {
+    d.c->wait_for_complete();
+    int r = d.c->get_return_value();
+    d.c->release();
+    if (r == -ECANCELED) {
+      /* raced with a write, which now owns the index entry */
+      obj_ctx.invalidate(d.obj);
+      continue;
+    }
+    if (r < 0 && r != -ENOENT) {
+      ldpp_dout(dpp, 0) << "ERROR: " << __func__ << "(): failed to remove "
+                        << d.obj << " r=" << r << dendl;
+      ret = r;
+      continue;
+    }
+    if (auto data_cache = get_data_cache(); data_cache) {
+      data_cache->invalidate(d.ref.obj.oid);
+    }
+    tombstone_cache_t *obj_tombstone_cache = get_tombstone_cache();
+    if (obj_tombstone_cache) {
+      tombstone_entry entry{*d.state};
+      obj_tombstone_cache->add(d.obj, entry);
+    }
+    if (d.state->manifest && !d.state->keep_tail) {
+      cls_rgw_obj_chain chain;
+      update_gc_chain(d.obj, *d.state->manifest, &chain);
+      string tag = (d.state->tail_tag.length() > 0 ?
+                    d.state->tail_tag.to_str() : d.state->obj_tag.to_str());
+      if (send_chain_to_gc(chain, tag) < 0) {
+        delete_objs_inline(chain, tag);
+      }
+    }
+    int shard_id;
+    get_target_shard_id(bucket_info.layout.current_index.layout.normal,
+                        d.entry.key.name, &shard_id);
+    removals[shard_id][cls_rgw_obj_key(d.entry.key.name, d.entry.key.instance)] = d.entry.ver;
+    obj_ctx.invalidate(d.obj);
+    ++deleted;
+    deleted_size += d.entry.meta.accounted_size;
+  }
+
+  rgw_zone_set zones_trace;
+  zones_trace.insert(svc.zone->get_zone().id, bucket_info.bucket.get_key());
+  for (auto& [shard_id, keys] : removals) {
+    BucketShard bs(this);
+    int r = bs.init(bucket_info, bucket_info.layout.current_index, shard_id);
+    if (r < 0) {
+      ret = r;
+      continue;
+    }
+    ObjectWriteOperation o;
+    cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
+    cls_rgw_bucket_remove_entries(o, keys, svc.zone->get_zone().log_data, 0,
+                                  &zones_trace);
+    r = bs.bucket_obj.operate(&o, y);
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: " << __func__ << "(): failed to remove "
+                        << keys.size() << " index entries from shard "
+                        << shard_id << " r=" << r << dendl;
+      ret = r;
+      continue;
+    }
+    r = svc.datalog_rados->add_entry(dpp, bucket_info, shard_id);
+    if (r < 0) {
+      lderr(cct) << "ERROR: failed writing data log" << dendl;
+    }
+  }
+
+  if (deleted) {
+    quota_handler->update_stats(bucket_info.owner, bucket_info.bucket,
+                                -(int)deleted, 0, deleted_size);
+  }
+  if (num_deleted) {
+    *num_deleted = deleted;
+  }
+  return ret;
+}
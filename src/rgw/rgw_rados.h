@@ -47,6 +47,7 @@ struct RGWZoneGroup;
 struct RGWZoneParams;
 class RGWReshard;
 class RGWReshardWait;
+class RGWDataCache;
 
 class RGWSysObjectCtx;
 
@@ -507,6 +508,9 @@ protected:
 
   bool use_cache{false};
 
+  // local object data cache for GETs, if enabled
+  RGWDataCache *data_cache{nullptr};
+
   int get_obj_head_ioctx(const RGWBucketInfo& bucket_info, const rgw_obj& obj, librados::IoCtx *ioctx);
 public:
   RGWRados(): timer(NULL),
@@ -531,6 +535,10 @@ public:
     return lc;
   }
 
+  RGWDataCache *get_data_cache() {
+    return data_cache;
+  }
+
   RGWRados& set_run_gc_thread(bool _use_gc_thread) {
     use_gc_thread = _use_gc_thread;
     return *this;
@@ -1498,6 +1506,10 @@ public:
   int delete_obj_aio(const DoutPrefixProvider *dpp, const rgw_obj& obj, RGWBucketInfo& info, RGWObjState *astate,
                      list<librados::AioCompletion *>& handles, bool keep_index_consistent,
                      optional_yield y);
+  int delete_objs_bulk(const DoutPrefixProvider *dpp, RGWObjectCtx& obj_ctx,
+                       RGWBucketInfo& bucket_info,
+                       const std::vector<rgw_bucket_dir_entry>& entries,
+                       uint64_t *num_deleted, optional_yield y);
 
  private:
   /**
@@ -250,6 +250,54 @@ public:
   }
 }; // class BucketReshardManager
 
+// the index shard of the resharded bucket that an entry belongs to
+static int get_target_shard(rgw::sal::RGWRadosStore *store,
+			    const RGWBucketInfo& new_bucket_info,
+			    const cls_rgw_obj_key& cls_key,
+			    int *shard_index)
+{
+  rgw_obj_key key(cls_key);
+  rgw_obj obj(new_bucket_info.bucket, key);
+  RGWMPObj mp;
+  if (key.ns == RGW_OBJ_NS_MULTIPART && mp.from_meta(key.name)) {
+    // place the multipart .meta object on the same shard as its head object
+    obj.index_hash_source = mp.get_key();
+  }
+  int target_shard_id;
+  int ret = store->getRados()->get_target_shard_id(new_bucket_info.layout.current_index.layout.normal, obj.get_hash_object(), &target_shard_id);
+  if (ret < 0) {
+    lderr(store->ctx()) << "ERROR: get_target_shard_id() returned ret=" << ret << dendl;
+    return ret;
+  }
+
+  *shard_index = (target_shard_id > 0 ? target_shard_id : 0);
+  return 0;
+}
+
+// all the index entries (plain, instance and olh) for one object name
+static int list_name_entries(RGWRados::BucketShard& bs, const string& name,
+			     list<rgw_cls_bi_entry> *entries)
+{
+  string marker;
+  bool is_truncated = true;
+  while (is_truncated) {
+    list<rgw_cls_bi_entry> batch;
+    int ret = bs.store->bi_list(bs, name, marker, 1000, &batch, &is_truncated);
+    if (ret == -ENOENT) {
+      return 0;
+    }
+    if (ret < 0) {
+      return ret;
+    }
+    if (batch.empty()) {
+      break;
+    }
+    marker = batch.back().idx;
+    entries->splice(entries->end(), batch);
+  }
+  return 0;
+}
+
 RGWBucketReshard::RGWBucketReshard(rgw::sal::RGWRadosStore *_store,
 				   const RGWBucketInfo& _bucket_info,
 				   const map<string, bufferlist>& _bucket_attrs,
@@ -311,6 +359,26 @@ int RGWBucketReshard::clear_index_shard_reshard_status(rgw::sal::RGWRadosStore*
 {
   uint32_t num_shards = bucket_info.layout.current_index.layout.normal.num_shards;
 
+  // drop whatever an unfinished online reshard logged; best effort, as
+  // the log is harmless once recording stops
+  RGWSI_RADOS::Pool index_pool;
+  map<int, string> shard_oids;
+  int r = store->svc()->bi_rados->open_bucket_index(bucket_info, std::nullopt,
+						    &index_pool, &shard_oids,
+						    nullptr);
+  if (r == 0) {
+    for (auto& [shard, oid] : shard_oids) {
+      librados::ObjectWriteOperation op;
+      cls_rgw_reshard_log_trim(op);
+      r = rgw_rados_operate(index_pool.ioctx(), oid, &op, null_yield);
+      if (r < 0) {
+	ldout(store->ctx(), 5) << "RGWBucketReshard::" << __func__ <<
+	  " failed to trim reshard log of " << oid << ": " <<
+	  cpp_strerror(-r) << dendl;
+      }
+    }
+  }
+
   if (num_shards < std::numeric_limits<uint32_t>::max()) {
     int ret = set_resharding_status(store, bucket_info,
 				    bucket_info.bucket.bucket_id,
@@ -527,9 +595,240 @@ int RGWBucketReshardLock::renew(const Clock::time_point& now) {
 }
 
 
+int RGWBucketReshard::renew_locks(const Clock::time_point& now)
+{
+  if (!reshard_lock.should_renew(now)) {
+    return 0;
+  }
+  // assume outer locks have timespans at least the size of ours, so
+  // can call inside conditional
+  if (outer_reshard_lock) {
+    int ret = outer_reshard_lock->renew(now);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  int ret = reshard_lock.renew(now);
+  if (ret < 0) {
+    lderr(store->ctx()) << "Error renewing bucket lock: " << ret << dendl;
+    return ret;
+  }
+  return 0;
+}
+
+// names listed from a reshard log in one go, and replayed together
+static constexpr uint32_t RESHARD_LOG_BATCH = 1000;
+
+// list the index entries of each of @a names with a single read of the
+// shard; names with more entries than one listing returns are read again
+// on their own
+static int list_names_entries(RGWRados::BucketShard& bs,
+			      const std::vector<string>& names,
+			      map<string, list<rgw_cls_bi_entry>> *entries)
+{
+  librados::ObjectReadOperation op;
+  std::vector<rgw_cls_bi_list_ret> results(names.size());
+  std::vector<int> rets(names.size(), 0);
+  for (size_t i = 0; i < names.size(); ++i) {
+    cls_rgw_bi_list(op, names[i], string(), RESHARD_LOG_BATCH,
+		    &results[i], &rets[i]);
+  }
+  int ret = bs.bucket_obj.operate(&op, nullptr, null_yield);
+  if (ret == -ENOENT) {
+    return 0;
+  }
+  if (ret < 0) {
+    return ret;
+  }
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (rets[i] < 0 && rets[i] != -ENOENT) {
+      return rets[i];
+    }
+    auto& name_entries = (*entries)[names[i]];
+    if (results[i].is_truncated) {
+      ret = list_name_entries(bs, names[i], &name_entries);
+      if (ret < 0) {
+	return ret;
+      }
+    } else {
+      name_entries = std::move(results[i].entries);
+    }
+  }
+  return 0;
+}
+
+static void add_stats(map<RGWObjCategory, rgw_bucket_category_stats>& delta,
+		      rgw_cls_bi_entry& entry, bool remove)
+{
+  cls_rgw_obj_key key;
+  RGWObjCategory category;
+  rgw_bucket_category_stats stats;
+  if (!entry.get_info(&key, &category, &stats)) {
+    return;
+  }
+  // the counters are unsigned and the cls side adds them, so subtracting
+  // wraps around to the right result
+  auto& d = delta[category];
+  if (remove) {
+    d.num_entries -= stats.num_entries;
+    d.total_size -= stats.total_size;
+    d.total_size_rounded -= stats.total_size_rounded;
+    d.actual_size -= stats.actual_size;
+  } else {
+    d.num_entries += stats.num_entries;
+    d.total_size += stats.total_size;
+    d.total_size_rounded += stats.total_size_rounded;
+    d.actual_size += stats.actual_size;
+  }
+}
+
+// bring the entries of @a names in the new index up to date with the
+// source shard, with one read of the source and one read and one write
+// per target shard
+static int replay_names(rgw::sal::RGWRadosStore *store,
+			RGWRados::BucketShard& source,
+			const RGWBucketInfo& new_bucket_info,
+			const std::vector<string>& names,
+			const DoutPrefixProvider *dpp)
+{
+  map<string, list<rgw_cls_bi_entry>> current;
+  int ret = list_names_entries(source, names, &current);
+  if (ret < 0) {
+    return ret;
+  }
+
+  map<int, std::vector<string>> target_names;
+  for (auto& name : names) {
+    int shard_index;
+    ret = get_target_shard(store, new_bucket_info, cls_rgw_obj_key(name),
+			   &shard_index);
+    if (ret < 0) {
+      return ret;
+    }
+    target_names[shard_index].push_back(name);
+  }
+
+  const auto& idx_layout = new_bucket_info.layout.current_index;
+  for (auto& [shard_index, shard_names] : target_names) {
+    RGWRados::BucketShard target(store->getRados());
+    ret = target.init(new_bucket_info.bucket,
+		      (idx_layout.layout.normal.num_shards > 0 ? shard_index : -1),
+		      idx_layout, nullptr, dpp);
+    if (ret < 0) {
+      return ret;
+    }
+
+    map<string, list<rgw_cls_bi_entry>> copied;
+    ret = list_names_entries(target, shard_names, &copied);
+    if (ret < 0) {
+      return ret;
+    }
+
+    // replace what the copy wrote for these names with the current
+    // entries, adjusting the stats by the difference
+    map<RGWObjCategory, rgw_bucket_category_stats> delta;
+    librados::ObjectWriteOperation op;
+    std::set<string> stale;
+    for (auto& name : shard_names) {
+      for (auto& entry : copied[name]) {
+	add_stats(delta, entry, true);
+	stale.insert(entry.idx);
+      }
+    }
+    if (!stale.empty()) {
+      op.omap_rm_keys(stale);
+    }
+    for (auto& name : shard_names) {
+      for (auto& entry : current[name]) {
+	add_stats(delta, entry, false);
+	store->getRados()->bi_put(op, target, entry);
+      }
+    }
+    cls_rgw_bucket_update_stats(op, false, delta);
+
+    ldout(store->ctx(), 20) << __func__ << ": replacing entries of " <<
+      shard_names.size() << " name(s) in shard " << shard_index << dendl;
+
+    ret = target.bucket_obj.operate(&op, null_yield);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+int RGWBucketReshard::replay_reshard_log(const RGWBucketInfo& new_bucket_info,
+					 const DoutPrefixProvider *dpp,
+					 uint64_t *replayed)
+{
+  const auto& idx_layout = bucket_info.layout.current_index;
+  const int num_source_shards =
+    (idx_layout.layout.normal.num_shards > 0 ? idx_layout.layout.normal.num_shards : 1);
+
+  for (int i = 0; i < num_source_shards; ++i) {
+    RGWRados::BucketShard source(store->getRados());
+    int ret = source.init(bucket_info.bucket,
+			  (idx_layout.layout.normal.num_shards > 0 ? i : -1),
+			  idx_layout, nullptr, dpp);
+    if (ret < 0) {
+      return ret;
+    }
+
+    // a name changed again behind the marker is left for the next pass
+    string marker;
+    bool is_truncated = true;
+    while (is_truncated) {
+      librados::ObjectReadOperation op;
+      cls_rgw_reshard_log_list_ret log;
+      cls_rgw_reshard_log_list(op, marker, RESHARD_LOG_BATCH, &log);
+      ret = source.bucket_obj.operate(&op, nullptr, null_yield);
+      if (ret < 0) {
+	lderr(store->ctx()) << "ERROR: failed to list reshard log of shard " <<
+	  i << ": " << cpp_strerror(-ret) << dendl;
+	return ret;
+      }
+      if (log.entries.empty()) {
+	break;
+      }
+
+      // drop the names from the log before reading their entries; a
+      // write that lands after the entries are read logs its name again
+      librados::ObjectWriteOperation trim;
+      cls_rgw_reshard_log_trim(trim, log.entries);
+      ret = source.bucket_obj.operate(&trim, null_yield);
+      if (ret < 0) {
+	lderr(store->ctx()) << "ERROR: failed to trim reshard log of shard " <<
+	  i << ": " << cpp_strerror(-ret) << dendl;
+	return ret;
+      }
+
+      std::vector<string> names(log.entries.begin(), log.entries.end());
+      ret = replay_names(store, source, new_bucket_info, names, dpp);
+      if (ret < 0) {
+	lderr(store->ctx()) << "ERROR: failed to replay index entries of " <<
+	  names.size() << " object(s) from shard " << i << ": " <<
+	  cpp_strerror(-ret) << dendl;
+	return ret;
+      }
+      *replayed += names.size();
+      marker = names.back();
+      is_truncated = log.is_truncated;
+
+      ret = renew_locks(Clock::now());
+      if (ret < 0) {
+	return ret;
+      }
+    }
+  }
+
+  return 0;
+}
+
 int RGWBucketReshard::do_reshard(int num_shards,
 				 RGWBucketInfo& new_bucket_info,
 				 int max_entries,
+				 bool online,
 				 bool verbose,
 				 ostream *out,
 				 Formatter *formatter,
@@ -607,47 +906,25 @@ int RGWBucketReshard::do_reshard(int num_shards,
 
 	marker = entry.idx;
 
-	int target_shard_id;
 	cls_rgw_obj_key cls_key;
 	RGWObjCategory category;
 	rgw_bucket_category_stats stats;
 	bool account = entry.get_info(&cls_key, &category, &stats);
-	rgw_obj_key key(cls_key);
-	rgw_obj obj(new_bucket_info.bucket, key);
-	RGWMPObj mp;
-	if (key.ns == RGW_OBJ_NS_MULTIPART && mp.from_meta(key.name)) {
-	  // place the multipart .meta object on the same shard as its head object
-	  obj.index_hash_source = mp.get_key();
-	}
-	int ret = store->getRados()->get_target_shard_id(new_bucket_info.layout.current_index.layout.normal, obj.get_hash_object(), &target_shard_id);
+	int shard_index;
+	int ret = get_target_shard(store, new_bucket_info, cls_key, &shard_index);
 	if (ret < 0) {
-	  lderr(store->ctx()) << "ERROR: get_target_shard_id() returned ret=" << ret << dendl;
 	  return ret;
 	}
 
-	int shard_index = (target_shard_id > 0 ? target_shard_id : 0);
-
 	ret = target_shards_mgr.add_entry(shard_index, entry, account,
 					  category, stats);
 	if (ret < 0) {
 	  return ret;
 	}
 
-	Clock::time_point now = Clock::now();
-	if (reshard_lock.should_renew(now)) {
-	  // assume outer locks have timespans at least the size of ours, so
-	  // can call inside conditional
-	  if (outer_reshard_lock) {
-	    ret = outer_reshard_lock->renew(now);
-	    if (ret < 0) {
-	      return ret;
-	    }
-	  }
-	  ret = reshard_lock.renew(now);
-	  if (ret < 0) {
-	    lderr(store->ctx()) << "Error renewing bucket lock: " << ret << dendl;
-	    return ret;
-	  }
+	ret = renew_locks(Clock::now());
+	if (ret < 0) {
+	  return ret;
 	}
 	if (verbose_json_out) {
 	  formatter->close_section();
@@ -672,6 +949,50 @@ int RGWBucketReshard::do_reshard(int num_shards,
     return -EIO;
   }
 
+  if (online) {
+    // the copy above ran with writes going on. catch up on what changed
+    // meanwhile while they still go on, so that as little as possible is
+    // left to do with writes blocked
+    const auto max_passes =
+      store->ctx()->_conf.get_val<uint64_t>("rgw_reshard_online_catchup_passes");
+    for (uint64_t pass = 0; pass < max_passes; ++pass) {
+      uint64_t replayed = 0;
+      ret = replay_reshard_log(new_bucket_info, dpp, &replayed);
+      if (ret < 0) {
+	return ret;
+      }
+      ldout(store->ctx(), 5) << __func__ << ": catch-up pass " << pass <<
+	" replayed " << replayed << " changed object(s)" << dendl;
+      if (replayed <= RESHARD_LOG_BATCH) {
+	break;
+      }
+    }
+
+    // block writes and bring over the rest
+    const auto block_start = ceph::mono_clock::now();
+    ret = set_resharding_status(new_bucket_info.bucket.bucket_id,
+				num_shards,
+				cls_rgw_reshard_status::IN_PROGRESS);
+    if (ret < 0) {
+      return ret;
+    }
+
+    uint64_t replayed = 0;
+    ret = replay_reshard_log(new_bucket_info, dpp, &replayed);
+    if (ret < 0) {
+      return ret;
+    }
+
+    const auto blocked = ceph::mono_clock::now() - block_start;
+    ldout(store->ctx(), 1) << __func__ << ": replayed " << replayed <<
+      " changed object(s) with writes blocked for " <<
+      ceph::to_seconds<double>(blocked) << "s" << dendl;
+    if (out && !verbose_json_out) {
+      (*out) << "replayed " << replayed << " changed object(s), writes "
+	"blocked for " << ceph::to_seconds<double>(blocked) << "s" << std::endl;
+    }
+  }
+
   ret = store->ctl()->bucket->link_bucket(new_bucket_info.owner, new_bucket_info.bucket, bucket_info.creation_time, null_yield, dpp);
   if (ret < 0) {
     lderr(store->ctx()) << "failed to link new bucket instance (bucket_id=" << new_bucket_info.bucket.bucket_id << ": " << cpp_strerror(-ret) << ")" << dendl;
@@ -699,6 +1020,8 @@ int RGWBucketReshard::execute(int num_shards, int max_op_entries,
                               bool verbose, ostream *out, Formatter *formatter,
 			      RGWReshard* reshard_log)
 {
+  const bool online = store->ctx()->_conf.get_val<bool>("rgw_reshard_online");
+
   int ret = reshard_lock.lock();
   if (ret < 0) {
     return ret;
@@ -719,9 +1042,11 @@ int RGWBucketReshard::execute(int num_shards, int max_op_entries,
   }
 
   // set resharding status of current bucket_info & shards with
-  // information about planned resharding
-  ret = set_resharding_status(new_bucket_info.bucket.bucket_id,
-			      num_shards, cls_rgw_reshard_status::IN_PROGRESS);
+  // information about planned resharding; when resharding online the
+  // shards keep accepting writes and log what they change instead
+  ret = set_resharding_status(new_bucket_info.bucket.bucket_id, num_shards,
+			      online ? cls_rgw_reshard_status::IN_LOGRECORD :
+			      cls_rgw_reshard_status::IN_PROGRESS);
   if (ret < 0) {
     goto error_out;
   }
@@ -729,6 +1054,7 @@ int RGWBucketReshard::execute(int num_shards, int max_op_entries,
   ret = do_reshard(num_shards,
 		   new_bucket_info,
 		   max_op_entries,
+		   online,
                    verbose, out, formatter, dpp);
   if (ret < 0) {
     goto error_out;
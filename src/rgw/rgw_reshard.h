@@ -87,9 +87,14 @@ private:
   int create_new_bucket_instance(int new_num_shards,
 				 RGWBucketInfo& new_bucket_info,
                                  const DoutPrefixProvider *dpp);
+  int renew_locks(const Clock::time_point& now);
+  int replay_reshard_log(const RGWBucketInfo& new_bucket_info,
+			 const DoutPrefixProvider *dpp,
+			 uint64_t *replayed);
   int do_reshard(int num_shards,
 		 RGWBucketInfo& new_bucket_info,
 		 int max_entries,
+		 bool online,
                  bool verbose,
                  ostream *os,
 		 Formatter *formatter,
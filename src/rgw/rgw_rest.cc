@@ -766,7 +766,21 @@ int dump_body(struct req_state* const s,
 
 int dump_body(struct req_state* const s, /* const */ ceph::buffer::list& bl)
 {
-  return dump_body(s, bl.c_str(), bl.length());
+  try {
+    return RESTFUL_IO(s)->send_body_list(bl);
+  } catch (rgw::io::Exception& e) {
+    return -e.code().value();
+  }
+}
+
+int dump_body(struct req_state* const s, const ceph::buffer::list& bl,
+              const off_t ofs, const off_t len)
+{
+  /* shares the segments of bl, so a range of a fragmented list is sent
+   * without flattening it first */
+  ceph::buffer::list range;
+  range.substr_of(bl, ofs, len);
+  return dump_body(s, range);
 }
 
 int dump_body(struct req_state* const s, const std::string& str)
@@ -63,6 +63,7 @@
 #include "rgw_rest_iam.h"
 #include "rgw_sts.h"
 #include "rgw_sal_rados.h"
+#include "rgw_s3select_scan.h"
 
 #define dout_context g_ceph_context
 #define dout_subsys ceph_subsys_rgw
@@ -428,7 +429,7 @@ done:
 
 send_data:
   if (get_data && !op_ret) {
-    int r = dump_body(s, bl.c_str() + bl_ofs, bl_len);
+    int r = dump_body(s, bl, bl_ofs, bl_len);
     if (r < 0)
       return r;
   }
@@ -6008,9 +6009,43 @@ int RGWSelectObj_ObjStore_S3::get_params(optional_yield y)
     return status;
   }
 
+  init_pushdown();
+
   return RGWGetObj_ObjStore_S3::get_params(y);
 }
 
+void RGWSelectObj_ObjStore_S3::init_pushdown()
+{
+  if (!s->cct->_conf.get_val<bool>("rgw_s3select_pushdown")) {
+    return;
+  }
+  // escaped quotes would throw off the row scan
+  if (m_escape_char.size()) {
+    return;
+  }
+
+  rgw::s3select::CSVDialect dialect;
+  if (m_row_delimiter.size()) {
+    dialect.row_delimiter = *m_row_delimiter.c_str();
+  }
+  if (m_column_delimiter.size()) {
+    dialect.column_delimiter = *m_column_delimiter.c_str();
+  }
+  if (m_quot.size()) {
+    dialect.quote = *m_quot.c_str();
+  }
+
+  auto filter = rgw::s3select::RowFilter::from_query(m_sql_query, dialect);
+  if (!filter) {
+    return;
+  }
+  const bool header = m_header_info.compare("IGNORE") == 0 ||
+                      m_header_info.compare("USE") == 0;
+  m_pushdown = std::make_unique<rgw::s3select::CSVPushdown>(std::move(*filter), header);
+  ldout(s->cct, 10) << "s3-select query: filtering rows on "
+                    << m_pushdown->get_num_predicates() << " predicates" << dendl;
+}
+
 void RGWSelectObj_ObjStore_S3::encode_short(char* buff, uint16_t s, int& i)
 {
   short x = htons(s);
@@ -6094,7 +6129,8 @@ int RGWSelectObj_ObjStore_S3::create_message(char* buff, u_int32_t result_len, u
 #define PAYLOAD_LINE "\n<Payload>\n<Records>\n<Payload>\n"
 #define END_PAYLOAD_LINE "\n</Payload></Records></Payload>"
 
-int RGWSelectObj_ObjStore_S3::run_s3select(const char* query, const char* input, size_t input_length)
+int RGWSelectObj_ObjStore_S3::run_s3select(const char* query, const char* input, size_t input_length,
+                                           size_t stream_size)
 {
   int status = 0;
   csv_object::csv_defintions csv;
@@ -6144,7 +6180,7 @@ int RGWSelectObj_ObjStore_S3::run_s3select(const char* query, const char* input,
     header_size = create_header_records(m_buff_header.get());
     m_result.append(m_buff_header.get(), header_size);
     m_result.append(PAYLOAD_LINE);
-    status = m_s3_csv_object->run_s3select_on_stream(m_result, input, input_length, s->obj_size);
+    status = m_s3_csv_object->run_s3select_on_stream(m_result, input, input_length, stream_size);
     if(status<0) {
       m_result.append(m_s3_csv_object->get_error_description());
     }
@@ -6252,7 +6288,28 @@ int RGWSelectObj_ObjStore_S3::send_response_data(bufferlist& bl, off_t ofs, off_
       continue; 
     }
 
-    status = run_s3select(m_sql_query.c_str(), &(it)[0], it.length());
+    if (m_pushdown) {
+      // the engine detects the end of the object by counting the bytes it
+      // was given, so tell it the size of what it gets from us instead
+      m_processed_bytes += it.length();
+      const bool last = m_processed_bytes >= s->obj_size;
+      m_pushdown_buff.clear();
+      m_pushdown->process(&(it)[0], it.length(), last, m_pushdown_buff);
+      m_forwarded_bytes += m_pushdown_buff.size();
+      if (last) {
+        ldout(s->cct, 10) << "s3-select query: passed " << m_pushdown->rows_out << " of "
+                          << m_pushdown->rows_in << " rows, " << m_pushdown->bytes_out << " of "
+                          << m_pushdown->bytes_in << " bytes to the engine" << dendl;
+      }
+      if (m_pushdown_buff.empty()) {
+        i++;
+        continue;
+      }
+      status = run_s3select(m_sql_query.c_str(), m_pushdown_buff.data(), m_pushdown_buff.size(),
+                            last ? m_forwarded_bytes : s->obj_size);
+    } else {
+      status = run_s3select(m_sql_query.c_str(), &(it)[0], it.length(), s->obj_size);
+    }
     if(status<0) {
       break;
     }
@@ -887,6 +887,10 @@ class s3select;
 class csv_object;
 }
 
+namespace rgw::s3select {
+class CSVPushdown;
+}
+
 class RGWSelectObj_ObjStore_S3 : public RGWGetObj_ObjStore_S3
 {
 
@@ -903,6 +907,10 @@ private:
   std::unique_ptr<char[]>  m_buff_header;
   std::string m_header_info;
   std::string m_sql_query;
+  std::unique_ptr<rgw::s3select::CSVPushdown> m_pushdown;
+  std::string m_pushdown_buff;
+  uint64_t m_processed_bytes = 0;
+  uint64_t m_forwarded_bytes = 0;
 
 public:
   unsigned int chunk_number;
@@ -941,7 +949,10 @@ private:
 
   int create_message(char* buff, u_int32_t result_len, u_int32_t header_len);
 
-  int run_s3select(const char* query, const char* input, size_t input_length);
+  int run_s3select(const char* query, const char* input, size_t input_length,
+                   size_t stream_size);
+
+  void init_pushdown();
 
   int extract_by_tag(std::string tag_name, std::string& result);
 
@@ -0,0 +1,482 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+#include "rgw_s3select_scan.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rgw::s3select {
+
+static constexpr size_t npos = std::string::npos;
+
+namespace {
+
+// state carried from one byte (or block) of a row scan to the next
+struct ScanState {
+  size_t row_begin = 0;
+  size_t last_quote = npos;
+  bool in_quote = false;
+
+  void end_row(size_t end, std::vector<RowSpan>& rows) {
+    const bool quoted = last_quote != npos && last_quote >= row_begin;
+    rows.push_back(RowSpan{row_begin, end, quoted});
+    row_begin = end + 1;
+  }
+
+  void scan(const char* buf, size_t from, size_t to, const CSVDialect& d,
+            std::vector<RowSpan>& rows) {
+    for (size_t i = from; i < to; i++) {
+      if (buf[i] == d.quote) {
+        in_quote = !in_quote;
+        last_quote = i;
+      } else if (buf[i] == d.row_delimiter && !in_quote) {
+        end_row(i, rows);
+      }
+    }
+  }
+};
+
+#if defined(__SSE2__)
+// bit i is set if an odd number of bits at or below i are set in m,
+// i.e. if byte i is inside (or opens) a quoted section
+inline uint32_t prefix_xor(uint32_t m)
+{
+  m ^= m << 1;
+  m ^= m << 2;
+  m ^= m << 4;
+  m ^= m << 8;
+  return m & 0xffff;
+}
+#endif
+
+} // anonymous namespace
+
+size_t find_rows_scalar(const char* buf, size_t len, const CSVDialect& d,
+                        std::vector<RowSpan>& rows)
+{
+  ScanState st;
+  st.scan(buf, 0, len, d, rows);
+  return st.row_begin;
+}
+
+size_t find_rows(const char* buf, size_t len, const CSVDialect& d,
+                 std::vector<RowSpan>& rows)
+{
+  ScanState st;
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i row_delim = _mm_set1_epi8(d.row_delimiter);
+  const __m128i quote = _mm_set1_epi8(d.quote);
+  for (; i + 16 <= len; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i));
+    const uint32_t rmask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, row_delim));
+    const uint32_t qmask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, quote));
+    if (!(rmask | qmask)) {
+      continue;
+    }
+    const uint32_t inside = prefix_xor(qmask) ^ (st.in_quote ? 0xffff : 0);
+    for (uint32_t ends = rmask & ~inside; ends; ends &= ends - 1) {
+      const unsigned b = __builtin_ctz(ends);
+      if (const uint32_t before = qmask & ((1u << b) - 1); before) {
+        st.last_quote = i + 31 - __builtin_clz(before);
+      }
+      st.end_row(i + b, rows);
+    }
+    if (qmask) {
+      st.last_quote = i + 31 - __builtin_clz(qmask);
+    }
+    st.in_quote = inside & 0x8000;
+  }
+#endif
+  st.scan(buf, i, len, d, rows);
+  return st.row_begin;
+}
+
+// a plain number the engine can't read any other way
+static std::optional<double> parse_number(std::string_view s)
+{
+  if (s.empty() || s.size() > 32) {
+    return std::nullopt;
+  }
+  unsigned digits = 0;
+  for (char c : s) {
+    if (isdigit(c)) {
+      digits++;
+    } else if (c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+      return std::nullopt;
+    }
+  }
+  // beyond this doubles don't compare like the integers they came from
+  if (!digits || digits > 15) {
+    return std::nullopt;
+  }
+  char tmp[33];
+  memcpy(tmp, s.data(), s.size());
+  tmp[s.size()] = '\0';
+  char *end = nullptr;
+  double v = strtod(tmp, &end);
+  if (end != tmp + s.size()) {
+    return std::nullopt;
+  }
+  return v;
+}
+
+static std::string_view trim(std::string_view s)
+{
+  while (!s.empty() && isspace(s.front())) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && isspace(s.back())) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+static bool iequals(std::string_view a, std::string_view b)
+{
+  return a.size() == b.size() &&
+    std::equal(a.begin(), a.end(), b.begin(),
+               [] (char x, char y) { return tolower(x) == tolower(y); });
+}
+
+bool Predicate::may_match(std::string_view field) const
+{
+  if (num) {
+    auto v = parse_number(field);
+    if (!v) {
+      return true; // let the engine decide what to make of it
+    }
+    switch (op) {
+    case Op::EQ: return *v == *num;
+    case Op::NE: return *v != *num;
+    case Op::LT: return *v < *num;
+    case Op::LE: return *v <= *num;
+    case Op::GT: return *v > *num;
+    case Op::GE: return *v >= *num;
+    }
+    return true;
+  }
+  switch (op) {
+  case Op::EQ:
+    // keep anything that might compare equal after trimming, case
+    // folding or conversion to numbers
+    if (iequals(trim(field), trim(str))) {
+      return true;
+    }
+    {
+      auto f = parse_number(trim(field));
+      auto s = parse_number(trim(str));
+      return f && s && *f == *s;
+    }
+  case Op::NE:
+    return field != str;
+  default:
+    return true;
+  }
+}
+
+RowFilter::RowFilter(std::vector<Predicate>&& p, const CSVDialect& d)
+  : preds(std::move(p)), dialect(d)
+{
+  for (const auto& pred : preds) {
+    max_column = std::max(max_column, pred.column);
+  }
+  // test the cheapest columns to find first
+  std::sort(preds.begin(), preds.end(),
+            [] (const Predicate& a, const Predicate& b) {
+              return a.column < b.column;
+            });
+}
+
+bool RowFilter::may_match(std::string_view row, bool truncated) const
+{
+  auto pred = preds.begin();
+  size_t pos = 0;
+  for (unsigned col = 0; col <= max_column; col++) {
+    const char* p = static_cast<const char*>(
+        memchr(row.data() + pos, dialect.column_delimiter, row.size() - pos));
+    if (!p && truncated) {
+      return true; // the field was cut short
+    }
+    const size_t end = p ? p - row.data() : row.size();
+    const std::string_view field = row.substr(pos, end - pos);
+    for (; pred != preds.end() && pred->column == col; ++pred) {
+      if (!pred->may_match(field)) {
+        return false;
+      }
+    }
+    if (!p) {
+      break; // fewer columns than the filter refers to
+    }
+    pos = end + 1;
+  }
+  return true;
+}
+
+namespace {
+
+struct Token {
+  enum Type { IDENT, NUMBER, STRING, OP, PUNCT } type;
+  std::string text;
+};
+
+bool tokenize(std::string_view q, std::vector<Token>& out)
+{
+  size_t i = 0;
+  while (i < q.size()) {
+    const char c = q[i];
+    if (isspace(c)) {
+      i++;
+    } else if (isalpha(c) || c == '_') {
+      size_t j = i;
+      while (j < q.size() && (isalnum(q[j]) || q[j] == '_')) {
+        j++;
+      }
+      out.push_back({Token::IDENT, std::string(q.substr(i, j - i))});
+      i = j;
+    } else if (isdigit(c) || c == '.' ||
+               (c == '-' && i + 1 < q.size() && isdigit(q[i + 1]) &&
+                !out.empty() && out.back().type == Token::OP)) {
+      size_t j = i + 1;
+      while (j < q.size() && (isalnum(q[j]) || q[j] == '.' ||
+                              ((q[j] == '-' || q[j] == '+') &&
+                               tolower(q[j - 1]) == 'e'))) {
+        j++;
+      }
+      out.push_back({Token::NUMBER, std::string(q.substr(i, j - i))});
+      i = j;
+    } else if (c == '\'') {
+      std::string s;
+      size_t j = i + 1;
+      for (;; j++) {
+        if (j >= q.size()) {
+          return false; // unterminated
+        }
+        if (q[j] == '\'') {
+          if (j + 1 < q.size() && q[j + 1] == '\'') {
+            s.push_back('\'');
+            j++;
+            continue;
+          }
+          break;
+        }
+        s.push_back(q[j]);
+      }
+      out.push_back({Token::STRING, std::move(s)});
+      i = j + 1;
+    } else if (c == '=' || c == '<' || c == '>' || c == '!') {
+      size_t j = i + 1;
+      if (j < q.size() && (q[j] == '=' || (c == '<' && q[j] == '>'))) {
+        j++;
+      }
+      out.push_back({Token::OP, std::string(q.substr(i, j - i))});
+      i = j;
+    } else if (c == '"') {
+      return false; // quoted identifiers
+    } else {
+      out.push_back({Token::PUNCT, std::string(1, c)});
+      i++;
+    }
+  }
+  return true;
+}
+
+bool is_keyword(const Token& t, std::string_view k)
+{
+  return t.type == Token::IDENT && iequals(t.text, k);
+}
+
+std::optional<unsigned> column_of(const Token& t)
+{
+  if (t.type != Token::IDENT || t.text.size() < 2 || t.text[0] != '_') {
+    return std::nullopt;
+  }
+  unsigned n = 0;
+  for (size_t i = 1; i < t.text.size(); i++) {
+    if (!isdigit(t.text[i]) || n > 100000) {
+      return std::nullopt;
+    }
+    n = n * 10 + (t.text[i] - '0');
+  }
+  if (n == 0) {
+    return std::nullopt;
+  }
+  return n - 1;
+}
+
+std::optional<Predicate::Op> op_of(const std::string& s, bool flip)
+{
+  using Op = Predicate::Op;
+  if (s == "=") return Op::EQ;
+  if (s == "!=" || s == "<>") return Op::NE;
+  if (s == "<") return flip ? Op::GT : Op::LT;
+  if (s == "<=") return flip ? Op::GE : Op::LE;
+  if (s == ">") return flip ? Op::LT : Op::GT;
+  if (s == ">=") return flip ? Op::LE : Op::GE;
+  return std::nullopt;
+}
+
+} // anonymous namespace
+
+std::optional<RowFilter> RowFilter::from_query(std::string_view query,
+                                               const CSVDialect& d)
+{
+  std::vector<Token> tokens;
+  if (!tokenize(query, tokens)) {
+    return std::nullopt;
+  }
+  auto where = std::find_if(tokens.begin(), tokens.end(),
+                            [] (const Token& t) { return is_keyword(t, "where"); });
+  if (where == tokens.end()) {
+    return std::nullopt;
+  }
+  auto end = std::find_if(where, tokens.end(), [] (const Token& t) {
+      return is_keyword(t, "limit") || (t.type == Token::PUNCT && t.text == ";");
+    });
+
+  std::vector<Predicate> preds;
+  for (auto i = where + 1; i < end; ) {
+    auto conj_end = std::find_if(i, end, [] (const Token& t) {
+        return is_keyword(t, "and");
+      });
+    // anything but "column op literal" or "literal op column" and we
+    // can't tell which rows the engine would keep
+    if (conj_end - i != 3 || i[1].type != Token::OP) {
+      return std::nullopt;
+    }
+    const Token *col = &i[0], *lit = &i[2];
+    bool flip = false;
+    if (!column_of(*col)) {
+      std::swap(col, lit);
+      flip = true;
+    }
+    auto column = column_of(*col);
+    auto op = op_of(i[1].text, flip);
+    if (!column || !op ||
+        (lit->type != Token::NUMBER && lit->type != Token::STRING)) {
+      return std::nullopt;
+    }
+    Predicate p;
+    p.column = *column;
+    p.op = *op;
+    p.str = lit->text;
+    if (lit->type == Token::NUMBER) {
+      p.num = parse_number(lit->text);
+      if (!p.num) {
+        return std::nullopt;
+      }
+    }
+    // ordering of strings is left to the engine
+    if (p.num || p.op == Predicate::Op::EQ || p.op == Predicate::Op::NE) {
+      preds.push_back(std::move(p));
+    }
+    i = conj_end == end ? end : conj_end + 1;
+  }
+  if (preds.empty()) {
+    return std::nullopt;
+  }
+  return RowFilter(std::move(preds), d);
+}
+
+bool CSVPushdown::keep(std::string_view row, bool quoted)
+{
+  rows_in++;
+  if (first_row) {
+    first_row = false;
+    if (keep_first_row) {
+      return true; // header
+    }
+  }
+  if (!quoted) {
+    return filter.may_match(row);
+  }
+  // quotes only matter to the filter if they start before the last column
+  // it looks at. a quoted row delimiter might split the row differently
+  // for the engine, so those rows are always kept
+  const CSVDialect& d = filter.get_dialect();
+  if (row.find(d.row_delimiter) != npos) {
+    return true;
+  }
+  return filter.may_match(row.substr(0, row.find(d.quote)), true);
+}
+
+size_t CSVPushdown::process_rows(const char* buf, size_t len, std::string& out)
+{
+  const char row_delimiter = filter.get_dialect().row_delimiter;
+  rows.clear();
+  const size_t consumed = find_rows(buf, len, filter.get_dialect(), rows);
+  for (const auto& r : rows) {
+    if (keep(std::string_view(buf + r.begin, r.end - r.begin), r.quoted)) {
+      out.append(buf + r.begin, r.end - r.begin);
+      out.push_back(row_delimiter);
+      rows_out++;
+    }
+  }
+  if (!rows.empty()) {
+    last_row.assign(buf + rows.back().begin, rows.back().end - rows.back().begin);
+  }
+  return consumed;
+}
+
+void CSVPushdown::process(const char* data, size_t len, bool last,
+                          std::string& out)
+{
+  const CSVDialect& d = filter.get_dialect();
+  bytes_in += len;
+  const size_t out_begin = out.size();
+
+  if (!carry.empty()) {
+    // complete the row left over from the previous chunk on its own, so
+    // the rest of this one can be scanned in place
+    bool in_quote = std::count(carry.begin(), carry.end(), d.quote) % 2;
+    size_t i = 0;
+    for (; i < len; i++) {
+      if (data[i] == d.quote) {
+        in_quote = !in_quote;
+      } else if (data[i] == d.row_delimiter && !in_quote) {
+        break;
+      }
+    }
+    if (i == len) {
+      carry.append(data, len);
+      data += len;
+      len = 0;
+    } else {
+      carry.append(data, i + 1);
+      data += i + 1;
+      len -= i + 1;
+      process_rows(carry.data(), carry.size(), out);
+      carry.clear();
+    }
+  }
+
+  const size_t consumed = process_rows(data, len, out);
+  carry.append(data + consumed, len - consumed);
+
+  if (last) {
+    if (!carry.empty()) {
+      // the last row has no delimiter
+      const bool quoted = carry.find(d.quote) != npos;
+      if (keep(carry, quoted) || out.size() == out_begin) {
+        out.append(carry);
+        rows_out++;
+      }
+      carry.clear();
+    } else if (out.size() == out_begin && !last_row.empty()) {
+      // the engine needs something to notice the end of the stream
+      out.append(last_row);
+      out.push_back(d.row_delimiter);
+      rows_out++;
+    }
+  }
+  bytes_out += out.size() - out_begin;
+}
+
+} // namespace rgw::s3select
@@ -0,0 +1,125 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Row scanning and filter pushdown for S3 Select over CSV.
+ *
+ * The s3select engine parses and evaluates every row it is given.  When
+ * the WHERE clause is a conjunction of simple comparisons on positional
+ * columns, RGW can discard most non-matching rows before they reach the
+ * engine.  Rows are found 16 bytes at a time with SIMD compares, keeping
+ * track of quoted sections, and only the columns the filter refers to are
+ * split out of each row.
+ *
+ * The filter is conservative: a row is only dropped when it certainly
+ * fails one of the comparisons.  Rows quoted before the last column the
+ * filter looks at are always kept, and the engine still evaluates the
+ * full query on everything that is kept.
+ */
+namespace rgw::s3select {
+
+struct CSVDialect {
+  char row_delimiter = '\n';
+  char column_delimiter = ',';
+  char quote = '"';
+};
+
+struct RowSpan {
+  size_t begin;
+  size_t end;     // offset of the row delimiter
+  bool quoted;    // the row contains a quote character
+};
+
+/// find the complete rows in [buf, buf+len), appending them to @a rows.
+/// returns the offset just past the last row delimiter found
+size_t find_rows(const char* buf, size_t len, const CSVDialect& d,
+                 std::vector<RowSpan>& rows);
+/// byte at a time version of find_rows(), for comparison
+size_t find_rows_scalar(const char* buf, size_t len, const CSVDialect& d,
+                        std::vector<RowSpan>& rows);
+
+/// a comparison of a positional column against a literal
+struct Predicate {
+  enum class Op { EQ, NE, LT, LE, GT, GE };
+
+  unsigned column = 0;   // 0-based, _1 is column 0
+  Op op = Op::EQ;
+  std::string str;       // the literal as written, without quotes
+  std::optional<double> num;  // set for numeric literals
+
+  /// false only if a row with this field certainly fails the comparison
+  bool may_match(std::string_view field) const;
+};
+
+class RowFilter {
+  std::vector<Predicate> preds;
+  unsigned max_column = 0;
+  CSVDialect dialect;
+
+public:
+  RowFilter(std::vector<Predicate>&& p, const CSVDialect& d);
+
+  /**
+   * Build a filter from the WHERE clause of @a query.  Returns nothing
+   * unless the clause is made only of comparisons between a positional
+   * column and a literal, joined by AND.
+   */
+  static std::optional<RowFilter> from_query(std::string_view query,
+                                             const CSVDialect& d);
+
+  /**
+   * @a row is an unquoted row without its delimiter, or the part of a row
+   * before its first quote if @a truncated
+   */
+  bool may_match(std::string_view row, bool truncated = false) const;
+
+  const std::vector<Predicate>& get_predicates() const { return preds; }
+  const CSVDialect& get_dialect() const { return dialect; }
+};
+
+/**
+ * Streams object data through a RowFilter, carrying rows that span
+ * chunks over to the next one.  Rows that may match are copied out
+ * whole, so the engine sees the original text.
+ */
+class CSVPushdown {
+  RowFilter filter;
+  bool keep_first_row;
+  bool first_row = true;
+  std::string carry;      // partial row from the previous chunk
+  std::string last_row;   // most recent complete row
+  std::vector<RowSpan> rows;
+
+public:
+  uint64_t rows_in = 0;
+  uint64_t rows_out = 0;
+  uint64_t bytes_in = 0;
+  uint64_t bytes_out = 0;
+
+  CSVPushdown(RowFilter&& f, bool keep_first_row)
+    : filter(std::move(f)), keep_first_row(keep_first_row) {}
+
+  /**
+   * Append the rows of the next chunk that may match to @a out.  On the
+   * @a last chunk the trailing row without a delimiter is included, and
+   * at least one row is passed on so the engine sees the end of the
+   * stream.
+   */
+  void process(const char* data, size_t len, bool last, std::string& out);
+
+  size_t get_num_predicates() const { return filter.get_predicates().size(); }
+
+private:
+  size_t process_rows(const char* buf, size_t len, std::string& out);
+  bool keep(std::string_view row, bool quoted);
+};
+
+} // namespace rgw::s3select
@@ -1141,3 +1141,168 @@ TEST_F(cls_rgw, bi_log_trim)
     EXPECT_FALSE(truncated);
   }
 }
+
+TEST_F(cls_rgw, index_remove_entries)
+{
+  string bucket_oid = str_int("bucket", 9);
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  map<cls_rgw_obj_key, rgw_bucket_entry_ver> listed;
+  for (int i = 0; i < 4; i++) {
+    cls_rgw_obj_key obj = str_int("obj", i);
+    string tag = str_int("tag", i);
+    string loc = str_int("loc", i);
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc, 0, false);
+    rgw_bucket_dir_entry_meta meta;
+    meta.category = RGWObjCategory::None;
+    meta.size = 1024;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 1, obj, meta, 0, false);
+    listed[obj].pool = ioctx.get_id();
+    listed[obj].epoch = 1;
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, 4, 4 * 1024);
+
+  // obj-1 is rewritten and obj-2 has a write pending since they were listed
+  {
+    cls_rgw_obj_key obj = str_int("obj", 1);
+    string tag = "rewrite";
+    string loc = "loc";
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc, 0, false);
+    rgw_bucket_dir_entry_meta meta;
+    meta.category = RGWObjCategory::None;
+    meta.size = 1024;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 2, obj, meta, 0, false);
+  }
+  {
+    cls_rgw_obj_key obj = str_int("obj", 2);
+    string tag = "pending";
+    string loc = "loc";
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc, 0, false);
+  }
+  // not in the index at all
+  listed[cls_rgw_obj_key("missing")] = listed.begin()->second;
+
+  cls_rgw_bucket_remove_entries(op, listed, true, 0, nullptr);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  // only obj-0 and obj-3 are gone, and logged
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, 2, 2 * 1024);
+  map<int, string> oids = { {0, bucket_oid} };
+  map<int, struct rgw_cls_list_ret> list_results;
+  cls_rgw_obj_key start_key("", "");
+  string empty_prefix;
+  string empty_delimiter;
+  ASSERT_EQ(0, CLSRGWIssueBucketList(ioctx, start_key,
+                                     empty_prefix, empty_delimiter,
+                                     100, true, oids, list_results, 1)());
+  auto& m = list_results[0].dir.m;
+  ASSERT_EQ(2u, m.size());
+  EXPECT_EQ(str_int("obj", 1), m.begin()->second.key.name);
+  EXPECT_EQ(str_int("obj", 2), m.rbegin()->second.key.name);
+
+  cls_rgw_bi_log_list_ret bilog;
+  ASSERT_EQ(0, bilog_list(ioctx, bucket_oid, &bilog));
+  ASSERT_EQ(2u, bilog.entries.size());
+  for (auto& e : bilog.entries) {
+    EXPECT_EQ(CLS_RGW_OP_DEL, e.op);
+  }
+  EXPECT_EQ(str_int("obj", 0), bilog.entries.front().object);
+  EXPECT_EQ(str_int("obj", 3), bilog.entries.back().object);
+}
+
+TEST_F(cls_rgw, reshard_log)
+{
+  string bucket_oid = str_int("bucket", 8);
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  auto add_obj = [&] (const cls_rgw_obj_key& obj, int i) {
+    string tag = str_int("tag", i);
+    string loc = str_int("loc", i);
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc);
+    rgw_bucket_dir_entry_meta meta;
+    meta.category = RGWObjCategory::None;
+    meta.size = 1024;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 1, obj, meta);
+  };
+  auto guard = [&] {
+    ObjectWriteOperation op;
+    cls_rgw_guard_bucket_resharding(op, -EBUSY);
+    return ioctx.operate(bucket_oid, &op);
+  };
+
+  // changes made before the log is recording are not logged
+  add_obj(str_int("obj", 0), 0);
+
+  cls_rgw_bucket_instance_entry entry;
+  entry.set_status("new-instance", 3, cls_rgw_reshard_status::IN_LOGRECORD);
+  ASSERT_EQ(0, cls_rgw_set_bucket_resharding(ioctx, bucket_oid, entry));
+  // writes are not held back while recording
+  ASSERT_EQ(0, guard());
+
+  add_obj(str_int("obj", 1), 1);
+  add_obj(cls_rgw_obj_key{str_int("obj", 2), "inst"}, 2);
+  add_obj(str_int("obj", 1), 3);
+
+  list<string> names;
+  bool truncated = true;
+  ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 100,
+                                        names, &truncated));
+  EXPECT_FALSE(truncated);
+  ASSERT_EQ(2u, names.size());
+  EXPECT_EQ(str_int("obj", 1), names.front());
+  EXPECT_EQ(str_int("obj", 2), names.back());
+
+  // paged
+  ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 1,
+                                        names, &truncated));
+  EXPECT_TRUE(truncated);
+  ASSERT_EQ(1u, names.size());
+  ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, names.front(), 1,
+                                        names, &truncated));
+  ASSERT_EQ(1u, names.size());
+  EXPECT_EQ(str_int("obj", 2), names.front());
+
+  // the log is not visible as index entries
+  {
+    list<rgw_cls_bi_entry> entries;
+    ASSERT_EQ(0, cls_rgw_bi_list(ioctx, bucket_oid, "", "", 128,
+                                 &entries, &truncated));
+    // two plain entries, and plain/instance/olh entries for the versioned one
+    EXPECT_EQ(6u, entries.size());
+  }
+
+  // catch-up passes drop the names they replay
+  {
+    ObjectWriteOperation trim;
+    cls_rgw_reshard_log_trim(trim, {str_int("obj", 1)});
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &trim));
+    ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 100,
+                                          names, &truncated));
+    ASSERT_EQ(1u, names.size());
+    EXPECT_EQ(str_int("obj", 2), names.front());
+  }
+  // and a change after that logs the name again
+  add_obj(str_int("obj", 1), 4);
+  ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 100,
+                                        names, &truncated));
+  EXPECT_EQ(2u, names.size());
+
+  // the final catch-up holds writes back
+  entry.set_status("new-instance", 3, cls_rgw_reshard_status::IN_PROGRESS);
+  ASSERT_EQ(0, cls_rgw_set_bucket_resharding(ioctx, bucket_oid, entry));
+  ASSERT_EQ(-EBUSY, guard());
+
+  ObjectWriteOperation trim;
+  cls_rgw_reshard_log_trim(trim);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &trim));
+  ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 100,
+                                        names, &truncated));
+  EXPECT_TRUE(names.empty());
+  EXPECT_FALSE(truncated);
+}
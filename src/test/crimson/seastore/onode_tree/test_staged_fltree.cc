@@ -1217,6 +1217,10 @@ TEST_F(d_seastore_tm_test_t, 6_random_insert_leaf_node)
       auto t = tm->create_transaction();
       tree->validate(*t).unsafe_get();
     }
+    {
+      auto t = tm->create_transaction();
+      tree->scan(*t).unsafe_get();
+    }
     tree.reset();
   });
 }
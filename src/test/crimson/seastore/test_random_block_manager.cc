@@ -0,0 +1,161 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "test/crimson/gtest_seastar.h"
+
+#include "crimson/common/log.h"
+#include "crimson/os/seastore/random_block_manager.h"
+#include "crimson/os/seastore/random_block_manager/ephemeral.h"
+
+using namespace crimson;
+using namespace crimson::os;
+using namespace crimson::os::seastore;
+
+namespace {
+  [[maybe_unused]] seastar::logger& logger() {
+    return crimson::get_logger(ceph_subsys_test);
+  }
+}
+
+struct rbm_test_t : seastar_test_suite_t {
+  random_block_manager::EphemeralRBMDeviceRef device;
+  std::unique_ptr<RandomBlockManager> rbm;
+
+  const size_t block_size;
+
+  rbm_test_t()
+    : device(random_block_manager::create_test_ephemeral()),
+      block_size(device->get_block_size())
+  {}
+
+  seastar::future<> set_up_fut() final {
+    rbm.reset(new RandomBlockManager(*device));
+    return device->init(
+    ).safe_then([this] {
+      return rbm->mkfs(seastore_meta_t{});
+    }).handle_error(
+      crimson::ct_error::all_same_way([] {
+	ASSERT_FALSE("Unable to mkfs");
+      }));
+  }
+
+  seastar::future<> tear_down_fut() final {
+    rbm.reset();
+    return seastar::now();
+  }
+
+  void reopen() {
+    rbm->sync_allocation().unsafe_get0();
+    rbm.reset(new RandomBlockManager(*device));
+    rbm->open().unsafe_get0();
+  }
+
+  rbm_blk_t alloc(size_t blocks) {
+    return rbm->alloc_extent(blocks * block_size).unsafe_get0();
+  }
+
+  bufferptr generate_block(size_t blocks, char c) {
+    auto bp = bufferptr(ceph::buffer::create_page_aligned(
+      blocks * block_size));
+    ::memset(bp.c_str(), c, bp.length());
+    return bp;
+  }
+
+  void write(rbm_blk_t blk, bufferptr bp) {
+    rbm->write(blk, bp).unsafe_get0();
+  }
+
+  void check(rbm_blk_t blk, const bufferptr &expected) {
+    auto bp = bufferptr(ceph::buffer::create_page_aligned(
+      expected.length()));
+    rbm->read(blk, bp).unsafe_get0();
+    EXPECT_EQ(::memcmp(bp.c_str(), expected.c_str(), bp.length()), 0);
+  }
+};
+
+TEST_F(rbm_test_t, mkfs_and_open)
+{
+  run_async([this] {
+    auto data_blocks = rbm->get_data_blocks();
+    EXPECT_GT(data_blocks, 0);
+    EXPECT_EQ(rbm->get_free_blocks(), data_blocks);
+    EXPECT_LT(data_blocks * block_size, device->get_size());
+    reopen();
+    EXPECT_EQ(rbm->get_data_blocks(), data_blocks);
+    EXPECT_EQ(rbm->get_free_blocks(), data_blocks);
+  });
+}
+
+TEST_F(rbm_test_t, alloc_and_free)
+{
+  run_async([this] {
+    auto free = rbm->get_free_blocks();
+    auto a = alloc(1);
+    auto b = alloc(4);
+    EXPECT_NE(a, b);
+    EXPECT_TRUE(rbm->is_allocated(a));
+    for (auto i = b; i < b + 4; ++i) {
+      EXPECT_TRUE(rbm->is_allocated(i));
+    }
+    EXPECT_EQ(rbm->get_free_blocks(), free - 5);
+
+    rbm->free_extent(a, block_size);
+    EXPECT_FALSE(rbm->is_allocated(a));
+    EXPECT_EQ(rbm->get_free_blocks(), free - 4);
+    rbm->free_extent(b, 4 * block_size);
+    EXPECT_EQ(rbm->get_free_blocks(), free);
+  });
+}
+
+TEST_F(rbm_test_t, overwrite_in_place)
+{
+  run_async([this] {
+    auto blk = alloc(2);
+    write(blk, generate_block(2, 'a'));
+    check(blk, generate_block(2, 'a'));
+
+    auto free = rbm->get_free_blocks();
+    write(blk, generate_block(2, 'b'));
+    check(blk, generate_block(2, 'b'));
+    EXPECT_EQ(rbm->get_free_blocks(), free);
+  });
+}
+
+TEST_F(rbm_test_t, allocation_survives_reopen)
+{
+  run_async([this] {
+    auto a = alloc(3);
+    auto b = alloc(1);
+    write(a, generate_block(3, 'x'));
+    rbm->free_extent(b, block_size);
+    auto free = rbm->get_free_blocks();
+
+    reopen();
+    EXPECT_EQ(rbm->get_free_blocks(), free);
+    for (auto i = a; i < a + 3; ++i) {
+      EXPECT_TRUE(rbm->is_allocated(i));
+    }
+    EXPECT_FALSE(rbm->is_allocated(b));
+    check(a, generate_block(3, 'x'));
+  });
+}
+
+TEST_F(rbm_test_t, reuse_freed_space)
+{
+  run_async([this] {
+    std::vector<rbm_blk_t> blks;
+    while (rbm->get_free_blocks() > 0) {
+      blks.push_back(alloc(1));
+    }
+    auto enospc = rbm->alloc_extent(block_size).safe_then(
+      [](auto) { return false; },
+      crimson::ct_error::enospc::handle([] { return true; })
+    ).unsafe_get0();
+    EXPECT_TRUE(enospc);
+
+    rbm->free_extent(blks[3], block_size);
+    rbm->free_extent(blks[4], block_size);
+    EXPECT_EQ(alloc(2), blks[3]);
+    EXPECT_EQ(rbm->get_free_blocks(), 0);
+  });
+}
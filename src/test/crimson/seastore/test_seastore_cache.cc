@@ -20,6 +20,8 @@ namespace {
 }
 
 struct cache_test_t : public seastar_test_suite_t {
+  static constexpr size_t LRU_EXTENTS = 16;
+
   segment_manager::EphemeralSegmentManagerRef segment_manager;
   Cache cache;
   paddr_t current{0, 0};
@@ -27,7 +29,7 @@ struct cache_test_t : public seastar_test_suite_t {
 
   cache_test_t()
     : segment_manager(segment_manager::create_test_ephemeral()),
-      cache(*segment_manager) {}
+      cache(*segment_manager, LRU_EXTENTS * TestBlockPhysical::SIZE) {}
 
   seastar::future<std::optional<paddr_t>> submit_transaction(
     TransactionRef t) {
@@ -233,3 +235,49 @@ TEST_F(cache_test_t, test_dirty_extent)
     }
   });
 }
+
+TEST_F(cache_test_t, test_lru_eviction)
+{
+  run_async([this] {
+    std::vector<std::pair<paddr_t, uint32_t>> written;
+    for (unsigned i = 0; i < 2 * LRU_EXTENTS; ++i) {
+      auto t = get_transaction();
+      auto extent = cache.alloc_new_extent<TestBlockPhysical>(
+	*t,
+	TestBlockPhysical::SIZE);
+      extent->set_contents('a' + i);
+      auto csum = extent->get_crc32c();
+      auto ret = submit_transaction(std::move(t)).get0();
+      ASSERT_TRUE(ret);
+      written.emplace_back(extent->get_paddr(), csum);
+    }
+    ASSERT_EQ(cache.get_lru_num_extents(), LRU_EXTENTS);
+    ASSERT_EQ(cache.get_lru_size(), LRU_EXTENTS * TestBlockPhysical::SIZE);
+
+    {
+      // the most recently written blocks are still cached without any
+      // other reference, the oldest have been evicted
+      auto t = get_transaction();
+      ASSERT_EQ(
+	cache.get_extent_if_cached(*t, written.back().first, nullptr),
+	Transaction::get_extent_ret::PRESENT);
+      ASSERT_EQ(
+	cache.get_extent_if_cached(*t, written.front().first, nullptr),
+	Transaction::get_extent_ret::ABSENT);
+    }
+    {
+      // an evicted block is read back and becomes the most recently used
+      auto t = get_transaction();
+      auto [addr, csum] = written.front();
+      auto extent = cache.get_extent<TestBlockPhysical>(
+	*t,
+	addr,
+	TestBlockPhysical::SIZE).unsafe_get0();
+      ASSERT_EQ(extent->get_crc32c(), csum);
+      ASSERT_EQ(cache.get_lru_num_extents(), LRU_EXTENTS);
+      ASSERT_EQ(
+	cache.get_extent_if_cached(*t, written[LRU_EXTENTS].first, nullptr),
+	Transaction::get_extent_ret::ABSENT);
+    }
+  });
+}
@@ -5,6 +5,8 @@
 
 #include <random>
 
+#include <seastar/core/sleep.hh>
+
 #include "crimson/common/log.h"
 #include "crimson/os/seastore/journal.h"
 #include "crimson/os/seastore/segment_manager/ephemeral.h"
@@ -62,8 +64,78 @@ struct record_validator_t {
   }
 };
 
+/**
+ * Forwards to another SegmentManager, but holds each segment write for
+ * write_delay so that the journal sees several of them in flight, as it
+ * would on a real device.
+ */
+struct delayed_segment_manager_t final : SegmentManager {
+  struct delayed_segment_t final : Segment {
+    delayed_segment_manager_t &manager;
+    SegmentRef segment;
+
+    delayed_segment_t(delayed_segment_manager_t &manager, SegmentRef segment)
+      : manager(manager), segment(std::move(segment)) {}
+
+    segment_id_t get_segment_id() const final {
+      return segment->get_segment_id();
+    }
+    segment_off_t get_write_ptr() const final {
+      return segment->get_write_ptr();
+    }
+    segment_off_t get_write_capacity() const final {
+      return segment->get_write_capacity();
+    }
+    close_ertr::future<> close() final {
+      return segment->close();
+    }
+    write_ertr::future<> write(
+      segment_off_t offset, ceph::bufferlist bl) final {
+      if (manager.write_delay == std::chrono::milliseconds::zero()) {
+	return segment->write(offset, std::move(bl));
+      }
+      ++manager.writes_in_flight;
+      return seastar::sleep(manager.write_delay
+      ).then([this, ref=SegmentRef(this), offset, bl=std::move(bl)]() mutable {
+	return segment->write(offset, std::move(bl));
+      }).safe_then([this, ref=SegmentRef(this)] {
+	--manager.writes_in_flight;
+      });
+    }
+  };
+
+  SegmentManager &sm;
+  std::chrono::milliseconds write_delay{0};
+  size_t writes_in_flight = 0;
+
+  delayed_segment_manager_t(SegmentManager &sm) : sm(sm) {}
+
+  open_ertr::future<SegmentRef> open(segment_id_t id) final {
+    return sm.open(id).safe_then([this](auto segment) {
+      return SegmentRef(new delayed_segment_t(*this, std::move(segment)));
+    });
+  }
+  release_ertr::future<> release(segment_id_t id) final {
+    return sm.release(id);
+  }
+  using SegmentManager::read;
+  read_ertr::future<> read(
+    paddr_t addr,
+    size_t len,
+    ceph::bufferptr &out) final {
+    return sm.read(addr, len, out);
+  }
+  size_t get_size() const final { return sm.get_size(); }
+  segment_off_t get_block_size() const final { return sm.get_block_size(); }
+  segment_off_t get_segment_size() const final {
+    return sm.get_segment_size();
+  }
+  const seastore_meta_t &get_meta() const final { return sm.get_meta(); }
+};
+
 struct journal_test_t : seastar_test_suite_t, JournalSegmentProvider {
   segment_manager::EphemeralSegmentManagerRef segment_manager;
+  delayed_segment_manager_t delayed;
   WritePipeline pipeline;
   std::unique_ptr<Journal> journal;
 
@@ -75,6 +147,7 @@ struct journal_test_t : seastar_test_suite_t, JournalSegmentProvider {
 
   journal_test_t()
     : segment_manager(segment_manager::create_test_ephemeral()),
+      delayed(*segment_manager),
       block_size(segment_manager->get_block_size())
   {
   }
@@ -90,7 +163,7 @@ struct journal_test_t : seastar_test_suite_t, JournalSegmentProvider {
   void update_journal_tail_committed(journal_seq_t paddr) final {}
 
   seastar::future<> set_up_fut() final {
-    journal.reset(new Journal(*segment_manager));
+    journal.reset(new Journal(delayed));
     journal->set_segment_provider(this);
     journal->set_write_pipeline(&pipeline);
     return segment_manager->init(
@@ -107,7 +180,7 @@ struct journal_test_t : seastar_test_suite_t, JournalSegmentProvider {
   auto replay(T &&f) {
     return journal->close(
     ).safe_then([this, f=std::move(f)]() mutable {
-      journal.reset(new Journal(*segment_manager));
+      journal.reset(new Journal(delayed));
       journal->set_segment_provider(this);
       journal->set_write_pipeline(&pipeline);
       return journal->replay(std::forward<T>(std::move(f)));
@@ -162,6 +235,21 @@ struct journal_test_t : seastar_test_suite_t, JournalSegmentProvider {
     return addr;
   }
 
+  /// submit without waiting for the record to be written
+  template <typename... T>
+  auto submit_record_async(T&&... _record) {
+    auto record{std::forward<T>(_record)...};
+    records.push_back(record);
+    auto idx = records.size() - 1;
+    auto handle = std::make_unique<OrderingHandle>(
+      get_dummy_ordering_handle());
+    auto fut = journal->submit_record(std::move(record), *handle);
+    return std::move(fut).safe_then(
+      [this, idx, handle=std::move(handle)](auto p) {
+	records[idx].record_final_offset = p.first;
+      });
+  }
+
   seastar::future<> tear_down_fut() final {
     return seastar::now();
   }
@@ -264,3 +352,48 @@ TEST_F(journal_test_t, roll_journal_and_replay)
    replay_and_check();
  });
 }
+
+TEST_F(journal_test_t, replay_concurrent_records)
+{
+ run_async([this] {
+   // hold the first writes long enough for the remaining records to be
+   // submitted and batched behind them
+   delayed.write_delay = std::chrono::milliseconds(10);
+   std::vector<Journal::submit_record_ertr::future<>> futs;
+   for (unsigned i = 0; i < 32; ++i) {
+     futs.push_back(submit_record_async(record_t{
+       { generate_extent(1) },
+       { generate_delta(23 + i) }
+       }));
+   }
+   for (auto &fut : futs) {
+     std::move(fut).unsafe_get0();
+   }
+   ASSERT_EQ(32u, journal->get_num_records());
+   // more than one record per write
+   ASSERT_GT(journal->get_num_records(), journal->get_num_writes());
+   delayed.write_delay = std::chrono::milliseconds::zero();
+   replay_and_check();
+ });
+}
+
+TEST_F(journal_test_t, close_waits_for_writes)
+{
+ run_async([this] {
+   delayed.write_delay = std::chrono::milliseconds(10);
+   std::vector<Journal::submit_record_ertr::future<>> futs;
+   for (unsigned i = 0; i < 8; ++i) {
+     futs.push_back(submit_record_async(record_t{
+       { generate_extent(1) },
+       { generate_delta(23 + i) }
+       }));
+   }
+   journal->close().unsafe_get0();
+   ASSERT_EQ(0u, delayed.writes_in_flight);
+   for (auto &fut : futs) {
+     std::move(fut).unsafe_get0();
+   }
+   delayed.write_delay = std::chrono::milliseconds::zero();
+   replay_and_check();
+ });
+}
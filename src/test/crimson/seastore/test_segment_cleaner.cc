@@ -0,0 +1,69 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "test/crimson/gtest_seastar.h"
+
+#include "crimson/os/seastore/segment_cleaner.h"
+
+using namespace crimson;
+using namespace crimson::os;
+using namespace crimson::os::seastore;
+
+namespace {
+  constexpr size_t SEGMENTS = 8;
+  constexpr size_t SEGMENT_SIZE = 1 << 20;
+
+  /// journal tail such that segments with seq >= @seq are still in the journal
+  journal_seq_t tail_at(segment_seq_t seq) {
+    return journal_seq_t{seq, paddr_t{}};
+  }
+}
+
+TEST(segment_gc_index_test, greedy_picks_least_live)
+{
+  SegmentGCIndex index(
+    SegmentGCIndex::policy_t::GREEDY, SEGMENTS, SEGMENT_SIZE);
+  index.insert(0, 1, SEGMENT_SIZE / 2);
+  index.insert(1, 2, SEGMENT_SIZE / 8);
+  index.insert(2, 3, SEGMENT_SIZE / 4);
+  ASSERT_EQ(1u, index.get_victim(tail_at(10), 10));
+
+  index.update(1, SEGMENT_SIZE - 1);
+  ASSERT_EQ(2u, index.get_victim(tail_at(10), 10));
+
+  index.remove(2);
+  ASSERT_FALSE(index.contains(2));
+  ASSERT_EQ(0u, index.get_victim(tail_at(10), 10));
+}
+
+TEST(segment_gc_index_test, skips_journal_segments)
+{
+  for (auto policy : {SegmentGCIndex::policy_t::GREEDY,
+		      SegmentGCIndex::policy_t::COST_BENEFIT}) {
+    SegmentGCIndex index(policy, SEGMENTS, SEGMENT_SIZE);
+    index.insert(0, 1, SEGMENT_SIZE / 2);
+    index.insert(1, 2, 0);
+    index.insert(2, 3, 0);
+    // 1 and 2 are empty but still in the journal
+    ASSERT_EQ(0u, index.get_victim(tail_at(2), 3));
+    ASSERT_EQ(NULL_SEG_ID, index.get_victim(tail_at(1), 3));
+  }
+}
+
+TEST(segment_gc_index_test, cost_benefit_prefers_cold)
+{
+  SegmentGCIndex index(
+    SegmentGCIndex::policy_t::COST_BENEFIT, SEGMENTS, SEGMENT_SIZE);
+  // older and 60% live: 0.4 * 6 / 1.6 = 1.5
+  index.insert(0, 5, SEGMENT_SIZE * 6 / 10);
+  // young and 40% live: 0.6 * 2 / 1.4 = 0.86
+  index.insert(1, 9, SEGMENT_SIZE * 4 / 10);
+  ASSERT_EQ(0u, index.get_victim(tail_at(11), 10));
+
+  // once the young segment is nearly empty it is worth more than the
+  // older one: 0.95 * 2 / 1.05 = 1.8
+  index.update(1, SEGMENT_SIZE / 20);
+  ASSERT_EQ(1u, index.get_victim(tail_at(11), 10));
+  index.remove(1);
+  ASSERT_EQ(0u, index.get_victim(tail_at(11), 10));
+}
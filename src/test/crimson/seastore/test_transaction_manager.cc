@@ -2,9 +2,11 @@
 // vim: ts=8 sw=2 smarttab
 
 #include <random>
+#include <set>
 
 #include <boost/iterator/counting_iterator.hpp>
 
+#include "common/ceph_time.h"
 #include "test/crimson/gtest_seastar.h"
 #include "test/crimson/seastore/transaction_manager_test_state.h"
 
@@ -53,13 +55,14 @@ std::ostream &operator<<(std::ostream &lhs, const test_extent_record_t &rhs) {
 
 struct transaction_manager_test_t :
   public seastar_test_suite_t,
-  TMTestState {
+  TMTestState,
+  ::testing::WithParamInterface<TMTestState::backend_t> {
 
   std::random_device rd;
   std::mt19937 gen;
 
   transaction_manager_test_t()
-    : gen(rd()) {
+    : TMTestState(GetParam()), gen(rd()) {
     init();
   }
 
@@ -389,14 +392,28 @@ struct transaction_manager_test_t :
   bool check_usage() {
     auto t = create_weak_transaction();
     SpaceTrackerIRef tracker(segment_cleaner->get_empty_space_tracker());
+    // extents in the random block manager are not tracked by the cleaner
+    size_t rbm_used = 0;
+    bool rbm_ok = true;
     lba_manager->scan_mapped_space(
       *t.t,
-      [&tracker](auto offset, auto len) {
+      [this, &tracker, &rbm_used, &rbm_ok](auto offset, auto len) {
+	if (offset.is_rbm()) {
+	  rbm_used += len;
+	  rbm_ok = rbm_ok && rbm->is_allocated(get_rbm_blk(offset));
+	  return;
+	}
 	tracker->allocate(
 	  offset.segment,
 	  offset.offset,
 	  len);
       }).unsafe_get0();
+    if (rbm) {
+      EXPECT_TRUE(rbm_ok);
+      EXPECT_EQ(
+	rbm->get_data_blocks() - rbm_used / rbm->get_block_size(),
+	rbm->get_free_blocks());
+    }
     return segment_cleaner->debug_check_space(*tracker);
   }
 
@@ -533,7 +550,7 @@ struct transaction_manager_test_t :
   }
 };
 
-TEST_F(transaction_manager_test_t, basic)
+TEST_P(transaction_manager_test_t, basic)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -554,7 +571,7 @@ TEST_F(transaction_manager_test_t, basic)
   });
 }
 
-TEST_F(transaction_manager_test_t, mutate)
+TEST_P(transaction_manager_test_t, mutate)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -592,7 +609,7 @@ TEST_F(transaction_manager_test_t, mutate)
   });
 }
 
-TEST_F(transaction_manager_test_t, allocate_lba_conflict)
+TEST_P(transaction_manager_test_t, allocate_lba_conflict)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -625,7 +642,7 @@ TEST_F(transaction_manager_test_t, allocate_lba_conflict)
   });
 }
 
-TEST_F(transaction_manager_test_t, mutate_lba_conflict)
+TEST_P(transaction_manager_test_t, mutate_lba_conflict)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -664,7 +681,7 @@ TEST_F(transaction_manager_test_t, mutate_lba_conflict)
   });
 }
 
-TEST_F(transaction_manager_test_t, concurrent_mutate_lba_no_conflict)
+TEST_P(transaction_manager_test_t, concurrent_mutate_lba_no_conflict)
 {
   constexpr laddr_t SIZE = 4096;
   constexpr size_t NUM = 500;
@@ -696,7 +713,7 @@ TEST_F(transaction_manager_test_t, concurrent_mutate_lba_no_conflict)
   });
 }
 
-TEST_F(transaction_manager_test_t, create_remove_same_transaction)
+TEST_P(transaction_manager_test_t, create_remove_same_transaction)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -727,7 +744,7 @@ TEST_F(transaction_manager_test_t, create_remove_same_transaction)
   });
 }
 
-TEST_F(transaction_manager_test_t, split_merge_read_same_transaction)
+TEST_P(transaction_manager_test_t, split_merge_read_same_transaction)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -757,7 +774,7 @@ TEST_F(transaction_manager_test_t, split_merge_read_same_transaction)
   });
 }
 
-TEST_F(transaction_manager_test_t, inc_dec_ref)
+TEST_P(transaction_manager_test_t, inc_dec_ref)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -804,7 +821,7 @@ TEST_F(transaction_manager_test_t, inc_dec_ref)
   });
 }
 
-TEST_F(transaction_manager_test_t, cause_lba_split)
+TEST_P(transaction_manager_test_t, cause_lba_split)
 {
   constexpr laddr_t SIZE = 4096;
   run_async([this] {
@@ -822,7 +839,7 @@ TEST_F(transaction_manager_test_t, cause_lba_split)
   });
 }
 
-TEST_F(transaction_manager_test_t, random_writes)
+TEST_P(transaction_manager_test_t, random_writes)
 {
   constexpr size_t TOTAL = 4<<20;
   constexpr size_t BSIZE = 4<<10;
@@ -865,7 +882,7 @@ TEST_F(transaction_manager_test_t, random_writes)
   });
 }
 
-TEST_F(transaction_manager_test_t, random_writes_concurrent)
+TEST_P(transaction_manager_test_t, random_writes_concurrent)
 {
   constexpr unsigned WRITE_STREAMS = 256;
 
@@ -921,3 +938,197 @@ TEST_F(transaction_manager_test_t, random_writes_concurrent)
     );
   });
 }
+
+TEST_P(transaction_manager_test_t, replay_large_journal)
+{
+  constexpr size_t TOTAL = 16<<20;
+  constexpr size_t BSIZE = 4<<10;
+  constexpr size_t BLOCKS = TOTAL / BSIZE;
+  constexpr unsigned TRANSACTIONS = 8192;
+  constexpr unsigned MUTATIONS_PER_TRANSACTION = 4;
+  run_async([this] {
+    for (unsigned i = 0; i < BLOCKS; ++i) {
+      auto t = create_transaction();
+      auto extent = alloc_extent(
+	t,
+	i * BSIZE,
+	BSIZE);
+      ASSERT_EQ(i * BSIZE, extent->get_laddr());
+      submit_transaction(std::move(t));
+    }
+    // drop the cache so that replay has to read the extents back in
+    replay();
+
+    for (unsigned i = 0; i < TRANSACTIONS; ++i) {
+      auto t = create_transaction();
+      std::set<laddr_t> mutated;
+      for (unsigned j = 0; j < MUTATIONS_PER_TRANSACTION; ++j) {
+	auto laddr = get_random_laddr(BSIZE, TOTAL);
+	if (!mutated.insert(laddr).second) {
+	  continue;
+	}
+	auto ext = get_extent(t, laddr, BSIZE);
+	auto mut = mutate_extent(t, ext);
+      }
+      submit_transaction(std::move(t));
+    }
+
+    auto start = ceph::mono_clock::now();
+    replay();
+    logger().info(
+      "replay_large_journal: replaying {} transactions took {}s",
+      TRANSACTIONS,
+      std::chrono::duration<double>(ceph::mono_clock::now() - start).count());
+    check();
+  });
+}
+
+TEST_P(transaction_manager_test_t, gc_write_amplification)
+{
+  constexpr size_t BSIZE = 64<<10;
+  constexpr size_t BLOCKS = 256;
+  constexpr size_t HOT_BLOCKS = BLOCKS / 5;
+  constexpr unsigned TRANSACTIONS = 1024;
+  constexpr unsigned WRITES_PER_TRANSACTION = 2;
+  if (backend == backend_t::RBM) {
+    GTEST_SKIP() << "data extents are not written to segments";
+  }
+  run_async([this] {
+    // runs the same skewed overwrite workload on a fresh device under
+    // @policy and returns the resulting write amplification
+    auto run = [this](SegmentGCIndex::policy_t policy) {
+      tm_teardown().get0();
+      destroy();
+      create_devices();
+      gc_policy = policy;
+      init();
+      test_mappings.clear();
+      tm_setup().get0();
+
+      std::vector<laddr_t> blocks;
+      for (unsigned i = 0; i < BLOCKS; ++i) {
+	auto t = create_transaction();
+	auto extent = alloc_extent(
+	  t,
+	  i * BSIZE,
+	  BSIZE);
+	blocks.push_back(extent->get_laddr());
+	submit_transaction(std::move(t));
+      }
+
+      // 80% of the overwrites go to 20% of the blocks
+      std::mt19937 workload_gen(0);
+      std::bernoulli_distribution hot(0.8);
+      std::uniform_int_distribution<size_t> hot_block(0, HOT_BLOCKS - 1);
+      std::uniform_int_distribution<size_t> cold_block(HOT_BLOCKS, BLOCKS - 1);
+      for (unsigned i = 0; i < TRANSACTIONS; ++i) {
+	auto t = create_transaction();
+	std::set<size_t> written;
+	for (unsigned j = 0; j < WRITES_PER_TRANSACTION; ++j) {
+	  auto idx = hot(workload_gen) ?
+	    hot_block(workload_gen) : cold_block(workload_gen);
+	  if (!written.insert(idx).second) {
+	    continue;
+	  }
+	  auto extent = alloc_extent(
+	    t,
+	    blocks[idx],
+	    BSIZE);
+	  dec_ref(t, blocks[idx]);
+	  blocks[idx] = extent->get_laddr();
+	}
+	submit_transaction(std::move(t));
+      }
+      check();
+
+      const auto &stats = segment_cleaner->get_gc_stats();
+      logger().info(
+	"gc_write_amplification: policy {} written {} gc rewritten {} "
+	"segments reclaimed {} write amplification {}",
+	policy == SegmentGCIndex::policy_t::GREEDY ? "greedy" : "cost-benefit",
+	stats.bytes_written,
+	stats.gc_bytes_rewritten,
+	stats.segments_reclaimed,
+	stats.get_write_amplification());
+      EXPECT_GT(stats.segments_reclaimed, 0u);
+      return stats.get_write_amplification();
+    };
+
+    auto greedy = run(SegmentGCIndex::policy_t::GREEDY);
+    auto cost_benefit = run(SegmentGCIndex::policy_t::COST_BENEFIT);
+    EXPECT_LE(cost_benefit, greedy);
+  });
+}
+
+TEST_P(transaction_manager_test_t, rbm_overwrite_in_place)
+{
+  if (backend != backend_t::RBM) {
+    GTEST_SKIP() << "data extents are only placed in the random block manager";
+  }
+  constexpr laddr_t SIZE = 4096;
+  // enough deltas to push the journal past its target length, so that
+  // the segment cleaner has to write the dirty extent back
+  constexpr unsigned TRANSACTIONS = 8192;
+  run_async([this] {
+    constexpr laddr_t ADDR = 0xFF * SIZE;
+    const auto free_blocks = rbm->get_free_blocks();
+    paddr_t paddr;
+    {
+      auto t = create_transaction();
+      auto extent = alloc_extent(t, ADDR, SIZE, 'a');
+      paddr = extent->get_paddr();
+      ASSERT_TRUE(paddr.is_rbm());
+      submit_transaction(std::move(t));
+    }
+    ASSERT_EQ(free_blocks - 1, rbm->get_free_blocks());
+
+    auto read_block = [this, paddr] {
+      auto bp = ceph::bufferptr(ceph::buffer::create_page_aligned(SIZE));
+      rbm->read(get_rbm_blk(paddr), bp).unsafe_get0();
+      return bp;
+    };
+    // written in place ahead of the record
+    auto initial = read_block();
+    for (unsigned i = 0; i < SIZE; ++i) {
+      ASSERT_EQ('a', initial.c_str()[i]);
+    }
+
+    for (unsigned i = 0; i < TRANSACTIONS; ++i) {
+      auto t = create_transaction();
+      auto ext = mutate_addr(t, ADDR, SIZE);
+      ASSERT_EQ(paddr, ext->get_paddr());
+      submit_transaction(std::move(t));
+    }
+    {
+      auto t = create_transaction();
+      ASSERT_EQ(paddr, get_extent(t, ADDR, SIZE)->get_paddr());
+    }
+    // written back where it was rather than moved
+    auto written = read_block();
+    EXPECT_NE(0, memcmp(initial.c_str(), written.c_str(), SIZE));
+    ASSERT_EQ(free_blocks - 1, rbm->get_free_blocks());
+
+    replay();
+    check();
+    ASSERT_EQ(free_blocks - 1, rbm->get_free_blocks());
+
+    // released without being read back into the cache
+    replay();
+    {
+      auto t = create_transaction();
+      dec_ref(t, ADDR);
+      submit_transaction(std::move(t));
+    }
+    ASSERT_EQ(free_blocks, rbm->get_free_blocks());
+    replay();
+    ASSERT_EQ(free_blocks, rbm->get_free_blocks());
+    check();
+  });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  transaction_manager_test,
+  transaction_manager_test_t,
+  ::testing::Values(
+    TMTestState::backend_t::SEGMENTED,
+    TMTestState::backend_t::RBM));
@@ -10,32 +10,67 @@
 #include "crimson/os/seastore/transaction_manager.h"
 #include "crimson/os/seastore/segment_manager/ephemeral.h"
 #include "crimson/os/seastore/segment_manager.h"
+#include "crimson/os/seastore/random_block_manager.h"
+#include "crimson/os/seastore/random_block_manager/ephemeral.h"
 
 using namespace crimson;
 using namespace crimson::os;
 using namespace crimson::os::seastore;
 
 class TMTestState {
+public:
+  /// where the transaction manager places data extents
+  enum class backend_t {
+    SEGMENTED,  ///< in segments, with everything else
+    RBM         ///< in a RandomBlockManager over an EphemeralRBMDevice
+  };
+
 protected:
+  const backend_t backend;
   std::unique_ptr<segment_manager::EphemeralSegmentManager> segment_manager;
+  random_block_manager::EphemeralRBMDeviceRef rbm_device;
+  RandomBlockManagerRef rbm;
   std::unique_ptr<SegmentCleaner> segment_cleaner;
   std::unique_ptr<Journal> journal;
   std::unique_ptr<Cache> cache;
   LBAManagerRef lba_manager;
   std::unique_ptr<TransactionManager> tm;
+  SegmentGCIndex::policy_t gc_policy = SegmentGCIndex::policy_t::COST_BENEFIT;
 
-  TMTestState()
-    : segment_manager(segment_manager::create_test_ephemeral()) {
+  TMTestState(backend_t backend = backend_t::SEGMENTED)
+    : backend(backend) {
+    create_devices();
     init();
   }
 
+  /// (re)creates unformatted devices for the configured backend
+  void create_devices() {
+    segment_manager = segment_manager::create_test_ephemeral();
+    rbm.reset();
+    rbm_device.reset();
+    if (backend == backend_t::RBM) {
+      rbm_device = random_block_manager::create_test_ephemeral();
+      rbm = std::make_unique<RandomBlockManager>(*rbm_device);
+    }
+  }
+
+  /// reopens the RandomBlockManager from what is on its device
+  seastar::future<> reopen_rbm() {
+    if (!rbm) {
+      return seastar::now();
+    }
+    rbm = std::make_unique<RandomBlockManager>(*rbm_device);
+    return rbm->open().handle_error(crimson::ct_error::assert_all{});
+  }
+
   void init() {
-    segment_cleaner = std::make_unique<SegmentCleaner>(
-      SegmentCleaner::config_t::default_from_segment_manager(
-	*segment_manager),
-      true);
+    auto config = SegmentCleaner::config_t::default_from_segment_manager(
+      *segment_manager);
+    config.gc_policy = gc_policy;
+    segment_cleaner = std::make_unique<SegmentCleaner>(config, true);
     journal = std::make_unique<Journal>(*segment_manager);
-    cache = std::make_unique<Cache>(*segment_manager);
+    cache = std::make_unique<Cache>(
+      *segment_manager, Cache::DEFAULT_LRU_CAPACITY, rbm.get());
     lba_manager = lba_manager::create_lba_manager(*segment_manager, *cache);
     tm = std::make_unique<TransactionManager>(
       *segment_manager, *segment_cleaner, *journal, *cache, *lba_manager);
@@ -55,24 +90,39 @@ protected:
   void restart() {
     tm->close().unsafe_get();
     destroy();
-    static_cast<segment_manager::EphemeralSegmentManager*>(&*segment_manager)->remount();
+    segment_manager->remount();
+    reopen_rbm().get0();
     init();
     tm->mount().unsafe_get();
   }
 
   seastar::future<> tm_setup() {
     return segment_manager->init(
-    ).safe_then([this] {
-      return tm->mkfs();
-    }).safe_then([this] {
-      return tm->close();
-    }).safe_then([this] {
+    ).handle_error(crimson::ct_error::assert_all{}
+    ).then([this] {
+      if (!rbm) {
+	return seastar::now();
+      }
+      return rbm_device->init(
+      ).safe_then([this] {
+	return rbm->mkfs(seastore_meta_t{});
+      }).safe_then([this] {
+	return rbm->open();
+      }).handle_error(crimson::ct_error::assert_all{});
+    }).then([this] {
+      return tm->mkfs(
+      ).safe_then([this] {
+	return tm->close();
+      }).handle_error(crimson::ct_error::assert_all{});
+    }).then([this] {
       destroy();
-      static_cast<segment_manager::EphemeralSegmentManager*>(
-	&*segment_manager)->remount();
+      segment_manager->remount();
+      return reopen_rbm();
+    }).then([this] {
       init();
-      return tm->mount();
-    }).handle_error(crimson::ct_error::assert_all{});
+      return tm->mount(
+      ).handle_error(crimson::ct_error::assert_all{});
+    });
   }
 
   seastar::future<> tm_teardown() {
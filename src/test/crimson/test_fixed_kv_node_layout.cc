@@ -2,7 +2,10 @@
 // vim: ts=8 sw=2 smarttab
 
 #include <stdio.h>
+#include <chrono>
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -339,6 +342,72 @@ TEST(FixedKVNodeTest, balanced) {
   run_balance_test(CAPACITY / 2, CAPACITY / 2, false);
 }
 
+void run_search_test(unsigned size)
+{
+  auto node = TestNode();
+  auto iter = node.begin();
+  // even keys, so that odd keys fall between them
+  for (unsigned i = 0; i < size; ++i) {
+    node.journal_insert(iter, 2 * i + 2, test_val_t{i, 0}, nullptr);
+    ++iter;
+  }
+  ASSERT_EQ(node.get_size(), size);
+
+  for (unsigned key = 0; key < 2 * size + 4; ++key) {
+    auto lb = node.begin();
+    while (lb != node.end() && lb->get_key() < key) {
+      ++lb;
+    }
+    auto ub = node.begin();
+    while (ub != node.end() && ub->get_key() <= key) {
+      ++ub;
+    }
+    ASSERT_EQ(node.lower_bound(key), lb);
+    ASSERT_EQ(node.upper_bound(key), ub);
+    if (lb != node.end() && lb->get_key() == key) {
+      ASSERT_EQ(node.find(key), lb);
+    } else {
+      ASSERT_EQ(node.find(key), node.end());
+    }
+  }
+}
+
+TEST(FixedKVNodeTest, search) {
+  for (unsigned size : {0u, 1u, 2u, 15u, 16u, 17u, 32u, 33u, 100u,
+			unsigned(CAPACITY - 1), unsigned(CAPACITY)}) {
+    run_search_test(size);
+  }
+}
+
+TEST(FixedKVNodeTest, lookup_benchmark) {
+  constexpr unsigned LOOKUPS = 1 << 22;
+
+  auto node = TestNode();
+  auto iter = node.begin();
+  for (unsigned i = 0; i < CAPACITY; ++i) {
+    node.journal_insert(iter, 2 * i, test_val_t{i, 0}, nullptr);
+    ++iter;
+  }
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<uint32_t> dist(0, 2 * CAPACITY);
+  std::vector<uint32_t> keys(LOOKUPS);
+  for (auto &k : keys) {
+    k = dist(gen);
+  }
+
+  uint64_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto k : keys) {
+    found += node.upper_bound(k).get_offset();
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+    std::chrono::steady_clock::now() - start;
+  std::cout << "lookup_benchmark: " << LOOKUPS << " lookups in a node of "
+	    << CAPACITY << " keys, " << elapsed.count() / LOOKUPS
+	    << "ns per lookup (" << found << ")" << std::endl;
+}
+
 void run_replay_test(
   std::vector<std::function<void(TestNode&, TestNode::delta_buffer_t&)>> &&f
 ) {
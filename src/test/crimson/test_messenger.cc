@@ -14,6 +14,7 @@
 
 #include <map>
 #include <random>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/program_options.hpp>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
@@ -378,6 +379,133 @@ static seastar::future<> test_concurrent_dispatch(bool v2)
   });
 }
 
+static seastar::future<> test_aligned_data(unsigned count, size_t data_size)
+{
+  struct test_state {
+    struct Server final
+      : public crimson::net::Dispatcher {
+      crimson::net::MessengerRef msgr;
+      unsigned count;
+      bufferlist expected;
+      unsigned received = 0;
+      seastar::promise<> on_done;
+      crimson::auth::DummyAuthClientServer dummy_auth;
+
+      Server(unsigned count, const bufferlist& expected)
+        : count(count), expected(expected) {}
+
+      std::optional<seastar::future<>> ms_dispatch(
+          crimson::net::ConnectionRef, MessageRef m) override {
+        auto& data = m->get_data();
+        if (!data.contents_equal(expected)) {
+          throw std::runtime_error("data payload mismatch");
+        }
+        // the whole payload should land in one page-aligned buffer
+        if (!data.is_contiguous() || !data.is_aligned(CEPH_PAGE_SIZE)) {
+          throw std::runtime_error("data payload not aligned");
+        }
+        if (++received == count) {
+          on_done.set_value();
+        }
+        return {seastar::now()};
+      }
+
+      seastar::future<> wait() { return on_done.get_future(); }
+
+      seastar::future<> init(const entity_name_t& name,
+                             const std::string& lname,
+                             const uint64_t nonce,
+                             const entity_addr_t& addr) {
+        msgr = crimson::net::Messenger::create(name, lname, nonce);
+        msgr->set_default_policy(crimson::net::SocketPolicy::stateless_server(0));
+        msgr->set_auth_client(&dummy_auth);
+        msgr->set_auth_server(&dummy_auth);
+        return msgr->bind(entity_addrvec_t{addr}).safe_then([this] {
+          return msgr->start({this});
+        }, crimson::net::Messenger::bind_ertr::all_same_way(
+            [addr] (const std::error_code& e) {
+          logger().error("test_aligned_data(): "
+                         "there is another instance running at {}", addr);
+          ceph_abort();
+        }));
+      }
+    };
+
+    struct Client final
+      : public crimson::net::Dispatcher {
+      crimson::net::MessengerRef msgr;
+      crimson::auth::DummyAuthClientServer dummy_auth;
+
+      std::optional<seastar::future<>> ms_dispatch(
+          crimson::net::ConnectionRef, MessageRef m) override {
+        return {seastar::now()};
+      }
+
+      seastar::future<> init(const entity_name_t& name,
+                             const std::string& lname,
+                             const uint64_t nonce) {
+        msgr = crimson::net::Messenger::create(name, lname, nonce);
+        msgr->set_default_policy(crimson::net::SocketPolicy::lossy_client(0));
+        msgr->set_auth_client(&dummy_auth);
+        msgr->set_auth_server(&dummy_auth);
+        return msgr->start({this});
+      }
+    };
+  };
+
+  logger().info("test_aligned_data(count={}, data_size={}):",
+                count, data_size);
+  bufferlist data;
+  {
+    auto bp = buffer::create(data_size);
+    std::generate(bp.c_str(), bp.c_str() + data_size,
+                  [] { return static_cast<char>(rng()); });
+    data.append(std::move(bp));
+  }
+  auto server = seastar::make_shared<test_state::Server>(count, data);
+  auto client = seastar::make_shared<test_state::Client>();
+  auto addr = get_server_addr();
+  addr.set_type(entity_addr_t::TYPE_MSGR2);
+  addr.set_family(AF_INET);
+  auto start = seastar::make_lw_shared<mono_time>();
+  return seastar::when_all_succeed(
+      server->init(entity_name_t::OSD(6), "server4", 7, addr),
+      client->init(entity_name_t::OSD(7), "client4", 8)
+  ).then_unpack([server, client, count, data, start] {
+    auto conn = client->msgr->connect(server->msgr->get_myaddr(),
+                                      entity_name_t::TYPE_OSD);
+    *start = mono_clock::now();
+    return seastar::do_for_each(
+        boost::make_counting_iterator(0u),
+        boost::make_counting_iterator(count),
+        [conn, data] (auto) {
+      auto m = make_message<MPing>();
+      m->set_data(data);
+      return conn->send(m);
+    });
+  }).then([server] {
+    return server->wait();
+  }).then([count, data_size, start] {
+    std::chrono::duration<double> elapsed = mono_clock::now() - *start;
+    logger().info("test_aligned_data(): received {} MiB in {:.3f}s, {:.1f} MiB/s",
+                  (count * data_size) >> 20, elapsed.count(),
+                  (count * data_size) / elapsed.count() / (1 << 20));
+  }).then([client] {
+    logger().info("client shutdown...");
+    client->msgr->stop();
+    return client->msgr->shutdown();
+  }).then([server] {
+    logger().info("server shutdown...");
+    server->msgr->stop();
+    return server->msgr->shutdown();
+  }).then([] {
+    logger().info("test_aligned_data() done!\n");
+  }).handle_exception([server, client] (auto eptr) {
+    logger().error("test_aligned_data() failed: got exception {}", eptr);
+    throw;
+  });
+}
+
 seastar::future<> test_preemptive_shutdown(bool v2) {
   struct test_state {
     class Server final
@@ -3615,6 +3743,8 @@ seastar::future<int> do_test(seastar::app_template& app)
       return test_concurrent_dispatch(false);
     }).then([] {
       return test_concurrent_dispatch(true);
+    }).then([] {
+      return test_aligned_data(64, 4 << 20);
     }).then([] {
       return test_preemptive_shutdown(false);
     }).then([] {
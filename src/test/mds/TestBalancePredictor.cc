@@ -0,0 +1,245 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "mds/BalancePredictor.h"
+#include "gtest/gtest.h"
+
+/*
+ * Offline balancing simulator.
+ *
+ * Replays a load trace of "<stamp> <ino> <load>" lines (one line per
+ * subtree per balancer epoch) over a set of ranks and, at every epoch,
+ * lets each overloaded rank export one subtree to the least loaded
+ * rank, the way prep_rebalance/find_exports pair exporters with
+ * importers.  Run with and without prediction, the number of migrations
+ * and the resulting imbalance can be compared for the same trace.
+ *
+ * Set CEPH_BAL_SIM_TRACE to a recorded trace file to replay it.
+ */
+class BalanceSim {
+public:
+  struct result_t {
+    unsigned epochs = 0;
+    unsigned migrations = 0;
+    double imbalance = 0;  // mean over epochs of max rank load / mean rank load
+  };
+
+  BalanceSim(int nranks, bool predictive,
+	     const BalancePredictor::config_t& c = BalancePredictor::config_t())
+    : nranks(nranks), predictive(predictive), predictor(c) {}
+
+  result_t replay(std::istream& in) {
+    double stamp, load;
+    uint64_t ino;
+    double cur = -1;
+    std::map<dirfrag_t, double> epoch;
+    while (in >> stamp >> ino >> load) {
+      if (stamp != cur && !epoch.empty()) {
+	run_epoch(cur, epoch);
+	epoch.clear();
+      }
+      cur = stamp;
+      epoch[dirfrag_t(inodeno_t(ino), frag_t())] = load;
+    }
+    if (!epoch.empty())
+      run_epoch(cur, epoch);
+    if (res.epochs)
+      res.imbalance /= res.epochs;
+    return res;
+  }
+
+private:
+  void run_epoch(double stamp, const std::map<dirfrag_t, double>& actual) {
+    std::map<dirfrag_t, double> seen;  // what the balancer acts on
+    for (const auto& [df, load] : actual) {
+      if (!owner.count(df))
+	owner[df] = mds_rank_t(owner.size() % nranks);
+      seen[df] = predictive ? predictor.sample(df, stamp, load) : load;
+    }
+
+    std::vector<double> rank_load(nranks), rank_actual(nranks);
+    for (const auto& [df, load] : seen) {
+      rank_load[owner[df]] += load;
+      rank_actual[owner[df]] += actual.at(df);
+    }
+
+    double total = 0, max = 0;
+    for (auto l : rank_actual) {
+      total += l;
+      max = std::max(max, l);
+    }
+    res.epochs++;
+    if (total > 0)
+      res.imbalance += max / (total / nranks);
+
+    double target = 0;
+    for (auto l : rank_load)
+      target += l;
+    target /= nranks;
+
+    for (mds_rank_t ex = 0; ex < nranks; ex++) {
+      if (rank_load[ex] <= target * 1.1)
+	continue;
+      mds_rank_t im = std::min_element(rank_load.begin(), rank_load.end()) -
+		      rank_load.begin();
+      double excess = std::min(rank_load[ex] - target, target - rank_load[im]);
+
+      // the subtree whose load best fills the gap without overshooting
+      const dirfrag_t *best = nullptr;
+      double best_load = 0;
+      for (const auto& [df, load] : seen) {
+	if (owner[df] != ex || load > excess || load <= best_load)
+	  continue;
+	if (predictive && (predictor.in_cooldown(df, stamp) ||
+			   !predictor.worth_migrating(load, 1)))
+	  continue;
+	best = &df;
+	best_load = load;
+      }
+      if (!best)
+	continue;
+      owner[*best] = im;
+      rank_load[ex] -= best_load;
+      rank_load[im] += best_load;
+      if (predictive)
+	predictor.note_migration(*best, stamp);
+      res.migrations++;
+    }
+  }
+
+  int nranks;
+  bool predictive;
+  BalancePredictor predictor;
+  std::map<dirfrag_t, mds_rank_t> owner;
+  result_t res;
+};
+
+// four subtrees on two ranks; the first two take turns bursting
+static std::string bursty_trace(int epochs)
+{
+  std::ostringstream ss;
+  for (int e = 0; e < epochs; e++) {
+    ss << e * 10 << " 1 " << (e % 2 ? 100 : 10) << "\n";
+    ss << e * 10 << " 2 " << (e % 2 ? 10 : 100) << "\n";
+    ss << e * 10 << " 3 10\n";
+    ss << e * 10 << " 4 10\n";
+  }
+  return ss.str();
+}
+
+// four subtrees on two ranks; subtree 1 becomes and stays hot
+static std::string shift_trace(int epochs)
+{
+  std::ostringstream ss;
+  for (int e = 0; e < epochs; e++) {
+    ss << e * 10 << " 1 " << (e < epochs / 4 ? 10 : 100) << "\n";
+    ss << e * 10 << " 2 10\n";
+    ss << e * 10 << " 3 100\n";
+    ss << e * 10 << " 4 10\n";
+  }
+  return ss.str();
+}
+
+TEST(LoadHistory, Steady)
+{
+  LoadHistory h;
+  for (int i = 0; i < 10; i++)
+    h.sample(i, 50, .5, .3, 16);
+  ASSERT_NEAR(50, h.predict(30), 1e-6);
+}
+
+TEST(LoadHistory, Trend)
+{
+  LoadHistory h;
+  for (int i = 0; i < 10; i++)
+    h.sample(i, 10 * i, .5, .3, 16);
+  // rising load is projected upwards
+  ASSERT_GT(h.predict(10), 90);
+}
+
+TEST(LoadHistory, BoundedAndNonNegative)
+{
+  LoadHistory h;
+  for (int i = 0; i < 100; i++)
+    h.sample(i, 1000 - 20 * i, .5, .3, 8);
+  ASSERT_EQ(8u, h.get_num_samples());
+  ASSERT_GE(h.predict(1000), 0);
+}
+
+TEST(BalancePredictor, Cooldown)
+{
+  BalancePredictor::config_t c;
+  c.cooldown = 60;
+  BalancePredictor p(c);
+  dirfrag_t df(inodeno_t(0x10000000000), frag_t());
+  ASSERT_FALSE(p.in_cooldown(df, 100));
+  p.note_migration(df, 100);
+  ASSERT_TRUE(p.in_cooldown(df, 130));
+  ASSERT_FALSE(p.in_cooldown(df, 161));
+  p.trim(150);
+  ASSERT_FALSE(p.in_cooldown(df, 130));
+}
+
+TEST(BalancePredictor, MigrationCost)
+{
+  BalancePredictor::config_t c;
+  c.horizon = 10;
+  c.migration_cost = 1;
+  BalancePredictor p(c);
+  ASSERT_TRUE(p.worth_migrating(100, 100));
+  ASSERT_FALSE(p.worth_migrating(1, 100));
+}
+
+TEST(BalanceSim, BurstyLessPingPong)
+{
+  std::istringstream t1(bursty_trace(40)), t2(bursty_trace(40));
+  auto inst = BalanceSim(2, false).replay(t1);
+  auto pred = BalanceSim(2, true).replay(t2);
+  std::cout << "bursty: instantaneous " << inst.migrations << " migrations, "
+	    << "imbalance " << inst.imbalance << "; predictive "
+	    << pred.migrations << " migrations, imbalance "
+	    << pred.imbalance << std::endl;
+  ASSERT_LT(pred.migrations, inst.migrations);
+}
+
+TEST(BalanceSim, SustainedShiftStillBalances)
+{
+  std::istringstream t(shift_trace(40));
+  auto pred = BalanceSim(2, true).replay(t);
+  ASSERT_GT(pred.migrations, 0u);
+}
+
+TEST(BalanceSim, ReplayRecorded)
+{
+  const char *path = getenv("CEPH_BAL_SIM_TRACE");
+  if (!path)
+    return;
+  int nranks = 2;
+  if (const char *r = getenv("CEPH_BAL_SIM_RANKS"))
+    nranks = std::max(1, atoi(r));
+  std::ifstream f1(path), f2(path);
+  ASSERT_TRUE(f1.good());
+  auto inst = BalanceSim(nranks, false).replay(f1);
+  auto pred = BalanceSim(nranks, true).replay(f2);
+  std::cout << path << ": " << inst.epochs << " epochs\n"
+	    << "  instantaneous: " << inst.migrations << " migrations, imbalance "
+	    << inst.imbalance << "\n"
+	    << "  predictive:    " << pred.migrations << " migrations, imbalance "
+	    << pred.imbalance << std::endl;
+}
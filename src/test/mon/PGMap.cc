@@ -164,3 +164,55 @@ TEST(pgmap, dump_object_stat_sum_2)
   ASSERT_EQ(percentify(0), tbl.get(0, col++));
   ASSERT_EQ(stringify(byte_u_t(avail/pool.size)), tbl.get(0, col++));
 }
+
+namespace {
+  PGMap::Incremental make_purged_snaps_inc(const PGMap& pg_map, int round,
+					   int num_pools, int pgs_per_pool)
+  {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    inc.stamp = utime_t(round + 1, 0);
+    for (int pool = 1; pool <= num_pools; pool++) {
+      for (int seed = 0; seed < pgs_per_pool; seed++) {
+	if ((seed + round) % 3 == 0)
+	  continue;   // not every pg reports every round
+	pg_stat_t s;
+	// one pg of pool 2 goes unknown for a while
+	s.state = (pool == 2 && seed == 1 && round >= 5 && round < 8) ?
+	  0 : PG_STATE_ACTIVE;
+	s.purged_snaps.insert(snapid_t(1), round + seed % 4 + 1);
+	inc.pg_stat_updates[pg_t(seed, pool)] = s;
+      }
+    }
+    // pool 3 goes away half way through
+    if (round == 10) {
+      for (int seed = 0; seed < pgs_per_pool; seed++) {
+	inc.pg_stat_updates.erase(pg_t(seed, 3));
+	inc.pg_remove.insert(pg_t(seed, 3));
+      }
+    } else if (round > 10) {
+      for (int seed = 0; seed < pgs_per_pool; seed++)
+	inc.pg_stat_updates.erase(pg_t(seed, 3));
+    }
+    return inc;
+  }
+}
+
+// purged_snaps is only recomputed for pools touched by an incremental;
+// it must match a recomputation from scratch.
+TEST(pgmap, incremental_purged_snaps)
+{
+  PGMap pg_map;
+  for (int round = 0; round < 16; round++) {
+    pg_map.apply_incremental(nullptr,
+			     make_purged_snaps_inc(pg_map, round, 3, 8));
+    pg_map.calc_purged_snaps();
+
+    PGMap full = pg_map;
+    full.calc_stats();
+    full.calc_purged_snaps();
+    ASSERT_EQ(full.purged_snaps, pg_map.purged_snaps) << "round " << round;
+  }
+  ASSERT_EQ(0u, pg_map.purged_snaps.count(3));
+  ASSERT_EQ(2u, pg_map.purged_snaps.size());
+}
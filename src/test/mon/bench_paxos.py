@@ -0,0 +1,125 @@
+#!/usr/bin/python3
+
+import argparse
+import json
+import multiprocessing
+import subprocess
+import time
+
+import rados
+
+# Each worker keeps one update in flight against one monitor service, so
+# several services have pending changes at the same time.
+SERVICES = {
+    'kv': lambda w, n: {'prefix': 'config-key set',
+                        'key': 'bench_paxos/{}'.format(w),
+                        'val': str(n)},
+    'config': lambda w, n: {'prefix': 'config set',
+                            'who': 'client.bench_paxos{}'.format(w),
+                            'name': 'debug_ms',
+                            'value': str(n % 20)},
+    'auth': lambda w, n: {'prefix': 'auth get-or-create',
+                          'entity': 'client.bench_paxos{}.{}'.format(w, n),
+                          'caps': ['mon', 'allow r']},
+}
+
+
+class Worker(multiprocessing.Process):
+    def __init__(self, num, service, queue, duration):
+        super().__init__()
+        self.num = num
+        self.service = service
+        self.queue = queue
+        self.duration = duration
+
+    def run(self):
+        make_cmd = SERVICES[self.service]
+        latencies = []
+        with rados.Rados(conffile=rados.Rados.DEFAULT_CONF_FILES) as conn:
+            start_time = time.time()
+            while time.time() - start_time < self.duration:
+                cmd = make_cmd(self.num, len(latencies))
+                cmd_start = time.time()
+                ret, buf, out = conn.mon_command(json.dumps(cmd), b'')
+                if ret != 0:
+                    self.queue.put(Exception("{0}: {1}".format(ret, out)))
+                    return
+                latencies.append(time.time() - cmd_start)
+        self.queue.put((self.service, latencies, time.time() - start_time))
+
+
+def paxos_perf(mon_id):
+    if mon_id is None:
+        return None
+    out = subprocess.check_output(
+        ['ceph', 'daemon', 'mon.{}'.format(mon_id), 'perf', 'dump', 'paxos'])
+    return json.loads(out)['paxos']
+
+
+def avg_delta(before, after, name):
+    count = after[name]['avgcount'] - before[name]['avgcount']
+    total = after[name]['sum'] - before[name]['sum']
+    return count, (total / count if count else 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+Stress the monitor with concurrent updates to several paxos services and
+report update throughput and latency. With --mon-id, also report the
+number of paxos proposals, services coalesced per proposal and commit
+latency from the leader's perf counters.
+""")
+    parser.add_argument('-t', '--threads', type=int, default=4,
+                        help='workers per service')
+    parser.add_argument('-d', '--duration', type=int, default=30,
+                        help='how long to run, in seconds')
+    parser.add_argument('-s', '--services', default=','.join(SERVICES),
+                        help='comma separated services to update ({})'.format(
+                            ', '.join(SERVICES)))
+    parser.add_argument('-m', '--mon-id', default=None,
+                        help='id of the leader monitor, for perf counters')
+    args = parser.parse_args()
+
+    services = args.services.split(',')
+    before = paxos_perf(args.mon_id)
+    q = multiprocessing.Queue()
+    workers = []
+    for service in services:
+        for i in range(args.threads):
+            workers.append(Worker(len(workers), service, q, args.duration))
+            workers[-1].start()
+    results = []
+    for _ in workers:
+        r = q.get()
+        if isinstance(r, Exception):
+            raise r
+        results.append(r)
+    for w in workers:
+        w.join()
+    after = paxos_perf(args.mon_id)
+
+    all_lat = []
+    for service in services:
+        lat = sorted(l for s, ls, _ in results if s == service for l in ls)
+        all_lat += lat
+        secs = max(sec for s, _, sec in results if s == service)
+        if not lat:
+            continue
+        print("{:8} {:6} updates {:8.1f}/s  avg {:.3f}s  p99 {:.3f}s".format(
+            service, len(lat), len(lat) / secs, sum(lat) / len(lat),
+            lat[int(len(lat) * .99) - 1]))
+    print("total    {:6} updates {:8.1f}/s".format(
+        len(all_lat), len(all_lat) / args.duration))
+
+    if before and after:
+        proposals, services_per = avg_delta(before, after, 'propose_services')
+        _, propose_lat = avg_delta(before, after, 'propose_latency')
+        _, commit_lat = avg_delta(before, after, 'commit_latency')
+        print("paxos: {} proposals ({:.1f}/s), {:.2f} service updates/proposal,"
+              " propose latency {:.3f}s, commit latency {:.3f}s".format(
+                  proposals, proposals / args.duration, services_per,
+                  propose_lat, commit_lat))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,164 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+/*
+ * Benchmark the mgr/mon PGMap hot paths on a synthetic cluster:
+ * apply_incremental(), encode_digest() and dump_pool_stats_full().
+ */
+
+#include <iostream>
+#include <random>
+
+#include "common/ceph_argparse.h"
+#include "common/ceph_time.h"
+#include "global/global_init.h"
+#include "mon/PGMap.h"
+#include "osd/OSDMap.h"
+
+using namespace std;
+
+static void usage(const char *name)
+{
+  cout << name << " [--pgs N] [--pools N] [--osds N] [--rounds N]"
+       << " [--update-ratio R]\n"
+       << "\t--pgs: total number of PGs (default 200000)\n"
+       << "\t--pools: number of pools the PGs are spread over (default 16)\n"
+       << "\t--osds: number of OSDs (default 1000)\n"
+       << "\t--rounds: number of incrementals to apply (default 50)\n"
+       << "\t--update-ratio: fraction of PGs reporting per incremental"
+       << " (default 0.2)\n";
+}
+
+int main(int argc, const char **argv)
+{
+  vector<const char*> args;
+  argv_to_vec(argc, argv, args);
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  int num_pgs = 200000, num_pools = 16, num_osds = 1000, rounds = 50;
+  double update_ratio = .2;
+  string val;
+  for (auto i = args.begin(); i != args.end(); ) {
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_witharg(args, i, &val, "--pgs", (char*)NULL)) {
+      num_pgs = atoi(val.c_str());
+    } else if (ceph_argparse_witharg(args, i, &val, "--pools", (char*)NULL)) {
+      num_pools = atoi(val.c_str());
+    } else if (ceph_argparse_witharg(args, i, &val, "--osds", (char*)NULL)) {
+      num_osds = atoi(val.c_str());
+    } else if (ceph_argparse_witharg(args, i, &val, "--rounds", (char*)NULL)) {
+      rounds = atoi(val.c_str());
+    } else if (ceph_argparse_witharg(args, i, &val, "--update-ratio", (char*)NULL)) {
+      update_ratio = atof(val.c_str());
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (num_pools <= 0 || num_pgs < num_pools || num_osds < 3) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  uuid_d fsid;
+  fsid.generate_random();
+  OSDMap osdmap;
+  osdmap.build_simple(g_ceph_context, 1, fsid, num_osds);
+
+  std::mt19937 rng(42);
+  const int pgs_per_pool = num_pgs / num_pools;
+
+  auto make_stat = [&](int round) {
+    pg_stat_t s;
+    s.state = PG_STATE_ACTIVE | PG_STATE_CLEAN;
+    for (int i = 0; i < 3; i++) {
+      int osd = rng() % num_osds;
+      s.up.push_back(osd);
+      s.acting.push_back(osd);
+    }
+    s.up_primary = s.acting_primary = s.acting[0];
+    s.stats.sum.num_objects = 1000 + round;
+    s.stats.sum.num_bytes = (1000 + round) * 4096;
+    s.stats.sum.num_rd = round * 10;
+    s.stats.sum.num_wr = round * 5;
+    s.purged_snaps.insert(snapid_t(1), 1 + round / 10);
+    return s;
+  };
+
+  PGMap pg_map;
+  {
+    PGMap::Incremental inc;
+    inc.version = 1;
+    inc.stamp = ceph_clock_now();
+    for (int pool = 1; pool <= num_pools; pool++) {
+      for (int seed = 0; seed < pgs_per_pool; seed++) {
+	inc.pg_stat_updates[pg_t(seed, pool)] = make_stat(0);
+      }
+    }
+    for (int osd = 0; osd < num_osds; osd++) {
+      osd_stat_t os;
+      os.num_osds = 1;
+      os.statfs.total = 1ull << 40;
+      os.statfs.available = 1ull << 39;
+      inc.update_stat(osd, std::move(os));
+    }
+    pg_map.apply_incremental(g_ceph_context, inc);
+  }
+  cout << "pgmap: " << pg_map.pg_stat.size() << " pgs in " << num_pools
+       << " pools, " << pg_map.osd_stat.size() << " osds" << std::endl;
+
+  using ceph::mono_clock;
+  mono_clock::duration apply_time{}, digest_time{}, dump_time{};
+  uint64_t digest_bytes = 0, updates = 0;
+  for (int round = 1; round <= rounds; round++) {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    inc.stamp = ceph_clock_now();
+    for (int pool = 1; pool <= num_pools; pool++) {
+      for (int seed = 0; seed < pgs_per_pool; seed++) {
+	if ((double)(rng() % 1000) < update_ratio * 1000)
+	  inc.pg_stat_updates[pg_t(seed, pool)] = make_stat(round);
+      }
+    }
+    updates += inc.pg_stat_updates.size();
+
+    auto start = mono_clock::now();
+    pg_map.apply_incremental(g_ceph_context, inc);
+    auto applied = mono_clock::now();
+    bufferlist bl;
+    pg_map.encode_digest(osdmap, bl, CEPH_FEATURES_ALL);
+    auto encoded = mono_clock::now();
+    stringstream ss;
+    pg_map.dump_pool_stats_full(osdmap, &ss, nullptr, true);
+    auto dumped = mono_clock::now();
+
+    apply_time += applied - start;
+    digest_time += encoded - applied;
+    dump_time += dumped - encoded;
+    digest_bytes += bl.length();
+  }
+
+  auto per_round = [rounds](mono_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count() / rounds;
+  };
+  cout << rounds << " rounds, " << updates / rounds << " pg updates/round\n"
+       << "  apply_incremental:    " << per_round(apply_time) << " ms/round\n"
+       << "  encode_digest:        " << per_round(digest_time) << " ms/round ("
+       << digest_bytes / rounds << " bytes)\n"
+       << "  dump_pool_stats_full: " << per_round(dump_time) << " ms/round"
+       << std::endl;
+  return 0;
+}
@@ -0,0 +1,113 @@
+#!/usr/bin/python3
+
+import argparse
+import multiprocessing
+import os
+import time
+
+import boto3
+
+# Each worker keeps one GET of the same object in flight for the length
+# of the run, recording how long each GET took.
+
+
+class Worker(multiprocessing.Process):
+    def __init__(self, args, queue, stop):
+        super().__init__()
+        self.args = args
+        self.queue = queue
+        self.stop = stop
+
+    def run(self):
+        s3 = boto3.client('s3', endpoint_url=self.args.endpoint,
+                          aws_access_key_id=self.args.access_key,
+                          aws_secret_access_key=self.args.secret_key)
+        samples = []
+        while not self.stop.is_set():
+            start = time.time()
+            try:
+                body = s3.get_object(Bucket=self.args.bucket,
+                                     Key=self.args.key)['Body']
+                size = 0
+                for chunk in body.iter_chunks(1 << 20):
+                    size += len(chunk)
+            except Exception as e:
+                self.queue.put(e)
+                return
+            samples.append((time.time() - start, size))
+        self.queue.put(samples)
+
+
+def percentile(lat, p):
+    return lat[max(int(len(lat) * p) - 1, 0)] if lat else 0
+
+
+def cpu_seconds(pid):
+    # utime + stime of the radosgw process, in seconds
+    with open('/proc/{}/stat'.format(pid)) as f:
+        fields = f.read().rsplit(')', 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / os.sysconf('SC_CLK_TCK')
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+Measure S3 GET throughput of a single object over loopback. The object is
+uploaded once and then read by --threads concurrent clients for --duration
+seconds. With --pid, the CPU time radosgw spent per GB served is reported
+as well, which is where copies of the response body show up.
+""")
+    parser.add_argument('-b', '--bucket', required=True)
+    parser.add_argument('-k', '--key', default='bench-get')
+    parser.add_argument('-e', '--endpoint', default='http://localhost:8000')
+    parser.add_argument('--access-key', required=True)
+    parser.add_argument('--secret-key', required=True)
+    parser.add_argument('-t', '--threads', type=int, default=8)
+    parser.add_argument('-s', '--size', type=int, default=64 << 20,
+                        help='object size in bytes')
+    parser.add_argument('-d', '--duration', type=int, default=30)
+    parser.add_argument('-p', '--pid', type=int,
+                        help='pid of radosgw, to report its cpu time')
+    args = parser.parse_args()
+
+    s3 = boto3.client('s3', endpoint_url=args.endpoint,
+                      aws_access_key_id=args.access_key,
+                      aws_secret_access_key=args.secret_key)
+    s3.put_object(Bucket=args.bucket, Key=args.key,
+                  Body=os.urandom(args.size))
+
+    q = multiprocessing.Queue()
+    stop = multiprocessing.Event()
+    workers = [Worker(args, q, stop) for _ in range(args.threads)]
+    cpu_start = cpu_seconds(args.pid) if args.pid else 0
+    start = time.time()
+    for w in workers:
+        w.start()
+    time.sleep(args.duration)
+    stop.set()
+
+    samples = []
+    for _ in workers:
+        r = q.get()
+        if isinstance(r, Exception):
+            raise r
+        samples += r
+    for w in workers:
+        w.join()
+    elapsed = time.time() - start
+
+    lat = sorted(l for l, _ in samples)
+    gb = sum(size for _, size in samples) / float(1 << 30)
+    if not lat:
+        print("no requests completed")
+        return
+    print("{} gets  {:.2f} GB/s  avg {:.3f}s  p50 {:.3f}s  p99 {:.3f}s"
+          "  max {:.3f}s".format(len(lat), gb / elapsed, sum(lat) / len(lat),
+                                 percentile(lat, .5), percentile(lat, .99),
+                                 lat[-1]))
+    if args.pid:
+        cpu = cpu_seconds(args.pid) - cpu_start
+        print("radosgw cpu {:.1f}s  {:.2f}s/GB".format(cpu, cpu / gb))
+
+
+if __name__ == '__main__':
+    main()
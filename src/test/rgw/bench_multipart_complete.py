@@ -0,0 +1,65 @@
+#!/usr/bin/python3
+
+import argparse
+import concurrent.futures
+import time
+
+import boto3
+
+# Uploads a multipart object for each part count given and times only the
+# CompleteMultipartUpload request.
+
+
+def upload(s3, args, num_parts):
+    key = 'bench-mp-{}'.format(num_parts)
+    upload_id = s3.create_multipart_upload(Bucket=args.bucket,
+                                           Key=key)['UploadId']
+    body = b'x' * args.part_size
+
+    def put_part(num):
+        r = s3.upload_part(Bucket=args.bucket, Key=key, UploadId=upload_id,
+                           PartNumber=num, Body=body)
+        return {'PartNumber': num, 'ETag': r['ETag']}
+
+    with concurrent.futures.ThreadPoolExecutor(args.threads) as ex:
+        parts = list(ex.map(put_part, range(1, num_parts + 1)))
+
+    start = time.time()
+    s3.complete_multipart_upload(Bucket=args.bucket, Key=key,
+                                 UploadId=upload_id,
+                                 MultipartUpload={'Parts': parts})
+    elapsed = time.time() - start
+    s3.delete_object(Bucket=args.bucket, Key=key)
+    return elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+Measure CompleteMultipartUpload latency against the number of parts.
+Parts are small so that large part counts are quick to set up; run
+radosgw with rgw_multipart_min_part_size no larger than --part-size.
+Compare runs with different rgw_multipart_complete_max_aio settings.
+""")
+    parser.add_argument('-b', '--bucket', required=True)
+    parser.add_argument('-e', '--endpoint', default='http://localhost:8000')
+    parser.add_argument('--access-key', required=True)
+    parser.add_argument('--secret-key', required=True)
+    parser.add_argument('-t', '--threads', type=int, default=32,
+                        help='concurrent part uploads')
+    parser.add_argument('-s', '--part-size', type=int, default=4096)
+    parser.add_argument('-n', '--num-parts', type=int, nargs='+',
+                        default=[100, 1000, 5000, 10000])
+    parser.add_argument('-r', '--repeat', type=int, default=3)
+    args = parser.parse_args()
+
+    s3 = boto3.client('s3', endpoint_url=args.endpoint,
+                      aws_access_key_id=args.access_key,
+                      aws_secret_access_key=args.secret_key)
+    for n in args.num_parts:
+        lat = sorted(upload(s3, args, n) for _ in range(args.repeat))
+        print("{:6} parts  min {:.3f}s  avg {:.3f}s  max {:.3f}s".format(
+            n, lat[0], sum(lat) / len(lat), lat[-1]))
+
+
+if __name__ == '__main__':
+    main()
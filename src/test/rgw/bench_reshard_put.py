@@ -0,0 +1,109 @@
+#!/usr/bin/python3
+
+import argparse
+import multiprocessing
+import subprocess
+import time
+
+import boto3
+
+# Each worker keeps one PUT in flight against the bucket while it is
+# resharded, recording when each PUT started and how long it took.
+
+
+class Worker(multiprocessing.Process):
+    def __init__(self, num, args, queue, stop):
+        super().__init__()
+        self.num = num
+        self.args = args
+        self.queue = queue
+        self.stop = stop
+
+    def run(self):
+        s3 = boto3.client('s3', endpoint_url=self.args.endpoint,
+                          aws_access_key_id=self.args.access_key,
+                          aws_secret_access_key=self.args.secret_key)
+        body = b'x' * self.args.size
+        samples = []
+        n = 0
+        while not self.stop.is_set():
+            key = 'bench-{}-{}'.format(self.num, n)
+            start = time.time()
+            try:
+                s3.put_object(Bucket=self.args.bucket, Key=key, Body=body)
+            except Exception as e:
+                self.queue.put(e)
+                return
+            samples.append((start, time.time() - start))
+            n += 1
+        self.queue.put(samples)
+
+
+def percentile(lat, p):
+    return lat[max(int(len(lat) * p) - 1, 0)] if lat else 0
+
+
+def report(name, lat):
+    lat = sorted(lat)
+    if not lat:
+        print("{:8} no requests".format(name))
+        return
+    print("{:8} {:6} puts  avg {:.3f}s  p50 {:.3f}s  p99 {:.3f}s"
+          "  max {:.3f}s".format(name, len(lat), sum(lat) / len(lat),
+                                 percentile(lat, .5), percentile(lat, .99),
+                                 lat[-1]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="""
+Measure S3 PUT latency into a bucket while it is resharded. PUTs run for
+--warmup seconds before `radosgw-admin bucket reshard` starts and keep
+running until it finishes; latencies are reported separately for the
+two periods. Run once with rgw_reshard_online enabled and once without
+to compare the write stall.
+""")
+    parser.add_argument('-b', '--bucket', required=True)
+    parser.add_argument('-n', '--num-shards', type=int, required=True,
+                        help='shard count to reshard to')
+    parser.add_argument('-e', '--endpoint', default='http://localhost:8000')
+    parser.add_argument('--access-key', required=True)
+    parser.add_argument('--secret-key', required=True)
+    parser.add_argument('-t', '--threads', type=int, default=8)
+    parser.add_argument('-s', '--size', type=int, default=4096,
+                        help='object size in bytes')
+    parser.add_argument('-w', '--warmup', type=int, default=10,
+                        help='seconds of PUTs before the reshard starts')
+    args = parser.parse_args()
+
+    q = multiprocessing.Queue()
+    stop = multiprocessing.Event()
+    workers = [Worker(i, args, q, stop) for i in range(args.threads)]
+    for w in workers:
+        w.start()
+    time.sleep(args.warmup)
+
+    reshard_start = time.time()
+    subprocess.check_call(['radosgw-admin', 'bucket', 'reshard',
+                           '--bucket', args.bucket,
+                           '--num-shards', str(args.num_shards),
+                           '--yes-i-really-mean-it'])
+    reshard_end = time.time()
+    stop.set()
+
+    samples = []
+    for _ in workers:
+        r = q.get()
+        if isinstance(r, Exception):
+            raise r
+        samples += r
+    for w in workers:
+        w.join()
+
+    report('before', [l for s, l in samples if s < reshard_start])
+    report('during', [l for s, l in samples
+                      if reshard_start <= s < reshard_end])
+    print("reshard took {:.1f}s".format(reshard_end - reshard_start))
+
+
+if __name__ == '__main__':
+    main()
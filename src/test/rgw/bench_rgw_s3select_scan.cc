@@ -0,0 +1,103 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+/*
+ * Throughput of the S3 Select CSV row scanner and filter pushdown over a
+ * synthetic CSV object, fed in chunks the size RGW reads from RADOS.
+ *
+ *   ceph_bench_rgw_s3select_scan [size_mb] [query]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "rgw/rgw_s3select_scan.h"
+
+using namespace rgw::s3select;
+using Clock = std::chrono::steady_clock;
+
+static std::string make_csv(size_t size)
+{
+  std::mt19937 rng(0);
+  std::string csv;
+  csv.reserve(size + 256);
+  csv += "id,ts,status,bytes,latency,client,path,agent\n";
+  for (uint64_t id = 0; csv.size() < size; id++) {
+    csv += std::to_string(id) + ',' + std::to_string(1600000000 + id / 10) + ',';
+    csv += std::to_string((rng() % 10 ? 200 : 404)) + ',';
+    csv += std::to_string(rng() % 1000000) + ',';
+    csv += std::to_string(rng() % 1000) + '.' + std::to_string(rng() % 1000) + ',';
+    csv += "10.0." + std::to_string(rng() % 256) + '.' + std::to_string(rng() % 256) + ',';
+    csv += "/bucket/object-" + std::to_string(rng() % 100000) + ',';
+    csv += (rng() % 4 ? "\"curl/7.68.0\"" : "aws-cli/2.0") + std::string("\n");
+  }
+  return csv;
+}
+
+template <typename F>
+static void run(const char *name, const std::string& csv, F&& f)
+{
+  auto start = Clock::now();
+  uint64_t result = f();
+  double secs = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << name << ": " << (csv.size() / secs / (1 << 20)) << " MB/s ("
+            << result << ")" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  const size_t size = (argc > 1 ? atoi(argv[1]) : 512) << 20;
+  const char *query = argc > 2 ? argv[2] :
+    "select count(*) from s3object where _3 = 404 and _5 > 900";
+  const size_t chunk = 4 << 20;
+  const CSVDialect d;
+
+  std::cout << "generating " << (size >> 20) << " MB of CSV" << std::endl;
+  const std::string csv = make_csv(size);
+
+  auto scan = [&] (auto find) {
+    std::vector<RowSpan> rows;
+    uint64_t n = 0;
+    for (size_t pos = 0; pos < csv.size(); ) {
+      rows.clear();
+      const size_t len = std::min(chunk, csv.size() - pos);
+      size_t consumed = find(csv.data() + pos, len, d, rows);
+      n += rows.size();
+      pos += consumed ? consumed : len;
+    }
+    return n;
+  };
+  run("row scan, scalar", csv, [&] { return scan(find_rows_scalar); });
+  run("row scan, simd", csv, [&] { return scan(find_rows); });
+
+  auto filter = RowFilter::from_query(query, d);
+  if (!filter) {
+    std::cout << "no pushdown for: " << query << std::endl;
+    return 0;
+  }
+  CSVPushdown p(std::move(*filter), true);
+  std::string out;
+  run("pushdown", csv, [&] {
+    for (size_t pos = 0; pos < csv.size(); pos += chunk) {
+      const size_t len = std::min(chunk, csv.size() - pos);
+      out.clear();
+      p.process(csv.data() + pos, len, pos + len == csv.size(), out);
+    }
+    return p.rows_out;
+  });
+  std::cout << query << ": " << p.rows_out << " of " << p.rows_in
+            << " rows and " << (100.0 * p.bytes_out / p.bytes_in)
+            << "% of the bytes passed to the engine" << std::endl;
+  return 0;
+}
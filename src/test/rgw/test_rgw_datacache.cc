@@ -0,0 +1,161 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#include "rgw/rgw_datacache.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <unistd.h>
+
+#include "global/global_context.h"
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+class DataCache : public ::testing::Test {
+protected:
+  std::string path;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/test_rgw_datacache.XXXXXX";
+    ASSERT_TRUE(::mkdtemp(tmpl));
+    path = tmpl;
+  }
+  void TearDown() override {
+    ::system(("rm -rf " + path).c_str());
+  }
+
+  RGWDataCache::config_t config(uint64_t capacity) {
+    RGWDataCache::config_t c;
+    c.path = path;
+    c.capacity = capacity;
+    c.max_pending = 1 << 20;
+    return c;
+  }
+
+  static bufferlist data(size_t len, char c) {
+    bufferlist bl;
+    bl.append(std::string(len, c));
+    return bl;
+  }
+
+  // fills become visible once the writer has stored them
+  static void wait_for(RGWDataCache& cache, uint64_t entries) {
+    for (int i = 0; i < 500 && cache.get_num_entries() < entries; i++)
+      std::this_thread::sleep_for(10ms);
+  }
+};
+
+TEST_F(DataCache, ReadThrough)
+{
+  RGWDataCache cache(g_ceph_context, config(1 << 20));
+  ASSERT_EQ(0, cache.init());
+
+  bufferlist bl;
+  ASSERT_FALSE(cache.get("obj", "tag1", "stripe0", &bl));
+  cache.put("obj", "tag1", "stripe0", data(4096, 'a'));
+  wait_for(cache, 1);
+
+  ASSERT_TRUE(cache.get("obj", "tag1", "stripe0", &bl));
+  ASSERT_TRUE(bl.contents_equal(data(4096, 'a')));
+  ASSERT_EQ(4096u, cache.get_size());
+}
+
+TEST_F(DataCache, ReadAfterInvalidate)
+{
+  RGWDataCache cache(g_ceph_context, config(1 << 20));
+  ASSERT_EQ(0, cache.init());
+
+  cache.put("obj", "tag", "stripe0", data(100, 'a'));
+  wait_for(cache, 1);
+
+  auto hit = cache.lookup("obj", "tag", "stripe0");
+  ASSERT_TRUE(hit);
+  // the file goes away between the lookup and the read
+  cache.invalidate("obj");
+  std::promise<int> done;
+  cache.read(*hit, [&done] (int r, bufferlist&& bl) {
+    done.set_value(r);
+  });
+  ASSERT_EQ(-ENOENT, done.get_future().get());
+}
+
+TEST_F(DataCache, NewTagDropsOldVersion)
+{
+  RGWDataCache cache(g_ceph_context, config(1 << 20));
+  ASSERT_EQ(0, cache.init());
+
+  cache.put("obj", "tag1", "stripe0", data(100, 'a'));
+  cache.put("obj", "tag1", "stripe1", data(100, 'b'));
+  wait_for(cache, 2);
+  ASSERT_EQ(2u, cache.get_num_entries());
+
+  bufferlist bl;
+  ASSERT_FALSE(cache.get("obj", "tag2", "stripe0", &bl));
+  ASSERT_EQ(0u, cache.get_num_entries());
+  ASSERT_FALSE(cache.get("obj", "tag1", "stripe1", &bl));
+}
+
+TEST_F(DataCache, Invalidate)
+{
+  RGWDataCache cache(g_ceph_context, config(1 << 20));
+  ASSERT_EQ(0, cache.init());
+
+  cache.put("obj1", "tag", "stripe0", data(100, 'a'));
+  cache.put("obj2", "tag", "stripe0", data(100, 'b'));
+  wait_for(cache, 2);
+
+  cache.invalidate("obj1");
+  bufferlist bl;
+  ASSERT_FALSE(cache.get("obj1", "tag", "stripe0", &bl));
+  ASSERT_TRUE(cache.get("obj2", "tag", "stripe0", &bl));
+  ASSERT_EQ(100u, cache.get_size());
+}
+
+TEST_F(DataCache, EvictLeastRecentlyUsed)
+{
+  RGWDataCache cache(g_ceph_context, config(300));
+  ASSERT_EQ(0, cache.init());
+
+  cache.put("a", "t", "a", data(100, 'a'));
+  cache.put("b", "t", "b", data(100, 'b'));
+  cache.put("c", "t", "c", data(100, 'c'));
+  wait_for(cache, 3);
+
+  bufferlist bl;
+  ASSERT_TRUE(cache.get("a", "t", "a", &bl)); // b is now the oldest
+  cache.put("d", "t", "d", data(100, 'd'));
+  for (int i = 0; i < 500 && !cache.get("d", "t", "d", &bl); i++)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_TRUE(bl.contents_equal(data(100, 'd')));
+  bl.clear();
+  ASSERT_FALSE(cache.get("b", "t", "b", &bl));
+  ASSERT_TRUE(cache.get("a", "t", "a", &bl));
+  ASSERT_LE(cache.get_size(), 300u);
+}
+
+TEST_F(DataCache, RemovesStaleFilesOnStartup)
+{
+  {
+    RGWDataCache cache(g_ceph_context, config(1 << 20));
+    ASSERT_EQ(0, cache.init());
+    cache.put("obj", "tag", "stripe0", data(100, 'a'));
+    wait_for(cache, 1);
+  }
+  RGWDataCache cache(g_ceph_context, config(1 << 20));
+  ASSERT_EQ(0, cache.init());
+  bufferlist bl;
+  ASSERT_FALSE(cache.get("obj", "tag", "stripe0", &bl));
+  // nothing but the files of the previous run was in there
+  ASSERT_EQ(0, ::rmdir(path.c_str()));
+}
@@ -0,0 +1,176 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#include "rgw/rgw_s3select_scan.h"
+
+#include <random>
+#include <gtest/gtest.h>
+
+using namespace rgw::s3select;
+
+TEST(S3SelectScan, MatchesScalar)
+{
+  std::mt19937 rng(42);
+  const CSVDialect d;
+  const char alphabet[] = "ab,\n\"";
+  for (int i = 0; i < 10000; i++) {
+    std::string s;
+    const int len = rng() % 200;
+    for (int j = 0; j < len; j++) {
+      s.push_back(alphabet[rng() % 5]);
+    }
+    std::vector<RowSpan> simd, scalar;
+    ASSERT_EQ(find_rows_scalar(s.data(), s.size(), d, scalar),
+              find_rows(s.data(), s.size(), d, simd));
+    ASSERT_EQ(scalar.size(), simd.size());
+    for (size_t j = 0; j < simd.size(); j++) {
+      ASSERT_EQ(scalar[j].begin, simd[j].begin);
+      ASSERT_EQ(scalar[j].end, simd[j].end);
+      ASSERT_EQ(scalar[j].quoted, simd[j].quoted);
+    }
+  }
+}
+
+TEST(S3SelectScan, QuotedRowDelimiter)
+{
+  const CSVDialect d;
+  const std::string s = "1,\"multi\nline\",2\n3,plain,4\n5,\"x\"";
+  std::vector<RowSpan> rows;
+  ASSERT_EQ(s.find("5,"), find_rows(s.data(), s.size(), d, rows));
+  ASSERT_EQ(2u, rows.size());
+  EXPECT_TRUE(rows[0].quoted);
+  EXPECT_EQ(s.find("\n3"), rows[0].end);
+  EXPECT_FALSE(rows[1].quoted);
+}
+
+TEST(S3SelectScan, FilterFromQuery)
+{
+  const CSVDialect d;
+  for (auto q : {"select * from s3object",
+                 "select * from s3object where _1 = 'a' or _2 = 'b'",
+                 "select * from s3object where not _1 = 'a'",
+                 "select * from s3object where (_1 = 'a')",
+                 "select * from s3object where _1 like 'a%'",
+                 "select * from s3object where _1 between 1 and 3",
+                 "select * from s3object where int(_1) = 3",
+                 "select * from s3object where _1 = \"a\"",
+                 "select * from s3object where _1 < 'abc'"}) {
+    EXPECT_FALSE(RowFilter::from_query(q, d)) << q;
+  }
+
+  auto f = RowFilter::from_query(
+    "SELECT _1 FROM s3object WHERE 10 <= _3 AND _2 != 'x' LIMIT 5;", d);
+  ASSERT_TRUE(f);
+  ASSERT_EQ(2u, f->get_predicates().size());
+  EXPECT_TRUE(f->may_match("a,y,10"));
+  EXPECT_FALSE(f->may_match("a,x,10"));
+  EXPECT_FALSE(f->may_match("a,y,9"));
+  // leave anything unclear to the engine
+  EXPECT_TRUE(f->may_match("a,y,abc"));
+  EXPECT_TRUE(f->may_match("a,y, 9"));
+  EXPECT_TRUE(f->may_match("a,y"));
+}
+
+TEST(S3SelectScan, StringEquality)
+{
+  const CSVDialect d;
+  auto f = RowFilter::from_query("select * from s3object where _2 = 'Abc'", d);
+  ASSERT_TRUE(f);
+  EXPECT_TRUE(f->may_match("1,Abc,2"));
+  EXPECT_TRUE(f->may_match("1, abc ,2"));
+  EXPECT_FALSE(f->may_match("1,abd,2"));
+
+  auto n = RowFilter::from_query("select * from s3object where _1 = '5'", d);
+  ASSERT_TRUE(n);
+  EXPECT_TRUE(n->may_match("5.0,x"));
+  EXPECT_FALSE(n->may_match("6,x"));
+}
+
+TEST(S3SelectScan, PushdownAcrossChunks)
+{
+  std::mt19937 rng(7);
+  const CSVDialect d;
+  std::string csv = "key,value,other\n";
+  std::vector<std::string> expected;
+  for (int i = 0; i < 5000; i++) {
+    const std::string row = "k" + std::to_string(rng() % 5) + "," +
+      std::to_string(rng() % 100) + ",\"x\ny\"";
+    csv += row + "\n";
+  }
+  csv += "k3,99,z"; // no delimiter on the last row
+
+  auto f = RowFilter::from_query(
+    "select count(*) from s3object where _2 > 50 and _1 = 'k3'", d);
+  ASSERT_TRUE(f);
+
+  for (int rep = 0; rep < 20; rep++) {
+    CSVPushdown p(RowFilter(*f), true);
+    std::string out;
+    for (size_t pos = 0; pos < csv.size(); ) {
+      const size_t len = std::min<size_t>(1 + rng() % 300, csv.size() - pos);
+      p.process(csv.data() + pos, len, pos + len == csv.size(), out);
+      pos += len;
+    }
+    // quoted rows are all kept, so the output is the whole input
+    ASSERT_EQ(csv, out);
+  }
+
+  // without quotes, only the header and the matching rows get through
+  std::string plain = "key,value\n";
+  size_t matching = 0;
+  for (int i = 0; i < 5000; i++) {
+    const int k = rng() % 5, v = rng() % 100;
+    plain += "k" + std::to_string(k) + "," + std::to_string(v) + "\n";
+    matching += (k == 3 && v > 50);
+  }
+  CSVPushdown p(RowFilter(*f), true);
+  std::string out;
+  for (size_t pos = 0; pos < plain.size(); pos += 4096) {
+    const size_t len = std::min<size_t>(4096, plain.size() - pos);
+    p.process(plain.data() + pos, len, pos + len == plain.size(), out);
+  }
+  EXPECT_EQ(5001u, p.rows_in);
+  EXPECT_EQ(matching + 1, p.rows_out);
+  EXPECT_EQ(0u, out.find("key,value\n"));
+}
+
+TEST(S3SelectScan, PushdownQuotesAfterFilterColumns)
+{
+  const CSVDialect d;
+  auto f = RowFilter::from_query("select * from s3object where _2 = 'b'", d);
+  ASSERT_TRUE(f);
+  CSVPushdown p(std::move(*f), false);
+  std::string out;
+  const std::string in =
+    "a,b,\"keep, me\"\n"
+    "a,c,\"drop, me\"\n"
+    "a,\"c\",keep\n"
+    "a,\"c\nd\",keep\n";
+  p.process(in.data(), in.size(), true, out);
+  EXPECT_EQ("a,b,\"keep, me\"\n"
+            "a,\"c\",keep\n"
+            "a,\"c\nd\",keep\n", out);
+}
+
+TEST(S3SelectScan, PushdownKeepsARowAtEnd)
+{
+  const CSVDialect d;
+  auto f = RowFilter::from_query("select * from s3object where _1 = 'none'", d);
+  ASSERT_TRUE(f);
+  CSVPushdown p(std::move(*f), false);
+  std::string out;
+  const std::string a = "a,1\nb,2\n", b = "c,3\n";
+  p.process(a.data(), a.size(), false, out);
+  EXPECT_TRUE(out.empty());
+  p.process(b.data(), b.size(), true, out);
+  EXPECT_EQ("c,3\n", out);
+}
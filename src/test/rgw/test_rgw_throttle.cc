@@ -215,4 +215,54 @@ TEST_F(Aio_Throttle, YieldingThrottleOverMax)
   EXPECT_EQ(window, max_outstanding);
 }
 
+TEST(AdaptiveWindow, GrowsWhileLatencyBound)
+{
+  using namespace std::chrono_literals;
+  constexpr uint64_t chunk = 4 << 20;
+  auto now = ceph::mono_clock::zero();
+  AdaptiveWindow window(16 << 20, 256 << 20, now);
+
+  // every read takes 10ms no matter how many are in flight, so the rate
+  // only depends on the window. it should keep growing up to the max
+  for (int i = 0; i < 64; i++) {
+    const uint64_t in_flight = window.get() / chunk;
+    now += 10ms;
+    for (uint64_t j = 0; j < in_flight; j++) {
+      window.complete(chunk, 10ms, now);
+    }
+  }
+  EXPECT_EQ(256u << 20, window.get());
+}
+
+TEST(AdaptiveWindow, SettlesAtBandwidthDelayProduct)
+{
+  using namespace std::chrono_literals;
+  constexpr uint64_t chunk = 4 << 20;
+  constexpr double rate = 1 << 30; // bytes/sec the link can do
+  const ceph::timespan latency = 20ms;
+  auto now = ceph::mono_clock::zero();
+  AdaptiveWindow window(16 << 20, 1ull << 30, now);
+
+  // reads complete no faster than the link allows
+  for (int i = 0; i < 1000; i++) {
+    now += std::chrono::duration_cast<ceph::timespan>(
+        std::chrono::duration<double>(chunk / rate));
+    window.complete(chunk, latency, now);
+  }
+  // twice the 20MiB bandwidth-delay product, and no further
+  EXPECT_NEAR(2 * rate * 0.02, window.get(), 2 * chunk);
+}
+
+TEST(AdaptiveWindow, FixedWhenMaxBelowMin)
+{
+  using namespace std::chrono_literals;
+  auto now = ceph::mono_clock::zero();
+  AdaptiveWindow window(16 << 20, 4 << 20, now);
+  for (int i = 0; i < 16; i++) {
+    now += 1ms;
+    window.complete(16 << 20, 100ms, now);
+  }
+  EXPECT_EQ(16u << 20, window.get());
+}
+
 } // namespace rgw
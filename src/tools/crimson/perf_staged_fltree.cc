@@ -52,6 +52,10 @@ class PerfTree : public TMTestState {
           auto t = tm->create_transaction();
           tree->validate(*t).unsafe_get();
         }
+        {
+          auto t = tm->create_transaction();
+          tree->scan(*t).unsafe_get();
+        }
         tree.reset();
       });
     }).then([this] {